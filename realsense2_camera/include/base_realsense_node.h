@@ -18,18 +18,13 @@
 #include <librealsense2/rsutil.h>
 #include "constants.h"
 
-// cv_bridge.h last supported version is humble
-#if defined(CV_BRDIGE_HAS_HPP)
-#include <cv_bridge/cv_bridge.hpp>
-#else
-#include <cv_bridge/cv_bridge.h>
-#endif
-
 #include <diagnostic_updater/diagnostic_updater.hpp>
 #include <diagnostic_updater/publisher.hpp>
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include "realsense2_camera_msgs/msg/imu_info.hpp"
 #include "realsense2_camera_msgs/msg/extrinsics.hpp"
 #include "realsense2_camera_msgs/msg/metadata.hpp"
+#include "realsense2_camera_msgs/msg/metadata_values.hpp"
 #include "realsense2_camera_msgs/msg/rgbd.hpp"
 #include "realsense2_camera_msgs/srv/device_info.hpp"
 #include <librealsense2/hpp/rs_processing.hpp>
@@ -48,8 +43,23 @@
 
 #include <ros_sensor.h>
 #include <named_filter.h>
-
+#include <message_pool.h>
+#include <spsc_ring_buffer.h>
+#include <pause_points.h>
+#include <pipeline_stage.h>
+#include <task_pool.h>
+#include <imu_batcher.h>
+#include <latency_stats.h>
+#include <tf_hub.h>
+#include <multi_camera_syncer.h>
+#include <raw_device.h>
+#include <output_throttle.h>
+#include <clock_offset_estimator.h>
+#include <format_traits.h>
+
+#include <array>
 #include <queue>
+#include <deque>
 #include <mutex>
 #include <atomic>
 #include <thread>
@@ -79,28 +89,55 @@ namespace realsense2_camera
         }
     };
 
+    // Publishes the united IMU messages, holding them back while frames are processed.
+    // The IMU thread never waits for the frame threads: the messages go through a lock-free ring buffer
+    // and are published by whichever thread, IMU or frame, gets to drain it first.
     class SyncedImuPublisher
     {
         public:
             SyncedImuPublisher(rclcpp::Publisher<sensor_msgs::msg::Imu>::SharedPtr imu_publisher, 
                                std::size_t waiting_list_size=1000);
             ~SyncedImuPublisher();
-            void Pause();   // Pause sending messages. All messages from now on are saved in queue.
-            void Resume();  // Send all pending messages and allow sending future messages.
-            void Publish(sensor_msgs::msg::Imu msg);     //either send or hold message.
+            // Pause sending messages. All messages from now on are saved in queue. Returns false if not enabled.
+            bool Pause(PausePoints::Id& pause_id);
+            // Remove the given Pause() and send the messages received before the oldest Pause() left.
+            // Allow sending future messages when no Pause() is left.
+            void Resume(PausePoints::Id pause_id);
+            bool Publish(const sensor_msgs::msg::Imu& msg);     // either send or hold message. Returns false if dropped, as the queue is full.
             size_t getNumSubscribers();
+            size_t getDroppedCount() const { return _dropped_count; }
             void Enable(bool is_enabled) {_is_enabled=is_enabled;};
         
         private:
-            void PublishPendingMessages();
+            void PublishPendingMessages(size_t release_limit);
+            void setReleaseLimit();
 
         private:
-            std::mutex                                          _mutex;
             rclcpp::Publisher<sensor_msgs::msg::Imu>::SharedPtr _publisher;
-            bool                                                _pause_mode;
-            std::queue<sensor_msgs::msg::Imu>                   _pending_messages;
-            std::size_t                                         _waiting_list_size;
-            bool                                                _is_enabled;
+            SpscRingBuffer<sensor_msgs::msg::Imu>               _pending_messages;  // pushed by the IMU thread only
+            std::atomic_bool                                    _is_publishing;     // taken by the thread popping the pending messages
+            std::atomic<size_t>                                 _messages_count;    // messages pushed so far
+            std::atomic<size_t>                                 _published_count;   // messages popped so far
+            std::atomic<size_t>                                 _release_limit;     // messages count that may be published
+            std::mutex                                          _pause_mutex;       // frame threads only
+            PausePoints                                         _pause_points;      // messages count at each pending Pause()
+            std::atomic<size_t>                                 _dropped_count;
+            std::atomic_bool                                    _is_enabled;
+    };
+
+    // Holds back the synced IMU messages while a frame is processed: pauses the publisher while alive.
+    class ImuPauseToken
+    {
+        public:
+            explicit ImuPauseToken(std::shared_ptr<SyncedImuPublisher> publisher) :
+                _publisher(publisher && publisher->Pause(_pause_id) ? publisher : nullptr) {}
+            ~ImuPauseToken() { if (_publisher) _publisher->Resume(_pause_id); }
+            ImuPauseToken(const ImuPauseToken&) = delete;
+            ImuPauseToken& operator=(const ImuPauseToken&) = delete;
+
+        private:
+            PausePoints::Id                     _pause_id;
+            std::shared_ptr<SyncedImuPublisher> _publisher;
     };
 
     class BaseRealSenseNode
@@ -112,6 +149,9 @@ namespace realsense2_camera
                           bool use_intra_process = false);
         ~BaseRealSenseNode();
         void publishTopics();
+        // Takes the same device back after it was disconnected, e.g. by a reset: the sensors are created again,
+        // while the publishers, the filters and the parameters values are kept.
+        void reconnect(rs2::device dev);
 
     public:
         enum class imu_sync_method{NONE, COPY, LINEAR_INTERPOLATION};
@@ -166,6 +206,63 @@ namespace realsense2_camera
         void setup();
 
     private:
+        // A frameset on its way through the filters and the publishers.
+        struct FramesetJob
+        {
+            FramesetJob() : original_depth_frame(rs2::frame{}), original_color_frame(rs2::frame{}), frame_time(0), is_depth_clipping_pending(false),
+                            filters_demand(0), is_align_depth_applied(false), is_decimation_applied(false), callback_time_ns(0) {}
+            rs2::frameset frameset;
+            rs2::depth_frame original_depth_frame;
+            rs2::video_frame original_color_frame;
+            rs2::frame depth_frame_to_send;     // original depth, colorized if needed, published along the aligned depth
+            rclcpp::Time t;
+            double frame_time;
+            bool is_depth_clipping_pending;
+            unsigned int filters_demand;        // FilterOutput flags with subscribers when the frameset arrived
+            bool is_align_depth_applied;
+            bool is_decimation_applied;         // the frames are smaller than their profiles
+            int64_t callback_time_ns;           // LatencyStats::now() at the frame callback entry, 0 if latencies are not recorded
+            std::shared_ptr<ImuPauseToken> imu_pause;
+        };
+
+        // Latencies since the frame callback entry of a published stream
+        struct StreamLatency
+        {
+            LatencyHistogram* callback;     // single frames only, the frame timestamp to the callback entry
+            LatencyHistogram* fill;
+            LatencyHistogram* publish;
+        };
+
+        // The messages of a video stream, or of the depth aligned to it
+        struct StreamOutput
+        {
+            StreamOutput() : format(RS2_FORMAT_ANY), encoding(nullptr), latency{nullptr, nullptr, nullptr} {}
+            std::shared_ptr<image_publisher> image;     // null while not published
+            rclcpp::Publisher<sensor_msgs::msg::CameraInfo>::SharedPtr info;
+            rs2_format format;          // of the profile: the frames format, unless a filter changed it (e.g. the colorizer)
+            const char* encoding;       // of format
+            StreamLatency latency;
+        };
+
+        // Groups of topics depending on the filters' output. A filter is skipped if none of its outputs has subscribers.
+        enum FilterOutput
+        {
+            DEPTH_STREAMS_OUTPUT = 1 << 0,  // depth and infrared images, camera info and metadata
+            DEPTH_OUTPUT         = 1 << 1,  // depth image, camera info and metadata
+            POINTCLOUD_OUTPUT    = 1 << 2,
+            ALIGNED_DEPTH_OUTPUT = 1 << 3,  // aligned depth image and camera info, RGBD
+            ALL_OUTPUTS          = (1 << 4) - 1
+        };
+
+        // Stages of the pipelined mode, each runs on its own thread.
+        enum PipelineStageIndex
+        {
+            FILTERS_STAGE,      // depth clipping and the filters up to the colorizer
+            PROCESSING_STAGE,   // colorizer, pointcloud and align depth
+            PUBLISHING_STAGE,
+            PIPELINE_STAGES_COUNT
+        };
+
         class CimuData
         {
             public:
@@ -189,53 +286,54 @@ namespace realsense2_camera
         void setupPublishers();
         void enable_devices();
         void setupFilters();
+        void checkProcessingBackend();
         bool setBaseTime(double frame_time, rs2_timestamp_domain time_domain);
         uint64_t millisecondsToNanoseconds(double timestamp_ms);
         rclcpp::Time frameSystemTimeSec(rs2::frame frame);
-        cv::Mat& fix_depth_scale(const cv::Mat& from_image, cv::Mat& to_image);
+        void fix_depth_scale(const uint16_t* from_data, uint16_t* to_data, size_t count, float clipping_dist = 0);
         void clip_depth(rs2::depth_frame depth_frame, float clipping_dist);
+        uint16_t getClippingValue(float clipping_dist) const;
         void updateProfilesStreamCalibData(const std::vector<rs2::stream_profile>& profiles);
         void updateExtrinsicsCalibData(const rs2::video_stream_profile& left_video_profile, const rs2::video_stream_profile& right_video_profile);
         void updateStreamCalibData(const rs2::video_stream_profile& video_profile);
         void SetBaseStream();
         void publishStaticTransforms();
         void startDynamicTf();
+        void stopDynamicTf();
         void publishDynamicTransforms();
+        bool getDynamicTransforms(std::vector<geometry_msgs::msg::TransformStamped>& msgs, const rclcpp::Time& t);
         void publishPointCloud(rs2::points f, const rclcpp::Time& t, const rs2::frameset& frameset);
+        const std::string& opticalFrameId(const stream_index_pair& sip) const;
         Extrinsics rsExtrinsicsToMsg(const rs2_extrinsics& extrinsics) const;
         IMUInfo getImuInfo(const rs2::stream_profile& profile);
-        void initializeFormatsMaps();
 
         bool fillROSImageMsgAndReturnStatus(
-            const cv::Mat& cv_matrix_image,
+            const rs2::video_frame& frame,
             const stream_index_pair& stream,
-            unsigned int width,
-            unsigned int height,
-            const rs2_format& stream_format,
+            const char* encoding,
             const rclcpp::Time& t,
-            sensor_msgs::msg::Image* img_msg_ptr);
-
-        bool fillCVMatImageAndReturnStatus(
-            rs2::frame& frame,
-            std::map<stream_index_pair, cv::Mat>& images,
-            unsigned int width,
-            unsigned int height,
-            const stream_index_pair& stream);
+            sensor_msgs::msg::Image* img_msg_ptr,
+            float depth_clipping_dist = 0);
 
         void publishFrame(
             rs2::frame f,
             const rclcpp::Time& t,
             const stream_index_pair& stream,
-            std::map<stream_index_pair, cv::Mat>& images,
-            const std::map<stream_index_pair, rclcpp::Publisher<sensor_msgs::msg::CameraInfo>::SharedPtr>& info_publishers,
-            const std::map<stream_index_pair, std::shared_ptr<image_publisher>>& image_publishers,
-            const bool is_publishMetadata = true);
+            const StreamOutput& output,
+            const bool is_publishMetadata = true,
+            float depth_clipping_dist = 0,
+            int64_t callback_time_ns = 0,
+            bool is_resized = false);
+
+        bool fillRGBDMsgAndReturnStatus(
+            const rs2::video_frame& color_frame,
+            const rs2::video_frame& depth_frame,
+            const rclcpp::Time& t,
+            realsense2_camera_msgs::msg::RGBD* msg);
 
         void publishRGBD(
-            const cv::Mat& rgb_cv_matrix,
-            const rs2_format& color_format,
-            const cv::Mat& depth_cv_matrix,
-            const rs2_format& depth_format,
+            const rs2::video_frame& color_frame,
+            const rs2::video_frame& depth_frame,
             const rclcpp::Time& t);
 
         void publishMetadata(rs2::frame f, const rclcpp::Time& header_time, const std::string& frame_id);
@@ -249,16 +347,45 @@ namespace realsense2_camera
         void imu_callback_sync(rs2::frame frame, imu_sync_method sync_method=imu_sync_method::COPY);
         void multiple_message_callback(rs2::frame frame, imu_sync_method sync_method);
         void frame_callback(rs2::frame frame);
+        void processFrameset(FramesetJob& job, size_t first_filter, size_t last_filter);
+        void publishFrameset(FramesetJob& job);
+        void publishVideoFrame(rs2::frame frame, const rclcpp::Time& t, int64_t callback_time_ns);
+        void setupPipeline();
+        void setupParallelPublish();
+        void pushPipelineJob(PipelineStageIndex stage, PipelineStage::Job job);
+        void flushPipeline();
+        unsigned int getFiltersDemand();
+        unsigned int countFiltersDemand();
+        void updateFiltersDemand();
+        void monitoringGraphChanges();
+        void setupStreamDescriptors();
+        int64_t arrivalLatency(const rs2::frame& frame);   // ns from the frame arrival at the host to now, -1 if unknown
+        void recordLatency(LatencyHistogram* histogram, int64_t callback_time_ns);
+        void addLatencyStats(diagnostic_updater::DiagnosticStatusWrapper& status);
+        void monitoringLatencyStats();
         
         void startDiagnosticsUpdater();
         void monitoringProfileChanges();
         void publish_temperature();
         void setAvailableSensors();
+        void validateOptionsCache();
         void setCallbackFunctions();
         void updateSensors();
+        void diffProfiles(const RosSensor& sensor,
+                          const std::vector<rs2::stream_profile>& active_profiles,
+                          const std::vector<rs2::stream_profile>& wanted_profiles,
+                          std::vector<rs2::stream_profile>& removed_profiles,
+                          std::vector<rs2::stream_profile>& added_profiles);
         void publishServices();
         void startPublishers(const std::vector<rs2::stream_profile>& profiles, const RosSensor& sensor);
+        std::shared_ptr<image_publisher> createImagePublisher(const std::string& topic_name, const rmw_qos_profile_t& qos,
+                                                              const std::string& video_encoder = "", int fps = 0);
+        bool canLoanImageMessages(const rmw_qos_profile_t& qos);
         void startRGBDPublisherIfNeeded();
+        void setupMultiCameraSync();
+        void startRawRecording();
+        void recordRawFrame(const rs2::frame& frame);
+        bool isRGBDSubscribed();
         void stopPublishers(const std::vector<rs2::stream_profile>& profiles);
 
         rs2::device _dev;
@@ -266,6 +393,14 @@ namespace realsense2_camera
         std::map<std::string, std::function<void(rs2::frame)>> _sensors_callback;
 
         std::string _json_file_path;
+        std::string _options_cache_dir;
+        std::shared_ptr<OptionsCache> _options_cache;
+        std::shared_ptr<std::thread> _options_cache_validation;
+        std::string _raw_record_dir;                  // empty if the frames aren't recorded
+        int _raw_record_segment_size;
+        size_t _raw_recordings_count;
+        std::mutex _raw_recorder_mutex;
+        std::shared_ptr<RawRecorder> _raw_recorder;
         float _depth_scale_meters;
         float _clipping_distance;
 
@@ -285,27 +420,62 @@ namespace realsense2_camera
         std::shared_ptr<tf2_ros::StaticTransformBroadcaster> _static_tf_broadcaster;
         std::shared_ptr<tf2_ros::TransformBroadcaster> _dynamic_tf_broadcaster;
         std::vector<geometry_msgs::msg::TransformStamped> _static_tf_msgs;
+        size_t _static_tf_msgs_version, _sent_tf_msgs_version;     // under _publish_tf_mutex
+        bool _tf_publish_on_change;
+        bool _tf_shared_timer;
         std::shared_ptr<std::thread> _tf_t;
+        std::shared_ptr<TfHub> _tf_hub;
+        size_t _tf_hub_client_id;
+
+        bool _use_intra_process;
+        bool _use_loaned_messages;
+        int _can_loan_image_messages;       // probed once, on the first image publisher: -1 until then
 
-        bool _use_intra_process;      
-        std::map<stream_index_pair, std::shared_ptr<image_publisher>> _image_publishers;
-        
         std::map<stream_index_pair, rclcpp::Publisher<sensor_msgs::msg::Imu>::SharedPtr> _imu_publishers;
         std::shared_ptr<SyncedImuPublisher> _synced_imu_publisher;
-        std::map<stream_index_pair, rclcpp::Publisher<sensor_msgs::msg::CameraInfo>::SharedPtr> _info_publishers;
+        std::map<stream_index_pair, std::shared_ptr<ImuBatcher>> _imu_batchers;
+        std::shared_ptr<ImuBatcher> _synced_imu_batcher;
+        int _imu_batch_size;
+        double _imu_batch_period;
         std::map<stream_index_pair, rclcpp::Publisher<realsense2_camera_msgs::msg::Metadata>::SharedPtr> _metadata_publishers;
+        std::map<stream_index_pair, rclcpp::Publisher<realsense2_camera_msgs::msg::MetadataValues>::SharedPtr> _metadata_values_publishers;
         std::map<stream_index_pair, rclcpp::Publisher<IMUInfo>::SharedPtr> _imu_info_publishers;
         std::map<stream_index_pair, rclcpp::Publisher<Extrinsics>::SharedPtr> _extrinsics_publishers;
         rclcpp::Publisher<realsense2_camera_msgs::msg::RGBD>::SharedPtr _rgbd_publisher;
-        std::map<stream_index_pair, cv::Mat> _images;
-        std::map<rs2_format, std::string> _rs_format_to_ros_format;
-        std::map<rs2_format, int> _rs_format_to_cv_format;
+        MessagePool<realsense2_camera_msgs::msg::RGBD> _rgbd_msg_pool;
+        std::string _multi_camera_sync_group;         // empty if the node isn't synced with other cameras
+        double _multi_camera_sync_tolerance;
+        std::shared_ptr<MultiCameraSyncer> _multi_camera_syncer;
+        MultiCameraSyncer::MultiRGBDPublisher _multi_rgbd_publisher;
 
         std::map<stream_index_pair, sensor_msgs::msg::CameraInfo> _camera_info;
+        // The per stream state used on every message, in a flat array indexed by streamSlot(),
+        // instead of formatted or looked up in maps for every frame.
+        // The frame IDs are set for every stream by setupStreamDescriptors() before any frame arrives, the outputs by
+        // startPublishers() and stopPublishers(), while the pipeline is flushed.
+        struct StreamDescriptor
+        {
+            StreamDescriptor() : camera_info(nullptr) {}
+            stream_index_pair sip;
+            std::string optical_frame_id;
+            sensor_msgs::msg::CameraInfo* camera_info;      // in _camera_info, guarded by _camera_info_mutex; also the aligned depth's
+            StreamOutput output;
+            StreamOutput aligned_depth_output;              // the depth aligned to the stream
+        };
+        static constexpr int STREAM_INDEX_COUNT = 3;     // the infrared streams are 1 and 2
+        // The last slot is shared by the streams out of range, if any
+        static constexpr size_t NO_STREAM_SLOT = RS2_STREAM_COUNT * STREAM_INDEX_COUNT;
+        static size_t streamSlot(const stream_index_pair& sip)
+        {
+            return (sip.first >= 0 && sip.first < RS2_STREAM_COUNT && sip.second >= 0 && sip.second < STREAM_INDEX_COUNT) ?
+                   sip.first * STREAM_INDEX_COUNT + sip.second : NO_STREAM_SLOT;
+        }
+        std::array<StreamDescriptor, NO_STREAM_SLOT + 1> _stream_descriptors;
+        std::string _imu_optical_frame_id;
+        std::atomic_bool _is_camera_info_decimated;     // the camera info was set for the decimated frames of the last frameset
+        std::mutex _camera_info_mutex;
         std::atomic_bool _is_initialized_time_base;
-        double _camera_time_base;
-
-        rclcpp::Time _ros_time_base;
+        ClockOffsetEstimator _clock_offset_estimator;     // HARDWARE_CLOCK to ROS time, for the frames and IMU paths
         bool _sync_frames;
         bool _enable_rgbd;
         bool _is_color_enabled;
@@ -318,30 +488,67 @@ namespace realsense2_camera
         PipelineSyncer _syncer;
         rs2::asynchronous_syncer _asyncer;
         std::shared_ptr<NamedFilter> _colorizer_filter;
+        std::shared_ptr<NamedFilter> _decimation_filter;
         std::shared_ptr<AlignDepthFilter> _align_depth_filter;
         std::shared_ptr<PointcloudFilter> _pc_filter;
         std::vector<std::shared_ptr<NamedFilter>> _filters;
+        std::vector<unsigned int> _filters_outputs;     // FilterOutput flags of each one of _filters
         std::vector<rs2::sensor> _dev_sensors;
         std::vector<std::unique_ptr<RosSensor>> _available_ros_sensors;
+        std::vector<rs2::stream_profile> _kept_profiles;     // streamed before the update or reconnect(), their publishers are kept
 
         std::map<rs2_stream, std::shared_ptr<rs2::align>> _align;
 
-        std::map<stream_index_pair, cv::Mat> _depth_aligned_image;
-        std::map<stream_index_pair, cv::Mat> _depth_scaled_image;
-        std::map<stream_index_pair, rclcpp::Publisher<sensor_msgs::msg::CameraInfo>::SharedPtr> _depth_aligned_info_publisher;
-        std::map<stream_index_pair, std::shared_ptr<image_publisher>> _depth_aligned_image_publishers;
         std::map<std::string, rs2::region_of_interest> _auto_exposure_roi;
         std::map<rs2_stream, bool> _is_first_frame;
 
         std::shared_ptr<std::thread> _monitoring_t;
         std::shared_ptr<std::thread> _monitoring_pc;   //pc = profile changes
+        std::shared_ptr<std::thread> _monitoring_graph;
         mutable std::condition_variable _cv_temp, _cv_mpc, _cv_tf;
         bool _is_profile_changed;
+        double _profile_change_debounce;
         bool _is_align_depth_changed;
 
         std::shared_ptr<diagnostic_updater::Updater> _diagnostics_updater;
         rs2::stream_profile _base_profile;
 
+        bool _enable_pipelining;
+        int _pipeline_queue_size;
+        std::string _pipeline_drop_policy;
+        size_t _pipeline_split_filter;     // index of the first filter run by the PROCESSING_STAGE
+        std::vector<std::shared_ptr<PipelineStage>> _pipeline_stages;
+
+        bool _enable_parallel_publish;
+        int _parallel_publish_threads;
+        std::shared_ptr<TaskPool> _publish_task_pool;
+
+        // Sync state of the united IMU messages (unite_imu_method), guarded by _imu_sync_mutex
+        std::mutex _imu_sync_mutex;
+        CimuData _accel_data;
+        std::deque<CimuData> _imu_history;
+
+        bool _enable_lazy_filters;
+        std::atomic<unsigned int> _filters_demand;     // counted by the graph monitoring thread, read by the frame threads
+        std::atomic_bool _is_filters_demand_stale;     // set on graph events and publishers changes: all outputs are computed until counted again
+        OutputThrottle _output_throttle;
+        std::map<unsigned int, std::string> _throttled_output_names;
+        std::map<unsigned int, OutputThrottle::Settings> _throttled_output_settings;
+
+        std::atomic_bool _enable_latency_stats;     // set by the parameter callback, read by the frame threads
+        double _latency_stats_publish_period;
+        int _video_encoder_bitrate;
+        int _video_encoder_gop_size;
+        std::string _processing_backend;
+        LatencyStats _latency_stats;
+        LatencyHistogram* _frameset_callback_latency;   // the frameset timestamp to the callback entry
+        std::vector<LatencyHistogram*> _filters_latency;    // end of the Process of each one of _filters
+        LatencyHistogram* _pointcloud_publish_latency;
+        rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr _latency_stats_publisher;
+        std::shared_ptr<std::thread> _monitoring_latency;
+        std::condition_variable _cv_latency;
+        std::mutex _latency_stats_mutex;
+
 
     };//end class
 }
@@ -0,0 +1,79 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Maps the device clock (HARDWARE_CLOCK, in milliseconds) to the host clock (in nanoseconds),
+    // from the host arrival time of the frames: host = offset + (1 + skew) * device.
+    // The arrivals are late by the transport latency, which spikes when a thread is held back:
+    // the earliest arrival of every sample_interval_ms is kept, in a ring of the last capacity samples,
+    // and the line is fitted to them by least squares.
+    // The device clock is unwrapped, and a clock going back by more than a second (e.g. a hardware reset)
+    // starts the estimation over. Shared by the frames and IMU threads: thread safe.
+    class ClockOffsetEstimator
+    {
+        public:
+            struct Estimate
+            {
+                int64_t offset_ns;      // host - device time, at the last device time
+                double skew_ppm;        // how much faster the device clock runs than the host clock
+                size_t samples;
+            };
+
+            static constexpr double HARDWARE_CLOCK_WRAP_MS = 4294967.296;    // 32 bits of microseconds
+
+            ClockOffsetEstimator(size_t capacity = 128, double sample_interval_ms = 500.0,
+                                 double wrap_period_ms = HARDWARE_CLOCK_WRAP_MS);
+
+            // A frame of device_time_ms arrived at host_time_ns: returns its host time.
+            int64_t update(double device_time_ms, int64_t host_time_ns);
+            Estimate getEstimate() const;
+            void reset();
+
+        private:
+            struct Sample
+            {
+                double device_ms;       // unwrapped, since _device_ref_ms
+                double host_ns;         // since _host_ref_ns
+            };
+
+            void resetLocked();
+            void commit(const Sample& sample);
+            void fit();
+            double toHost(double device_ms) const { return _intercept_ns + _slope_ns_per_ms * device_ms; }
+
+            const size_t _capacity;
+            const double _sample_interval_ms;
+            const double _wrap_period_ms;
+            mutable std::mutex _mutex;
+            bool _is_initialized;
+            double _device_ref_ms;
+            int64_t _host_ref_ns;
+            double _wrap_offset_ms;
+            double _last_device_ms;
+            std::vector<Sample> _samples;       // ring buffer
+            size_t _next_sample;
+            Sample _bucket_sample;              // the earliest arrival of the current interval
+            bool _has_bucket_sample;
+            double _bucket_end_ms;
+            double _intercept_ns;
+            double _slope_ns_per_ms;
+    };
+}
@@ -0,0 +1,59 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Updates queued by name, taken by their consumer in batches.
+    // An update replaces the pending update of the same name and moves to the back of the queue,
+    // so that a batch writes every name once, in the order of the last writes
+    // (e.g. enable_auto_exposure before the exposure that follows it).
+    // push() returns the result of the update that is eventually applied. Thread safe.
+    class CoalescingQueue
+    {
+        public:
+            typedef std::function<void()> Update;     // throws on failure
+            typedef std::function<void(const std::string& name, const std::string& error)> ErrorCallback;
+
+            struct QueuedUpdate
+            {
+                std::string name;
+                Update update;
+                std::vector<std::shared_ptr<std::promise<bool> > > results;     // of the update and of the ones it replaced
+            };
+            typedef std::vector<QueuedUpdate> Batch;
+
+            ~CoalescingQueue();
+
+            std::shared_future<bool> push(const std::string& name, Update update);
+            bool empty() const;
+            Batch takeAll();
+
+            // Applies the updates in order: an update that throws doesn't stop the batch.
+            static void apply(Batch& batch, ErrorCallback on_error);
+
+        private:
+            static void setResults(QueuedUpdate& queued_update, bool result);
+
+            mutable std::mutex _mutex;
+            Batch _updates;
+    };
+}
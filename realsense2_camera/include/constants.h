@@ -69,18 +69,56 @@ namespace realsense2_camera
 
     const bool ALLOW_NO_TEXTURE_POINTS = false;
     const bool ORDERED_PC     = false;
+    const int POINTCLOUD_NUM_THREADS = 1;
+    const int POINTCLOUD_STRIDE = 1;
+    const double POINTCLOUD_MIN_Z = 0.0;
+    const double POINTCLOUD_MAX_Z = 0.0;
+    const std::string POINTCLOUD_ENCODING = "float32";
     const bool SYNC_FRAMES    = false;
     const bool ENABLE_RGBD    = false;
+    const std::string MULTI_CAMERA_SYNC_GROUP = "";
+    const double MULTI_CAMERA_SYNC_TOLERANCE = 0.005;     // seconds
+    const size_t MULTI_CAMERA_SYNC_QUEUE_SIZE = 4;
+    const std::string RAW_RECORD_DIR = "";
+    const int RAW_RECORD_SEGMENT_SIZE = 256;     // MB
 
     const bool PUBLISH_TF     = true;
     const double TF_PUBLISH_RATE = 0; // Static transform
+    const bool TF_PUBLISH_ON_CHANGE = false;
+    const bool TF_SHARED_TIMER = false;
     const double DIAGNOSTICS_PERIOD = 0.0;
+    const double PROFILE_CHANGE_DEBOUNCE = 0.1;
+    const double PARAMETERS_UPDATE_TICK = 0.01;     // seconds
 
     const std::string IMAGE_QOS    = "SYSTEM_DEFAULT";
     const std::string DEFAULT_QOS  = "DEFAULT";
     const std::string HID_QOS         = "SENSOR_DATA";
 
     const bool HOLD_BACK_IMU_FOR_FRAMES = false;
+    const bool USE_LOANED_MESSAGES = false;
+    const int IMU_BATCH_SIZE = 0;
+    const double IMU_BATCH_PERIOD = 0.0;
+
+    const bool ENABLE_PIPELINING = false;
+    const int PIPELINE_QUEUE_SIZE = 2;
+    const std::string PIPELINE_DROP_POLICY = "drop_oldest";
+    const bool ENABLE_PARALLEL_PUBLISH = false;
+    const int PARALLEL_PUBLISH_THREADS = 4;
+    const bool ENABLE_LAZY_FILTERS = false;
+    const double LOAD_LATENCY_BUDGET = 0.0;     // seconds, 0 for no load adaptation
+    const double OUTPUT_MAX_RATE = 0.0;         // Hz, 0 for no limit
+    const int OUTPUT_LOAD_DECIMATION = 1;
+    const bool ENABLE_LATENCY_STATS = false;
+    const double LATENCY_STATS_PUBLISH_PERIOD = 1.0;
+    const int VIDEO_ENCODER_BITRATE = 4000000;
+    const int VIDEO_ENCODER_GOP_SIZE = 30;
+    const bool HOT_RECONNECT = false;
+    const double QUERY_DEVICES_MIN_BACKOFF = 0.5;     // seconds, doubled up to reconnect_timeout
+#ifdef BUILD_WITH_CUDA
+    const std::string PROCESSING_BACKEND = "cuda";
+#else
+    const std::string PROCESSING_BACKEND = "auto";
+#endif
 
     const std::string DEFAULT_BASE_FRAME_ID            = "link";
     const std::string DEFAULT_IMU_OPTICAL_FRAME_ID     = "camera_imu_optical_frame";
@@ -0,0 +1,40 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Per pixel kernels applied to Z16 depth buffers.
+    // Scaling converts depth units to millimeters: dst = min(src * depth_scale_meters / 0.001, 65535), truncated.
+    // Clipping zeroes pixels above clipping_value, given in depth units: dst = (src > clipping_value) ? 0 : src.
+    // All kernels of a set give bit identical results. src and dst may point to the same buffer.
+    struct DepthKernels
+    {
+        const char* name;
+        void (*scale)(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters);
+        void (*clip)(const uint16_t* src, uint16_t* dst, size_t count, uint16_t clipping_value);
+        void (*scale_and_clip)(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters, uint16_t clipping_value);
+    };
+
+    // Returns the fastest kernels supported by the running CPU. Selected once, on first call.
+    const DepthKernels& getDepthKernels();
+
+    // Returns all the kernel sets supported by the running CPU, the portable scalar set first.
+    std::vector<const DepthKernels*> getSupportedDepthKernels();
+}
@@ -0,0 +1,84 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <librealsense2/rs.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace realsense2_camera
+{
+    // The devices of the camera nodes of a process (e.g. a component container), discovered once for all of them:
+    // a single rs2::context, a single devices changed callback and a single query_devices() call per change,
+    // instead of each node polling its own context.
+    // A device is given to the first node whose matcher accepts it, and to no other node until it is removed.
+    // The callbacks are called with the registry lock held: they should only hand the device over to the node's thread.
+    class DeviceRegistry
+    {
+        public:
+            typedef std::function<bool(rs2::device)> DeviceMatcher;
+            typedef std::function<void(rs2::device)> DeviceCallback;
+            typedef std::function<void()> RemovedCallback;
+
+            // The registry of the process, created by the first call and destroyed with its last user
+            static std::shared_ptr<DeviceRegistry> getInstance();
+            ~DeviceRegistry();
+
+            size_t addClient(DeviceMatcher matcher, DeviceCallback on_device, RemovedCallback on_removed);
+            void removeClient(size_t client_id);
+
+            // The node gives its device back, e.g. it failed to start: it may be given again.
+            void releaseDevice(size_t client_id);
+
+            // Hardware resets of the devices are at least stagger_seconds apart, so that cameras resetting together
+            // don't brown out their hub. The device is given again once it is back.
+            void hardwareReset(size_t client_id, rs2::device device, double stagger_seconds);
+
+        private:
+            struct Client
+            {
+                DeviceMatcher matcher;
+                DeviceCallback on_device;
+                RemovedCallback on_removed;
+                rs2::device device;         // empty if no device is given to the client
+                std::string serial_no;
+                bool is_resetting;          // removing the device is expected, on_removed isn't called
+            };
+
+            DeviceRegistry();
+            void changeDeviceCallback(rs2::event_information& info);
+            void discover();
+            void assignDevices(rs2::device_list list);
+
+            rclcpp::Logger _logger;
+            rs2::context _ctx;
+            std::mutex _mutex;
+            std::condition_variable _cv_discovery;
+            std::map<size_t, Client> _clients;
+            size_t _next_client_id;
+            bool _is_running;
+            bool _is_query_needed;
+            std::thread _discovery_thread;
+            std::mutex _reset_mutex;
+            std::chrono::steady_clock::time_point _last_reset_time;
+    };
+}
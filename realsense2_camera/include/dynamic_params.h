@@ -17,6 +17,7 @@
 #include "constants.h"
 #include <deque>
 #include "ros_param_backend.h"
+#include "coalescing_queue.h"
 
 namespace realsense2_camera
 {
@@ -44,11 +45,21 @@ namespace realsense2_camera
             void removeParam(std::string param_name);
             void pushUpdateFunctions(std::vector<std::function<void()> > funcs);
 
+            // queueSetRosValue - the parameters queued within PARAMETERS_UPDATE_TICK are set by a single set_parameters() call.
             template <class T>
             void queueSetRosValue(const std::string& param_name, const T value);
+
+            // queueSetOption - the device writes are applied by the update thread, not by the caller:
+            // writes of the same parameter queued within PARAMETERS_UPDATE_TICK are coalesced into the last one.
+            // The launch values applied by setParam() are written at once, by the caller.
+            std::shared_future<bool> queueSetOption(const std::string& param_name, std::function<void()> set_option);
+
+            // restoreParamValues - sets the parameters values again, e.g. after a reconnection, writing the options at once as the launch values.
+            void restoreParamValues(const std::vector<rclcpp::Parameter>& parameters);
             
         private:
             void monitor_update_functions();
+            void setRosParamValues(const std::vector<rclcpp::Parameter>& parameters);
 
         private:
             rclcpp::Node& _node;
@@ -60,6 +71,8 @@ namespace realsense2_camera
             bool _is_running;
             std::shared_ptr<std::thread> _update_functions_t;
             std::deque<std::function<void()> > _update_functions_v;
+            CoalescingQueue _option_writes;
+            std::vector<rclcpp::Parameter> _ros_values;
             std::list<std::string> self_set_parameters;
             std::mutex _mu;
 
@@ -0,0 +1,75 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <librealsense2/rs.hpp>
+
+namespace realsense2_camera
+{
+    // The ROS image encoding of each rs2_format, in a table indexed by the format and built at compile time:
+    // looked up on every frame, as the filters (e.g. the colorizer) change the format of a stream.
+    // http://docs.ros.org/en/jade/api/sensor_msgs/html/image__encodings_8h_source.html
+    struct FormatTraits
+    {
+        rs2_format format;
+        const char* encoding;       // nullptr if the format isn't published as an image
+    };
+
+    namespace format_traits
+    {
+        // The values of sensor_msgs::image_encodings, which are not constexpr
+        constexpr FormatTraits FORMATS[] = {
+            {RS2_FORMAT_Y8, "mono8"},
+            {RS2_FORMAT_Y16, "mono16"},
+            {RS2_FORMAT_Z16, "16UC1"},
+            {RS2_FORMAT_RGB8, "rgb8"},
+            {RS2_FORMAT_BGR8, "bgr8"},
+            {RS2_FORMAT_RGBA8, "rgba8"},
+            {RS2_FORMAT_BGRA8, "bgra8"},
+            {RS2_FORMAT_YUYV, "yuv422_yuy2"},
+            {RS2_FORMAT_UYVY, "yuv422"},
+            // RS2_FORMAT_M420 is not supported yet in ROS2
+            {RS2_FORMAT_RAW8, "8UC1"},
+            {RS2_FORMAT_RAW10, "16UC1"},
+            {RS2_FORMAT_RAW16, "16UC1"},
+        };
+
+        struct Table
+        {
+            FormatTraits traits[RS2_FORMAT_COUNT];
+        };
+
+        constexpr Table makeTable()
+        {
+            Table table{};
+            for (int format = 0; format < RS2_FORMAT_COUNT; ++format)
+                table.traits[format] = FormatTraits{static_cast<rs2_format>(format), nullptr};
+            for (const FormatTraits& traits : FORMATS)
+                table.traits[traits.format] = traits;
+            return table;
+        }
+
+        constexpr Table TABLE = makeTable();
+    }
+
+    constexpr const FormatTraits& formatTraits(rs2_format format)
+    {
+        return (format >= 0 && format < RS2_FORMAT_COUNT) ? format_traits::TABLE.traits[format] : format_traits::TABLE.traits[RS2_FORMAT_ANY];
+    }
+
+    static_assert(formatTraits(RS2_FORMAT_Z16).format == RS2_FORMAT_Z16, "the table is indexed by format");
+    static_assert(formatTraits(RS2_FORMAT_ANY).encoding == nullptr, "RS2_FORMAT_ANY isn't an image format");
+}
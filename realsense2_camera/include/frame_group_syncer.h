@@ -0,0 +1,111 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Matches the frames of several cameras by their stamps: a group is made of one frame of each member,
+    // all of them within tolerance_ns of the latest one. A frame that can't be in a group anymore (older than
+    // the latest head by more than the tolerance) is dropped, and each member keeps at most queue_size frames,
+    // so that a stopped member doesn't hold the frames of the others.
+    // The frames of a member are pushed in stamp order. Not thread safe.
+    template<class T>
+    class FrameGroupSyncer
+    {
+        public:
+            typedef std::vector<std::pair<std::string, T> > Group;     // sorted by member name
+
+            FrameGroupSyncer(int64_t tolerance_ns, size_t queue_size) :
+                _tolerance_ns(tolerance_ns), _queue_size(queue_size)
+            {}
+
+            void addMember(const std::string& name)
+            {
+                _queues[name];
+            }
+
+            void removeMember(const std::string& name)
+            {
+                _queues.erase(name);
+            }
+
+            size_t size() const { return _queues.size(); }
+
+            // Returns true and fills group if the frame completed one. Frames of unknown members are ignored.
+            bool push(const std::string& name, int64_t stamp_ns, const T& frame, Group& group)
+            {
+                auto queue = _queues.find(name);
+                if (queue == _queues.end())
+                    return false;
+                queue->second.push_back(Frame{stamp_ns, frame});
+                if (queue->second.size() > _queue_size)
+                    queue->second.pop_front();
+                return takeGroup(group);
+            }
+
+        private:
+            struct Frame
+            {
+                int64_t stamp_ns;
+                T frame;
+            };
+
+            bool takeGroup(Group& group)
+            {
+                while (true)
+                {
+                    int64_t latest_ns(INT64_MIN);
+                    for (auto& queue : _queues)
+                    {
+                        if (queue.second.empty())
+                            return false;
+                        latest_ns = std::max(latest_ns, queue.second.front().stamp_ns);
+                    }
+                    bool is_dropped(false);
+                    for (auto& queue : _queues)
+                    {
+                        if (queue.second.front().stamp_ns < latest_ns - _tolerance_ns)
+                        {
+                            queue.second.pop_front();
+                            is_dropped = true;
+                        }
+                    }
+                    if (is_dropped)
+                        continue;
+                    group.clear();
+                    for (auto& queue : _queues)
+                    {
+                        group.push_back(std::make_pair(queue.first, queue.second.front().frame));
+                        queue.second.pop_front();
+                    }
+                    return true;
+                }
+            }
+
+            const int64_t _tolerance_ns;
+            const size_t _queue_size;
+            std::map<std::string, std::deque<Frame> > _queues;
+    };
+}
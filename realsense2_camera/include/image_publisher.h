@@ -18,13 +18,20 @@
 #include <sensor_msgs/msg/image.hpp>
 
 #include <image_transport/image_transport.hpp>
+#include <functional>
+#include <message_pool.h>
 
 namespace realsense2_camera {
 class image_publisher
 {
 public:
     virtual void publish( sensor_msgs::msg::Image::UniquePtr image_ptr ) = 0;
+    // Let fill_func write into a message owned by the publisher and publish it.
+    // Returns false, and publishes nothing, if fill_func failed.
+    virtual bool fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func );
     virtual size_t get_subscription_count() const = 0;
+    // Returns false if this publisher does not recycle its messages
+    virtual bool get_message_pool_stats( MessagePoolStats & stats ) const { return false; }
     virtual ~image_publisher() = default;
 };
 
@@ -34,12 +41,17 @@ class image_rcl_publisher : public image_publisher
 public:
     image_rcl_publisher( rclcpp::Node & node,
                          const std::string & topic_name,
-                         const rmw_qos_profile_t & qos );
+                         const rmw_qos_profile_t & qos,
+                         bool use_loaned_messages = false );
     void publish( sensor_msgs::msg::Image::UniquePtr image_ptr ) override;
+    bool fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func ) override;
     size_t get_subscription_count() const override;
+    // True if loaned messages were requested and the middleware can provide them for this topic
+    bool is_loaning_messages() const { return loan_messages; }
 
 private:
     rclcpp::Publisher< sensor_msgs::msg::Image >::SharedPtr image_publisher_impl;
+    bool loan_messages;
 };
 
 // image_transport implementation of an image publisher (adds a compressed image topic)
@@ -50,10 +62,14 @@ public:
                                const std::string & topic_name,
                                const rmw_qos_profile_t & qos );
     void publish( sensor_msgs::msg::Image::UniquePtr image_ptr ) override;
+    bool fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func ) override;
     size_t get_subscription_count() const override;
+    bool get_message_pool_stats( MessagePoolStats & stats ) const override;
 
 private:
     std::shared_ptr< image_transport::Publisher > image_publisher_impl;
+    // image_transport publishes by reference, so the messages stay ours and can be reused
+    MessagePool< sensor_msgs::msg::Image > message_pool;
 };
 
 }  // namespace realsense2_camera
@@ -0,0 +1,48 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include <sensor_msgs/msg/imu.hpp>
+#include "realsense2_camera_msgs/msg/imu_batch.hpp"
+
+namespace realsense2_camera
+{
+    // Gathers IMU messages and publishes them as a single ImuBatch message,
+    // once batch_size samples are gathered or once they span batch_period seconds (if > 0).
+    // The batch message is reused, so its samples don't allocate once the first batch is published.
+    class ImuBatcher
+    {
+        public:
+            ImuBatcher(rclcpp::Publisher<realsense2_camera_msgs::msg::ImuBatch>::SharedPtr publisher, size_t batch_size, double batch_period);
+            ~ImuBatcher();
+            void add(const sensor_msgs::msg::Imu& imu_msg);
+            void flush();
+            size_t getNumSubscribers() const;
+
+        private:
+            void publishBatch();
+
+            std::mutex _mutex;
+            rclcpp::Publisher<realsense2_camera_msgs::msg::ImuBatch>::SharedPtr _publisher;
+            size_t _batch_size;
+            rclcpp::Duration _batch_period;
+            realsense2_camera_msgs::msg::ImuBatch _batch;
+            std::vector<sensor_msgs::msg::Imu> _unused_samples;    // the samples past a partial batch, while it's published
+            size_t _samples_count;
+    };
+}
@@ -0,0 +1,80 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Histogram of latencies in nanoseconds. Recording is lock-free and may be done from any thread.
+    // The buckets are logarithmic, 8 per power of two: percentiles are accurate to 12.5%.
+    class LatencyHistogram
+    {
+        public:
+            struct Summary
+            {
+                uint64_t count;
+                double p50_ms;
+                double p95_ms;
+                double p99_ms;
+                double max_ms;
+            };
+
+            LatencyHistogram();
+            void record(int64_t latency_ns);
+            Summary getSummary() const;
+            void reset();
+
+            static int bucketIndex(uint64_t latency_ns);
+            static uint64_t bucketUpperBound(int index);   // largest latency of the bucket
+
+            static const int SUB_BUCKETS_BITS = 3;
+            static const int BUCKETS_COUNT = (64 - SUB_BUCKETS_BITS + 1) << SUB_BUCKETS_BITS;
+
+        private:
+            std::atomic<uint64_t> _buckets[BUCKETS_COUNT];
+            std::atomic<uint64_t> _max_ns;
+    };
+
+    // Latency histograms by stage and stream, for the diagnostics and the latency_stats topic.
+    class LatencyStats
+    {
+        public:
+            struct Entry
+            {
+                std::string stage;
+                std::string stream;
+                LatencyHistogram::Summary summary;
+            };
+
+            // Created on first use. Histograms are never removed, so the returned pointer can be kept
+            // to record without a lookup on every frame.
+            LatencyHistogram* getHistogram(const std::string& stage, const std::string& stream);
+            std::vector<Entry> getEntries() const;     // histograms with at least one latency, ordered by stage and stream
+            void reset();
+
+            static int64_t now();    // steady clock nanoseconds, the time base of the recorded latencies
+
+        private:
+            mutable std::mutex _mutex;
+            std::map<std::pair<std::string, std::string>, std::unique_ptr<LatencyHistogram>> _histograms;
+    };
+}
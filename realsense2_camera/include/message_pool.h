@@ -0,0 +1,110 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace realsense2_camera
+{
+    struct MessagePoolStats
+    {
+        size_t in_use = 0;            // messages currently handed out
+        size_t free = 0;              // messages kept for reuse
+        size_t high_water_mark = 0;   // maximal number of messages handed out at the same time
+        size_t allocations = 0;       // messages allocated since the pool was created
+    };
+
+    // Recycles messages, together with the buffers they already hold, between frames.
+    // The pointer returned by acquire() hands the message back to the pool when it is released,
+    // so the data vector of a stream is allocated once per profile instead of once per frame.
+    // Pooled messages keep their previous content: the user is expected to overwrite all fields.
+    template<class MsgT>
+    class MessagePool
+    {
+        private:
+            struct State
+            {
+                std::mutex mutex;
+                std::vector<std::unique_ptr<MsgT>> free_messages;
+                size_t max_free_messages;
+                MessagePoolStats stats;
+            };
+
+        public:
+            class Deleter
+            {
+                public:
+                    Deleter() = default;
+                    explicit Deleter(const std::shared_ptr<State>& state) : _state(state) {}
+                    void operator()(MsgT* msg) const
+                    {
+                        std::unique_ptr<MsgT> owned_msg(msg);
+                        auto state = _state.lock();
+                        if (!state) return;     // pool is gone, just free the message
+
+                        std::lock_guard<std::mutex> lock_guard(state->mutex);
+                        state->stats.in_use--;
+                        if (state->free_messages.size() < state->max_free_messages)
+                            state->free_messages.push_back(std::move(owned_msg));
+                    }
+
+                private:
+                    std::weak_ptr<State> _state;
+            };
+            typedef std::unique_ptr<MsgT, Deleter> Ptr;
+
+            explicit MessagePool(size_t max_free_messages = 2) :
+                _state(std::make_shared<State>())
+            {
+                _state->max_free_messages = max_free_messages;
+            }
+
+            Ptr acquire()
+            {
+                std::unique_ptr<MsgT> msg;
+                {
+                    std::lock_guard<std::mutex> lock_guard(_state->mutex);
+                    if (!_state->free_messages.empty())
+                    {
+                        msg = std::move(_state->free_messages.back());
+                        _state->free_messages.pop_back();
+                    }
+                    else
+                    {
+                        _state->stats.allocations++;
+                    }
+                    _state->stats.in_use++;
+                    if (_state->stats.in_use > _state->stats.high_water_mark)
+                        _state->stats.high_water_mark = _state->stats.in_use;
+                }
+                if (!msg)
+                    msg.reset(new MsgT());
+                return Ptr(msg.release(), Deleter(_state));
+            }
+
+            MessagePoolStats getStats() const
+            {
+                std::lock_guard<std::mutex> lock_guard(_state->mutex);
+                MessagePoolStats stats(_state->stats);
+                stats.free = _state->free_messages.size();
+                return stats;
+            }
+
+        private:
+            std::shared_ptr<State> _state;
+    };
+}
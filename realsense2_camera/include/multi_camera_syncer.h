@@ -0,0 +1,58 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <rclcpp/rclcpp.hpp>
+#include "realsense2_camera_msgs/msg/rgbd.hpp"
+#include "realsense2_camera_msgs/msg/multi_rgbd.hpp"
+#include <frame_group_syncer.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace realsense2_camera
+{
+    // The RGBD messages of the camera nodes of a process that are in the same sync group, matched by their stamps
+    // and published together as a single MultiRGBD message on /<group>/multi_rgbd, through the publisher of one
+    // of the members. The message is published by the thread of the member whose frame completed the group.
+    class MultiCameraSyncer
+    {
+        public:
+            typedef rclcpp::Publisher<realsense2_camera_msgs::msg::MultiRGBD>::SharedPtr MultiRGBDPublisher;
+            typedef std::shared_ptr<const realsense2_camera_msgs::msg::RGBD> RGBDConstPtr;
+
+            // The syncer of the group, created by the first call and destroyed with its last user.
+            // The tolerance and the queue size are those of its first user.
+            static std::shared_ptr<MultiCameraSyncer> getInstance(const std::string& group, double tolerance_seconds, size_t queue_size);
+
+            static std::string topicName(const std::string& group) { return "/" + group + "/multi_rgbd"; }
+
+            void addMember(const std::string& camera_name, MultiRGBDPublisher publisher);
+            void removeMember(const std::string& camera_name);
+
+            // false if nobody subscribes to the group: the members don't need to make their RGBD messages then
+            bool isSubscribed();
+            void push(const std::string& camera_name, RGBDConstPtr msg);
+
+        private:
+            MultiCameraSyncer(double tolerance_seconds, size_t queue_size);
+
+            std::mutex _mutex;
+            FrameGroupSyncer<RGBDConstPtr> _syncer;
+            std::map<std::string, MultiRGBDPublisher> _publishers;
+    };
+}
@@ -16,10 +16,14 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
 #include <librealsense2/rs.hpp>
 #include <sensor_params.h>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <ros_sensor.h>
+#include <message_pool.h>
+#include <task_pool.h>
+#include <pointcloud_encoding.h>
 
 namespace realsense2_camera
 {
@@ -51,19 +55,51 @@ namespace realsense2_camera
     class PointcloudFilter : public NamedFilter
     {
         public:
-            PointcloudFilter(std::shared_ptr<rs2::filter> filter, rclcpp::Node& node, std::shared_ptr<Parameters> parameters, rclcpp::Logger logger, bool is_enabled=false);
+            PointcloudFilter(std::shared_ptr<rs2::filter> filter, rclcpp::Node& node, std::shared_ptr<Parameters> parameters, rclcpp::Logger logger, bool is_enabled=false, bool use_loaned_messages=false);
         
             void setPublisher();
             void Publish(rs2::points pc, const rclcpp::Time& t, const rs2::frameset& frameset, const std::string& frame_id);
+            size_t getSubscriptionCount();
+            // Returns false if the pointcloud messages are not recycled
+            bool getMessagePoolStats(MessagePoolStats& stats) const;
 
         private:
+            // The points selection, set by the parameters callbacks and read once per message by fillPointCloudMsg()
+            struct Settings
+            {
+                bool allow_no_texture_points;
+                bool ordered_pc;
+                int num_threads;
+                // Published pixels: every stride pixels of the ROI, with depth in [min_z, max_z]. 0 sizes and max_z mean to the end.
+                int roi_x, roi_y, roi_width, roi_height;
+                int stride;
+                double min_z, max_z;
+            };
+
             void setParameters();
+            template <class T>
+            void setSettingParam(const std::string& param_name, T Settings::* setting,
+                                 rcl_interfaces::msg::ParameterDescriptor descriptor=rcl_interfaces::msg::ParameterDescriptor());
+            Settings getSettings();
+            void fillPointCloudMsg(sensor_msgs::msg::PointCloud2& msg_pointcloud, rs2::points pc, const rs2::video_frame& texture_frame,
+                                   const rclcpp::Time& t, const std::string& frame_id);
+            void updateTaskPool(size_t threads_count);
+            void setROIParameters(const std::string& module_name);
 
         private:
             bool _is_enabled_pc;
             rclcpp::Node& _node;
-            bool _allow_no_texture_points;
-            bool _ordered_pc;
+            std::mutex _settings_mutex;
+            Settings _settings;
+            std::string _encoding;
+            std::atomic<PointEncoding> _point_encoding;    // parsed _encoding, read while filling the messages
+            std::shared_ptr<TaskPool> _task_pool;        // Splits the pointcloud in row bands when num_threads > 1
+            // Framesets missing the texture stream in a row. Per filter, so that a camera's warnings don't hide another's.
+            // Atomic, as the publishing pool threads of a camera take turns calling Publish().
+            std::atomic<int> _no_texture_warn_count;
+            bool _use_loaned_messages;
+            bool _use_intra_process;
+            MessagePool<sensor_msgs::msg::PointCloud2> _msg_pool;
             std::mutex _mutex_publisher;
             rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr _pointcloud_publisher;
             std::string _pointcloud_qos;
@@ -0,0 +1,66 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // What the parameters of a sensor option are made of, besides its current value:
+    // the range, the description and the descriptions of the enum values.
+    struct OptionInfo
+    {
+        int option;         // rs2_option
+        float min, max, step, def;
+        std::string description;
+        std::vector<std::pair<int, std::string> > value_descriptions;     // sorted by value, empty if not an enum option
+
+        bool operator==(const OptionInfo& other) const;
+        bool operator!=(const OptionInfo& other) const { return !(*this == other); }
+    };
+
+    typedef std::vector<OptionInfo> SensorOptionsInfo;     // the writable options of a sensor
+
+    // The options of the sensors of a device, kept in a text file between runs.
+    // Enumerating them takes several control transfers per option, while their ranges and
+    // descriptions only change with the firmware: the file name holds the serial number and the
+    // firmware version, and the signature (the librealsense version) is checked on load.
+    // Thread safe.
+    class OptionsCache
+    {
+        public:
+            OptionsCache(const std::string& file_path, const std::string& signature);
+
+            bool load();            // false if the file doesn't exist, is invalid or has another signature
+            bool save() const;      // written to a temporary file first, so that an interrupted save leaves no half file
+            bool get(const std::string& module_name, SensorOptionsInfo& options) const;
+            void set(const std::string& module_name, const SensorOptionsInfo& options);
+            const std::string& getFilePath() const { return _file_path; }
+
+            static std::string filePath(const std::string& cache_dir, const std::string& serial_no, const std::string& firmware_version);
+            std::string serialize() const;
+            bool parse(const std::string& content);
+
+        private:
+            const std::string _file_path;
+            const std::string _signature;
+            mutable std::mutex _mutex;
+            std::map<std::string, SensorOptionsInfo> _sensors;
+    };
+}
@@ -0,0 +1,78 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+namespace realsense2_camera
+{
+    // Decides, before a frameset is processed, which of its outputs (FilterOutput bits) are computed:
+    // - an output is computed at most max_rate times per second (0 for no limit),
+    // - while the host is overloaded, only every load_decimation-th frameset of an output is computed.
+    // The host is overloaded when the latency the framesets come with (from their arrival to the frame callback),
+    // smoothed over the last framesets, exceeds the latency budget, until it is back under 80% of it.
+    // A negative latency is unknown and leaves the smoothed latency as is; a single frameset late by more than
+    // twice the budget, e.g. after a clock step, counts as twice the budget.
+    // The outputs without settings are never throttled. Thread safe.
+    class OutputThrottle
+    {
+        public:
+            struct Settings
+            {
+                double max_rate;        // Hz
+                int load_decimation;
+            };
+
+            struct Stats
+            {
+                uint64_t computed;
+                uint64_t rate_limited;
+                uint64_t decimated;
+            };
+
+            explicit OutputThrottle(double latency_budget_seconds = 0);     // 0 for no load adaptation
+
+            void setLatencyBudget(double latency_budget_seconds);
+            void setOutput(unsigned int output, const Settings& settings);
+            bool isEnabled();
+
+            // Returns the outputs of demand to compute for the frameset stamped time_ns, latency_ns < 0 if unknown
+            unsigned int filter(unsigned int demand, int64_t time_ns, int64_t latency_ns);
+
+            bool isOverloaded();
+            double getLatencySeconds();     // smoothed
+            std::map<unsigned int, Stats> getStats();
+
+        private:
+            struct Output
+            {
+                Settings settings;
+                Stats stats;
+                bool has_next_time;
+                int64_t next_time_ns;
+                uint64_t decimation_count;
+            };
+
+            std::mutex _mutex;
+            int64_t _latency_budget_ns;
+            double _latency_ns;
+            bool _has_latency;
+            bool _is_overloaded;
+            std::map<unsigned int, Output> _outputs;
+    };
+}
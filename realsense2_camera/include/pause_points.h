@@ -0,0 +1,56 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+
+namespace realsense2_camera
+{
+    // Messages counts at which the frames in process paused a publisher, oldest first.
+    // Each point is removed by the id add() returned, so frames may finish, or be dropped, in any order:
+    // the release limit stays at the oldest point still in process.
+    // Not thread safe.
+    class PausePoints
+    {
+        public:
+            using Id = uint64_t;
+
+            PausePoints() : _next_id(0) {}
+
+            Id add(size_t messages_count)
+            {
+                _points.emplace(_next_id, messages_count);
+                return _next_id++;
+            }
+
+            void remove(Id id) { _points.erase(id); }
+
+            bool empty() const { return _points.empty(); }
+            size_t size() const { return _points.size(); }
+
+            // Messages counts only grow, so the oldest point holds the lowest count.
+            size_t releaseLimit() const
+            {
+                return _points.empty() ? std::numeric_limits<size_t>::max() : _points.begin()->second;
+            }
+
+        private:
+            std::map<Id, size_t> _points;
+            Id                   _next_id;
+    };
+}
@@ -0,0 +1,71 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace realsense2_camera
+{
+    struct PipelineStageStats
+    {
+        size_t queue_size = 0;        // jobs waiting to be run
+        size_t max_queue_size = 0;
+        size_t processed = 0;         // jobs run since the stage was created
+        size_t dropped = 0;           // jobs dropped because the queue was full
+    };
+
+    // A worker thread running jobs from a bounded queue, in the order they were pushed.
+    // When the queue is full a job is dropped, so a slow stage never blocks the stage feeding it.
+    class PipelineStage
+    {
+        public:
+            enum class DropPolicy
+            {
+                DROP_OLDEST,    // drop the oldest waiting job, to keep latency low
+                DROP_NEWEST     // drop the pushed job
+            };
+            typedef std::function<void()> Job;     // jobs are expected to handle their own exceptions
+
+            PipelineStage(const std::string& name, size_t max_queue_size, DropPolicy drop_policy);
+            ~PipelineStage();   // discards the waiting jobs and joins the worker thread
+
+            bool push(Job job);     // returns false if a job was dropped
+            void flush();           // discards the waiting jobs and waits for the running one to finish
+            const std::string& getName() const { return _name; }
+            PipelineStageStats getStats() const;
+
+            static bool parseDropPolicy(const std::string& name, DropPolicy& drop_policy);
+
+        private:
+            void run();
+
+            std::string _name;
+            size_t _max_queue_size;
+            DropPolicy _drop_policy;
+            mutable std::mutex _mutex;
+            std::condition_variable _cv_job;
+            std::condition_variable _cv_idle;
+            std::deque<Job> _jobs;
+            bool _is_running;
+            bool _is_busy;
+            PipelineStageStats _stats;
+            std::thread _thread;
+    };
+}
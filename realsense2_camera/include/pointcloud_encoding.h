@@ -0,0 +1,121 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Header only, so that subscribers can decode the pointcloud messages without linking to the node.
+namespace realsense2_camera
+{
+    // Encodings of the x, y, z fields of the pointcloud messages (pointcloud.encoding):
+    // float32:  FLOAT32 fields in meters, padded to 16 bytes. Exact.
+    // int16_mm: INT16 fields in millimeters, 6 bytes. Rounded to the millimeter, saturated to +-32.767 meters.
+    // float16:  IEEE 754 half precision floats in meters, in UINT16 fields, 6 bytes. Rounded to 11 significant bits:
+    //           the error is at most 0.25 mm up to 1 meter, 0.5 mm up to 2 meters, 1 mm up to 4 meters and 2 mm up to 8 meters.
+    // With texture, a 4 bytes FLOAT32 rgb or intensity field follows the xyz fields.
+    enum class PointEncoding
+    {
+        FLOAT32,
+        INT16_MM,
+        FLOAT16
+    };
+
+    inline bool parsePointEncoding(const std::string& name, PointEncoding& encoding)
+    {
+        if (name == "float32")
+            encoding = PointEncoding::FLOAT32;
+        else if (name == "int16_mm")
+            encoding = PointEncoding::INT16_MM;
+        else if (name == "float16")
+            encoding = PointEncoding::FLOAT16;
+        else
+            return false;
+        return true;
+    }
+
+    // Bytes of the xyz fields of a point
+    inline size_t xyzSize(PointEncoding encoding)
+    {
+        return (encoding == PointEncoding::FLOAT32) ? 16 : 6;
+    }
+
+    inline size_t pointStep(PointEncoding encoding, bool use_texture)
+    {
+        return xyzSize(encoding) + (use_texture ? 4 : 0);
+    }
+
+    inline int16_t metersToInt16Mm(float meters)
+    {
+        if (!(std::fabs(meters) <= 32.767f))
+            return (meters > 0) ? 32767 : ((meters < 0) ? -32767 : 0);
+        float mm = meters * 1000.f;
+        return static_cast<int16_t>(mm + ((mm >= 0) ? 0.5f : -0.5f));
+    }
+
+    inline float int16MmToMeters(int16_t mm)
+    {
+        return mm * 0.001f;
+    }
+
+    // Rounds to the nearest half float, ties to even.
+    inline uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        uint32_t abs_bits = bits & 0x7fffffff;
+        if (abs_bits > 0x7f800000)                  // nan
+            return sign | 0x7e00;
+        if (abs_bits >= 0x477ff000)                 // rounds above 65504, the largest half float
+            return sign | 0x7c00;
+        if (abs_bits >= 0x38800000)                 // normal half float
+        {
+            uint32_t half = (abs_bits - 0x38000000) >> 13;
+            uint32_t rest = abs_bits & 0x1fff;
+            half += (rest > 0x1000 || (rest == 0x1000 && (half & 1))) ? 1 : 0;
+            return sign | static_cast<uint16_t>(half);
+        }
+        if (abs_bits < 0x33000000)                  // rounds to zero
+            return sign;
+        // subnormal half float, in units of 2^-24
+        uint32_t mantissa = (abs_bits & 0x7fffff) | 0x800000;
+        int shift = 126 - static_cast<int>(abs_bits >> 23);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        half += (rest > halfway || (rest == halfway && (half & 1))) ? 1 : 0;
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    inline float halfToFloat(uint16_t half)
+    {
+        uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1f;
+        uint32_t mantissa = half & 0x3ff;
+        if (exponent == 0)
+        {
+            float value = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign ? -value : value;
+        }
+        uint32_t bits = sign | ((exponent == 0x1f) ? (0x7f800000 | (mantissa << 13)) : (((exponent + 112) << 23) | (mantissa << 13)));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
@@ -0,0 +1,78 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <pointcloud_encoding.h>
+
+namespace realsense2_camera
+{
+    // Point layouts of the float32 encoding of the PointCloud2 messages: the "xyz" fields as set by PointCloud2Modifier,
+    // padded to 16 bytes, followed with texture by a single 4 bytes "rgb" or "intensity" field.
+    struct PackedPoint
+    {
+        float x, y, z;
+        uint32_t padding;
+    };
+
+    struct PackedTexturedPoint
+    {
+        float x, y, z;
+        uint32_t padding;
+        uint8_t color[4];   // rgb textures are stored as bgr, as PointCloud2 expects
+    };
+
+    static_assert(sizeof(PackedPoint) == 16, "PackedPoint must match the PointCloud2 xyz point_step");
+    static_assert(sizeof(PackedTexturedPoint) == 20, "PackedTexturedPoint must match the PointCloud2 xyz + color point_step");
+
+    struct PointcloudTexture
+    {
+        const uint8_t* data;
+        int width;
+        int height;
+        int bytes_per_pixel;    // 1 for Y8 (intensity) or 3 for RGB8 (rgb)
+    };
+
+    // The input points taken: count points, one every stride points of the input, within [min_z, max_z].
+    // Ordered points out of the z range are written as zeros.
+    struct PointSelection
+    {
+        size_t stride = 1;
+        float min_z = -std::numeric_limits<float>::infinity();
+        float max_z = std::numeric_limits<float>::infinity();
+    };
+
+    // Input points are given as rs2::points provides them: 3 floats per vertex and 2 floats (u, v) per texture coordinate.
+    // A point is valid if its z is positive and in range and, with texture, if it projects into the texture image (or allow_no_texture_points).
+    // Pack functions write the valid points, or all the points if ordered, to dst and return the number of points written.
+    // They write at most capacity points: dst may be a band of a larger buffer filled by another thread.
+    size_t packPoints(const float* vertices, size_t count, bool ordered, PackedPoint* dst, size_t capacity,
+                      const PointSelection& selection = PointSelection());
+    size_t countValidPoints(const float* vertices, size_t count, const PointSelection& selection = PointSelection());
+
+    size_t packTexturedPoints(const float* vertices, const float* texture_coordinates, size_t count,
+                              const PointcloudTexture& texture, bool allow_no_texture_points, bool ordered,
+                              PackedTexturedPoint* dst, size_t capacity, const PointSelection& selection = PointSelection());
+    size_t countValidTexturedPoints(const float* vertices, const float* texture_coordinates, size_t count, bool allow_no_texture_points,
+                                    const PointSelection& selection = PointSelection());
+
+    // Packs the points in any encoding, laid out as described in pointcloud_encoding.h, pointStep(encoding, texture) bytes apart.
+    // texture is nullptr to pack the points without texture. The float32 encoding gives the same bytes as the functions above.
+    size_t packEncodedPoints(PointEncoding encoding, const float* vertices, const float* texture_coordinates, size_t count,
+                             const PointcloudTexture* texture, bool allow_no_texture_points, bool ordered,
+                             uint8_t* dst, size_t capacity, const PointSelection& selection = PointSelection());
+}
@@ -38,6 +38,10 @@ namespace realsense2_camera
                                         std::map<stream_index_pair, std::shared_ptr<std::string> >& params, 
                                         std::string value);
 
+            void registerSensorVideoEncoderParam(std::string template_name,
+                                                 std::set<stream_index_pair> unique_sips,
+                                                 std::map<stream_index_pair, std::shared_ptr<std::string> >& params);
+
             template<class T>
             void registerSensorUpdateParam(std::string template_name, 
                                            std::set<stream_index_pair> unique_sips, 
@@ -49,6 +53,7 @@ namespace realsense2_camera
             bool hasSIP(const stream_index_pair& sip) const;
             rmw_qos_profile_t getQOS(const stream_index_pair& sip) const;
             rmw_qos_profile_t getInfoQOS(const stream_index_pair& sip) const;
+            std::string getVideoEncoder(const stream_index_pair& sip) const;   // empty if the stream is not video encoded
 
         protected:
             std::map<stream_index_pair, rs2::stream_profile> getDefaultProfiles();
@@ -58,6 +63,7 @@ namespace realsense2_camera
             SensorParams _params;
             std::map<stream_index_pair, std::shared_ptr<bool>> _enabled_profiles;
             std::map<stream_index_pair, std::shared_ptr<std::string>> _profiles_image_qos_str, _profiles_info_qos_str;
+            std::map<stream_index_pair, std::shared_ptr<std::string>> _profiles_video_encoder_str;
             std::vector<rs2::stream_profile> _all_profiles;
             std::vector<std::string> _parameters_names;
     };
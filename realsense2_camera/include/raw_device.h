@@ -0,0 +1,79 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <librealsense2/rs.hpp>
+#include <librealsense2/hpp/rs_internal.hpp>
+#include <raw_record.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Records the frames of the sensors as they come from the device, before any filter, to a raw recording.
+    // The streams are those the sensors are started with: a new recorder is made when they change.
+    class RawRecorder
+    {
+        public:
+            // Throws std::runtime_error if the recording can't be made in dir_path
+            RawRecorder(const std::string& dir_path, size_t segment_size, rs2::device dev, const std::vector<rs2::sensor>& sensors);
+            ~RawRecorder();
+
+            void record(const rs2::frame& frame);
+            RawRecordWriter& getWriter() { return _writer; }
+
+        private:
+            RawRecordWriter _writer;
+            std::map<int, uint32_t> _stream_ids;        // by rs2::stream_profile::unique_id()
+    };
+
+    // A software device playing a raw recording back: the node handles it like the device that was recorded,
+    // its frames are replayed at the pace they were recorded, with their timestamps and metadata.
+    class RawPlaybackDevice
+    {
+        public:
+            // Throws std::runtime_error if the recording can't be opened
+            explicit RawPlaybackDevice(const std::string& dir_path);
+            ~RawPlaybackDevice();
+
+            rs2::device getDevice() { return _device; }
+            void play();    // from the first frame, once the sensors are started
+            void stop();
+
+        private:
+            struct Stream
+            {
+                rs2::software_sensor sensor;
+                rs2::stream_profile profile;
+                int bytes_per_pixel;
+                int stride;
+                float depth_units;
+            };
+
+            void replay();
+
+            RawRecordReader _reader;
+            rs2::software_device _device;
+            std::map<uint32_t, Stream> _streams;
+            std::atomic_bool _is_playing;
+            std::thread _replay_thread;
+    };
+}
@@ -0,0 +1,165 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // A raw recording is a directory holding:
+    // - "streams": the device, sensors and stream profiles, in a text file written when the recording starts,
+    // - "segment_<n>": the metadata and the payloads of the frames, copied as they are,
+    // - "index": a RawFrameIndex per frame, in arrival order.
+    // The values are those of librealsense (rs2_stream, rs2_format, rs2_camera_info...), kept as integers.
+    struct RawStreamInfo
+    {
+        uint32_t stream_id;         // the id of the stream in the index
+        int stream, index, format, fps, unique_id;
+        bool is_video;
+        int width, height;          // video streams only, the stride is that of the first frame
+        float ppx, ppy, fx, fy;
+        int model;
+        float coeffs[5];
+        float rotation[9], translation[3];                      // the extrinsics to the first stream of the recording
+    };
+
+    struct RawSensorInfo
+    {
+        std::string name;
+        float depth_units;          // 0 if not a depth sensor
+        std::vector<RawStreamInfo> streams;
+    };
+
+    struct RawRecordDescription
+    {
+        std::vector<std::pair<int, std::string> > infos;        // rs2_camera_info and its value
+        std::vector<RawSensorInfo> sensors;
+
+        std::string serialize() const;
+        bool parse(const std::string& content);
+    };
+
+    struct RawFrameIndex
+    {
+        uint32_t stream_id;
+        uint32_t segment;
+        uint64_t offset;            // of the payload in the segment, the metadata are right before it
+        uint32_t size;
+        uint32_t metadata_count;
+        uint64_t frame_number;
+        double timestamp;           // milliseconds
+        int32_t timestamp_domain;
+        int32_t reserved;
+        int64_t arrival_time_ns;    // steady clock, for replaying the frames at the pace they came
+    };
+
+    struct RawMetadata
+    {
+        int32_t key;                // rs2_frame_metadata_value
+        int32_t reserved;
+        int64_t value;
+    };
+
+    // Appends the frames to segment files of segment_size bytes, allocated on disk when they are opened and mapped
+    // in memory: writing a frame is copying it, without system call, and the kernel writes the pages back
+    // in the background (started every segment_size / 16 bytes, so that dirty pages don't pile up).
+    // The next segment is allocated and mapped ahead by a background thread, which also finishes the full segments:
+    // the writing threads only swap the segments. They wait for the next segment only if it is still being allocated.
+    // Thread safe.
+    class RawRecordWriter
+    {
+        public:
+            RawRecordWriter(const std::string& dir_path, size_t segment_size);
+            ~RawRecordWriter();
+
+            bool open(const RawRecordDescription& description);
+            // The segment and the offset of the index are set by the writer.
+            // False if the frame is larger than a segment or couldn't be written: the frame is dropped.
+            bool write(RawFrameIndex index, const RawMetadata* metadata, const void* data);
+            bool close();           // false if the end of the recording couldn't be written
+
+            bool isOpen();
+            uint64_t getFramesCount();
+            uint64_t getDroppedCount();
+            const std::string& getDirPath() const { return _dir_path; }
+
+        private:
+            struct Segment
+            {
+                Segment() : fd(-1), data(nullptr), number(0), used(0) {}
+                int fd;                 // -1 if not open
+                uint8_t* data;
+                uint32_t number;
+                size_t used;
+            };
+
+            Segment openSegment(uint32_t number);
+            bool closeSegment(Segment& segment);
+            bool swapSegment();
+            void prepareSegments();
+            void stopSegmentsThread();
+            bool flushIndex();
+
+            const std::string _dir_path;
+            const size_t _segment_size;
+            std::mutex _mutex;
+            Segment _segment;
+            size_t _segment_flushed;
+            int _index_fd;
+            // Shared with the segments thread, under _segments_mutex
+            std::thread _segments_thread;
+            std::mutex _segments_mutex;
+            std::condition_variable _segments_cv;
+            bool _is_segments_thread_running;
+            bool _is_next_segment_wanted;       // the segments thread is to open _next_segment
+            uint32_t _next_segment_number;
+            Segment _next_segment;
+            std::vector<Segment> _full_segments;
+            bool _is_segment_close_failed;
+            std::vector<RawFrameIndex> _pending_index;
+            uint64_t _frames_count;
+            uint64_t _dropped_count;
+    };
+
+    // Maps a raw recording read only. The metadata and the payloads stay valid while the reader lives.
+    class RawRecordReader
+    {
+        public:
+            RawRecordReader();
+            ~RawRecordReader();
+
+            bool open(const std::string& dir_path);     // false if a file is missing or invalid
+            const RawRecordDescription& getDescription() const { return _description; }
+            size_t size() const { return _frames.size(); }
+            const RawFrameIndex& index(size_t frame) const { return _frames[frame]; }
+            const RawMetadata* metadata(size_t frame) const;
+            const void* data(size_t frame) const;
+
+        private:
+            void close();
+
+            RawRecordDescription _description;
+            std::vector<RawFrameIndex> _frames;
+            std::vector<std::pair<uint8_t*, size_t> > _segments;         // mapped address and size
+    };
+}
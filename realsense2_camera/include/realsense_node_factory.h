@@ -17,16 +17,20 @@
 // cpplint: c system headers
 #include "constants.h"
 #include "base_realsense_node.h"
+#include "device_registry.h"
+#include "raw_device.h"
 #include <builtin_interfaces/msg/time.hpp>
 #include <console_bridge/console.h>
 #include <rclcpp/rclcpp.hpp>
 #include "rclcpp_components/register_node_macro.hpp"
 #include <algorithm>
+#include <condition_variable>
 #include <csignal>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -47,8 +51,12 @@ namespace realsense2_camera
         void init();
         void closeDevice();
         void startDevice();
+        void startOrReconnectDevice();
         void changeDeviceCallback(rs2::event_information& info);
         void getDevice(rs2::device_list list);
+        bool isRequestedDevice(rs2::device dev);
+        void logDeviceUsbType();
+        void startSharedContextDiscovery();
         void tryGetLogSeverity(rs2_log_severity& severity) const;
         static std::string parseUsbPort(std::string line);
 
@@ -62,8 +70,21 @@ namespace realsense2_camera
         double _wait_for_device_timeout;
         double _reconnect_timeout;
         bool _initial_reset;
+        double _initial_reset_stagger;
+        bool _hot_reconnect;
         std::thread _query_thread;
         bool _is_alive;
+        // The devices changed events are handed over to _query_thread under _device_mutex
+        std::mutex _device_mutex;
+        std::condition_variable _cv_device;
+        rs2::device _connected_device;
+        bool _is_query_needed;
+        bool _is_device_removed;
+        // shared_context: the device is given by the registry
+        std::shared_ptr<DeviceRegistry> _device_registry;
+        std::shared_ptr<RawPlaybackDevice> _raw_playback;
+        size_t _registry_client_id;
+        rs2::device _given_device;
         rclcpp::Logger _logger;
         std::shared_ptr<Parameters> _parameters;
     };
@@ -82,7 +82,8 @@ namespace realsense2_camera
                       std::shared_ptr<diagnostic_updater::Updater> diagnostics_updater,
                       rclcpp::Logger logger,
                       bool force_image_default_qos = false,
-                      bool is_rosbag_file = false);
+                      bool is_rosbag_file = false,
+                      std::shared_ptr<OptionsCache> options_cache = nullptr);
             ~RosSensor();
             void registerSensorParameters();
             bool getUpdatedProfiles(std::vector<rs2::stream_profile>& wanted_profiles);
@@ -91,6 +92,10 @@ namespace realsense2_camera
             void stop();
             rmw_qos_profile_t getQOS(const stream_index_pair& sip) const;
             rmw_qos_profile_t getInfoQOS(const stream_index_pair& sip) const;
+            std::string getVideoEncoder(const stream_index_pair& sip) const;
+            // Queries the options registered from the cache again. If they changed, updates the cache and returns true.
+            bool validateCachedOptions();
+            bool isOptionsCached() const { return _is_options_cached; }
 
             template<class T> 
             bool is() const
@@ -122,5 +127,8 @@ namespace realsense2_camera
             std::shared_ptr<diagnostic_updater::Updater> _diagnostics_updater;
             std::map<stream_index_pair, FrequencyDiagnostics> _frequency_diagnostics;
             bool _force_image_default_qos;
+            std::shared_ptr<OptionsCache> _options_cache;
+            SensorOptionsInfo _cached_options;
+            bool _is_options_cached;
     };
 }
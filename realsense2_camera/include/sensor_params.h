@@ -16,6 +16,7 @@
 #include <librealsense2/rs.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <dynamic_params.h>
+#include <options_cache.h>
 
 namespace realsense2_camera
 {
@@ -27,6 +28,9 @@ namespace realsense2_camera
                 _parameters(parameters) {};
             ~SensorParams();
             void registerDynamicOptions(rs2::options sensor, const std::string& module_name);
+            // As above, with options already queried, possibly on an earlier run (see OptionsCache)
+            void registerDynamicOptions(rs2::options sensor, const std::string& module_name, const SensorOptionsInfo& options);
+            SensorOptionsInfo queryOptions(rs2::options sensor);
             void clearParameters();
             std::shared_ptr<Parameters> getParameters() {return _parameters;};
 
@@ -39,7 +43,7 @@ namespace realsense2_camera
             rcl_interfaces::msg::ParameterDescriptor get_parameter_descriptor(const std::string& option_name, rs2::option_range option_range,
                 T option_value, const std::string& option_description, const std::string& description_addition);
             template<class T>
-            void set_parameter(rs2::options sensor, rs2_option option, const std::string& module_name, const std::string& description_addition="");
+            void set_parameter(rs2::options sensor, const OptionInfo& info, const std::string& module_name, const std::string& description_addition="");
 
         private:
             std::shared_ptr<Parameters> _parameters;
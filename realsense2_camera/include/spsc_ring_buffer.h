@@ -0,0 +1,71 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // Fixed capacity, lock-free queue for a single producer thread and a single consumer thread.
+    // Several threads may take turns on one side, as long as they synchronize with each other.
+    template<class T>
+    class SpscRingBuffer
+    {
+        public:
+            explicit SpscRingBuffer(size_t capacity) :
+                _buffer(capacity + 1), _head(0), _tail(0)
+            {}
+
+            // Producer side. Returns false if the buffer is full.
+            bool push(const T& item)
+            {
+                size_t tail = _tail.load(std::memory_order_relaxed);
+                size_t next_tail = increment(tail);
+                if (next_tail == _head.load(std::memory_order_acquire))
+                    return false;
+                _buffer[tail] = item;
+                _tail.store(next_tail, std::memory_order_release);
+                return true;
+            }
+
+            // Consumer side. Returns nullptr if the buffer is empty. The item stays valid until pop().
+            T* front()
+            {
+                size_t head = _head.load(std::memory_order_relaxed);
+                if (head == _tail.load(std::memory_order_acquire))
+                    return nullptr;
+                return &_buffer[head];
+            }
+
+            // Consumer side, after front() returned an item.
+            void pop()
+            {
+                size_t head = _head.load(std::memory_order_relaxed);
+                _head.store(increment(head), std::memory_order_release);
+            }
+
+            bool empty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+            size_t capacity() const { return _buffer.size() - 1; }
+
+        private:
+            size_t increment(size_t index) const { return (index + 1 == _buffer.size()) ? 0 : index + 1; }
+
+            std::vector<T> _buffer;
+            std::atomic<size_t> _head;  // next item to pop, written by the consumer
+            std::atomic<size_t> _tail;  // next free slot, written by the producer
+    };
+}
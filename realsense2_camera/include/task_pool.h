@@ -0,0 +1,65 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // A fixed set of threads running batches of independent tasks.
+    // run() returns once all the tasks of the batch are done, so a batch takes as long as its slowest task
+    // rather than the sum of all of them. The calling thread runs tasks as well while it waits.
+    class TaskPool
+    {
+        public:
+            typedef std::function<void()> Task;
+
+            explicit TaskPool(size_t threads_count);    // threads_count includes the thread calling run()
+            ~TaskPool();
+
+            // Rethrows the first exception thrown by a task, after all the tasks are done.
+            void run(const std::vector<Task>& tasks);
+            size_t getThreadsCount() const { return _workers.size() + 1; }
+
+        private:
+            struct Batch
+            {
+                size_t pending_tasks = 0;
+                std::exception_ptr error;
+            };
+            struct QueuedTask
+            {
+                const Task* task;
+                std::shared_ptr<Batch> batch;
+            };
+
+            void work();
+            void runTask(std::unique_lock<std::mutex>& lock, const QueuedTask& queued_task);
+
+            std::mutex _mutex;
+            std::condition_variable _cv_task;
+            std::condition_variable _cv_done;
+            std::deque<QueuedTask> _tasks;
+            bool _is_running;
+            std::vector<std::thread> _workers;
+    };
+}
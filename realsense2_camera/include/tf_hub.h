@@ -0,0 +1,71 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <rclcpp/rclcpp.hpp>
+#include <tf2_ros/transform_broadcaster.h>
+#include <geometry_msgs/msg/transform_stamped.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realsense2_camera
+{
+    // The dynamic transforms (/tf) of the camera nodes of a process, published by a single thread:
+    // the transforms of the nodes due at the same tick share their stamp and are sent as a single message,
+    // through the broadcaster of one of them.
+    // The providers are called with the hub lock held: they should only copy their transforms.
+    class TfHub
+    {
+        public:
+            // Fills the transforms stamped with t: false if there is nothing to send
+            typedef std::function<bool(std::vector<geometry_msgs::msg::TransformStamped>& msgs, const rclcpp::Time& t)> TransformsProvider;
+
+            // The hub of the process, created by the first call and destroyed with its last user
+            static std::shared_ptr<TfHub> getInstance();
+            ~TfHub();
+
+            size_t addClient(double rate, rclcpp::Clock::SharedPtr clock,
+                             std::shared_ptr<tf2_ros::TransformBroadcaster> broadcaster, TransformsProvider provider);
+            void removeClient(size_t client_id);    // the provider isn't called once it returns
+
+        private:
+            struct Client
+            {
+                std::chrono::steady_clock::duration period;
+                std::chrono::steady_clock::time_point next_time;
+                rclcpp::Clock::SharedPtr clock;
+                std::shared_ptr<tf2_ros::TransformBroadcaster> broadcaster;
+                TransformsProvider provider;
+            };
+
+            TfHub();
+            void publish();
+
+            rclcpp::Logger _logger;
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            std::map<size_t, Client> _clients;
+            size_t _next_client_id;
+            bool _is_running;
+            bool _is_clients_changed;
+            std::thread _publish_thread;
+    };
+}
@@ -0,0 +1,70 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <image_publisher.h>
+#include <sensor_msgs/msg/compressed_image.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace realsense2_camera {
+
+struct video_encoder_settings
+{
+    std::string encoder;  // FFmpeg encoder name, e.g. h264_nvenc, hevc_vaapi, h264_v4l2m2m, ffv1
+    int bitrate;          // bits per second, ignored by lossless encoders
+    int gop_size;         // frames between key frames
+    int fps;
+};
+
+// Publishes the images through another image publisher, and encoded by an FFmpeg video encoder,
+// hardware accelerated ones included, on the <topic_name>/video topic.
+// The sensor_msgs/CompressedImage messages hold one encoded packet each, their format is the codec name (h264, hevc, ffv1...).
+// Images are encoded only while the video topic has subscribers. A new subscriber starts from a key frame.
+// Available only if built with BUILD_WITH_VIDEO_ENCODER. Otherwise the images are only published through the other publisher.
+class video_encoder_publisher : public image_publisher
+{
+public:
+    video_encoder_publisher( rclcpp::Node & node,
+                             const std::string & topic_name,
+                             const rmw_qos_profile_t & qos,
+                             const video_encoder_settings & settings,
+                             std::shared_ptr< image_publisher > image_publisher_impl );
+    ~video_encoder_publisher() override;
+    void publish( sensor_msgs::msg::Image::UniquePtr image_ptr ) override;
+    bool fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func ) override;
+    size_t get_subscription_count() const override;
+    bool get_message_pool_stats( MessagePoolStats & stats ) const override;
+
+    // False if not built with BUILD_WITH_VIDEO_ENCODER or if FFmpeg has no such encoder
+    static bool is_encoder_available( const std::string & encoder );
+
+private:
+    struct encoder_context;
+    void encode( const sensor_msgs::msg::Image & image );
+    std::unique_ptr< encoder_context > open_encoder( const sensor_msgs::msg::Image & image, std::string & error );
+
+    rclcpp::Logger logger;
+    video_encoder_settings settings;
+    std::shared_ptr< image_publisher > image_publisher_impl;
+    rclcpp::Publisher< sensor_msgs::msg::CompressedImage >::SharedPtr video_publisher_impl;
+    std::mutex encoder_mutex;
+    std::unique_ptr< encoder_context > encoder;
+    std::string failed_image_format;    // the encoder could not be opened for these images
+    bool had_subscribers;
+};
+
+}  // namespace realsense2_camera
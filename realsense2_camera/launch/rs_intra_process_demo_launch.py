@@ -65,6 +65,12 @@ realsense_node_params = [{'name': 'serial_no',              'default': "''", 'de
 
 frame_latency_node_params = [{'name': 'topic_name', 'default': '/camera/color/image_raw', 'description': 'topic to which latency calculated'},
                              {'name': 'topic_type', 'default': 'image', 'description': 'topic type [image|points|imu|metadata|camera_info|rgbd|imu_info|tf]'},
+                             {'name': 'topic_names', 'default': "''", 'description': 'comma separated topics to which latency calculated, instead of topic_name'},
+                             {'name': 'topic_types', 'default': "''", 'description': 'comma separated types of topic_names, or a single type for all of them'},
+                             {'name': 'window_size', 'default': '1000', 'description': 'latest messages per topic the statistics are computed on'},
+                             {'name': 'report_period', 'default': '1.0', 'description': 'seconds between latency reports'},
+                             {'name': 'csv_file', 'default': "''", 'description': 'file the latency reports are also written to'},
+                             {'name': 'log_messages', 'default': 'false', 'description': 'log every message latency'},
                             ]
 
 
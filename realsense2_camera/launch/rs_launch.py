@@ -28,8 +28,13 @@ configurable_parameters = [{'name': 'camera_name',                  'default': '
                            {'name': 'device_type',                  'default': "''", 'description': 'choose device by type'},
                            {'name': 'config_file',                  'default': "''", 'description': 'yaml config file'},
                            {'name': 'json_file_path',               'default': "''", 'description': 'allows advanced configuration'},
+                           {'name': 'options_cache_dir',            'default': "''", 'description': 'directory of the options cache files. Empty=Disabled'},
                            {'name': 'initial_reset',                'default': 'false', 'description': "''"},
+                           {'name': 'initial_reset_stagger',        'default': '2.0', 'description': '[double] minimal seconds between the initial resets of the cameras sharing a context'},
                            {'name': 'rosbag_filename',              'default': "''", 'description': 'A realsense bagfile to run from as a device'},
+                           {'name': 'raw_record_dir',               'default': "''", 'description': 'directory of the raw recordings of the frames. Empty=Disabled'},
+                           {'name': 'raw_record_segment_size',      'default': '256', 'description': 'size (MB) of the segment files of a raw recording'},
+                           {'name': 'raw_playback_dir',             'default': "''", 'description': 'A raw recording to run from as a device'},
                            {'name': 'log_level',                    'default': 'info', 'description': 'debug log level [DEBUG|INFO|WARN|ERROR|FATAL]'},
                            {'name': 'output',                       'default': 'screen', 'description': 'pipe node output [screen|log]'},
                            {'name': 'enable_color',                 'default': 'true', 'description': 'enable color stream'},
@@ -55,22 +60,48 @@ configurable_parameters = [{'name': 'camera_name',                  'default': '
                            {'name': 'depth_module.gain.2',          'default': '16', 'description': 'Depth module second gain value. Used for hdr_merge filter'},
                            {'name': 'enable_sync',                  'default': 'false', 'description': "'enable sync mode'"},
                            {'name': 'enable_rgbd',                  'default': 'false', 'description': "'enable rgbd topic'"},
+                           {'name': 'multi_camera_sync_group',      'default': "''", 'description': 'publish the rgbd messages of the cameras of this group together'},
+                           {'name': 'multi_camera_sync_tolerance',  'default': '0.005', 'description': 'largest stamp difference (seconds) within a multi camera group'},
                            {'name': 'enable_gyro',                  'default': 'false', 'description': "'enable gyro stream'"},
                            {'name': 'enable_accel',                 'default': 'false', 'description': "'enable accel stream'"},
                            {'name': 'gyro_fps',                     'default': '0', 'description': "''"},
                            {'name': 'accel_fps',                    'default': '0', 'description': "''"},
                            {'name': 'unite_imu_method',             'default': "0", 'description': '[0-None, 1-copy, 2-linear_interpolation]'},
+                           {'name': 'imu_batch_size',               'default': '0', 'description': '[int] IMU samples per batch message. 0=Disabled'},
+                           {'name': 'imu_batch_period',             'default': '0.0', 'description': '[double] seconds spanned by a batch message at most. 0=Disabled'},
+                           {'name': 'latency_stats.enable',         'default': 'false', 'description': '[bool] record the latency of each processing stage'},
+                           {'name': 'latency_stats.publish_period', 'default': '1.0', 'description': '[double] seconds between latency_stats messages. 0=Disabled'},
+                           {'name': 'color_video_encoder',          'default': "''", 'description': '[string] FFmpeg encoder of the color video topic, e.g. h264_nvenc. Empty=Disabled'},
+                           {'name': 'depth_video_encoder',          'default': "''", 'description': '[string] FFmpeg encoder of the depth video topic, e.g. ffv1. Empty=Disabled'},
+                           {'name': 'video_encoder.bitrate',        'default': '4000000', 'description': '[int] bits per second of the video topics'},
+                           {'name': 'video_encoder.gop_size',       'default': '30', 'description': '[int] frames between the key frames of the video topics'},
                            {'name': 'clip_distance',                'default': '-2.', 'description': "''"},
                            {'name': 'angular_velocity_cov',         'default': '0.01', 'description': "''"},
                            {'name': 'linear_accel_cov',             'default': '0.01', 'description': "''"},
                            {'name': 'diagnostics_period',           'default': '0.0', 'description': 'Rate of publishing diagnostics. 0=Disabled'},
+                           {'name': 'profile_change_debounce',      'default': '0.1', 'description': '[double] seconds within which profile changes are applied together'},
                            {'name': 'publish_tf',                   'default': 'true', 'description': '[bool] enable/disable publishing static & dynamic TF'},
                            {'name': 'tf_publish_rate',              'default': '0.0', 'description': '[double] rate in Hz for publishing dynamic TF'},
+                           {'name': 'tf_publish_on_change',         'default': 'false', 'description': 'publish dynamic TF only when the transforms change'},
+                           {'name': 'tf_shared_timer',              'default': 'false', 'description': 'publish the dynamic TF of the cameras of a process on a single timer'},
+                           {'name': 'use_loaned_messages',          'default': 'false', 'description': '[bool] publish images and pointcloud using middleware loaned messages'},
+                           {'name': 'enable_pipelining',            'default': 'false', 'description': '[bool] process framesets in pipelined stages on separate threads'},
+                           {'name': 'pipeline_queue_size',          'default': '2', 'description': '[int] framesets waiting for each pipeline stage'},
+                           {'name': 'pipeline_drop_policy',         'default': 'drop_oldest', 'description': '[drop_oldest, drop_newest] frameset dropped when a pipeline stage is full'},
+                           {'name': 'enable_parallel_publish',      'default': 'false', 'description': '[bool] publish the outputs of a frameset in parallel'},
+                           {'name': 'parallel_publish_threads',     'default': '4', 'description': '[int] threads publishing the outputs of a frameset'},
+                           {'name': 'enable_lazy_filters',          'default': 'false', 'description': '[bool] skip filters whose outputs have no subscribers'},
+                           {'name': 'load_latency_budget',          'default': '0.0', 'description': '[double] frameset latency (seconds) above which outputs are decimated. 0=Disabled'},
+                           {'name': 'pointcloud.max_rate',          'default': '0.0', 'description': '[double] largest pointcloud rate (Hz). 0=No limit'},
+                           {'name': 'pointcloud.load_decimation',   'default': '1', 'description': '[int] compute the pointcloud of every Nth frameset while overloaded'},
+                           {'name': 'align_depth.max_rate',         'default': '0.0', 'description': '[double] largest aligned depth rate (Hz). 0=No limit'},
+                           {'name': 'align_depth.load_decimation',  'default': '1', 'description': '[int] compute the aligned depth of every Nth frameset while overloaded'},
                            {'name': 'pointcloud.enable',            'default': 'false', 'description': ''},
                            {'name': 'pointcloud.stream_filter',     'default': '2', 'description': 'texture stream for pointcloud'},
                            {'name': 'pointcloud.stream_index_filter','default': '0', 'description': 'texture stream index for pointcloud'},
                            {'name': 'pointcloud.ordered_pc',        'default': 'false', 'description': ''},
                            {'name': 'pointcloud.allow_no_texture_points', 'default': 'false', 'description': "''"},
+                           {'name': 'pointcloud.num_threads',       'default': '1', 'description': '[int] threads filling the pointcloud message, by row bands'},
                            {'name': 'align_depth.enable',           'default': 'false', 'description': 'enable align depth filter'},
                            {'name': 'colorizer.enable',             'default': 'false', 'description': 'enable colorizer filter'},
                            {'name': 'decimation_filter.enable',     'default': 'false', 'description': 'enable_decimation_filter'},
@@ -81,6 +112,7 @@ configurable_parameters = [{'name': 'camera_name',                  'default': '
                            {'name': 'hdr_merge.enable',             'default': 'false', 'description': 'hdr_merge filter enablement flag'},
                            {'name': 'wait_for_device_timeout',      'default': '-1.', 'description': 'Timeout for waiting for device to connect (Seconds)'},
                            {'name': 'reconnect_timeout',            'default': '6.', 'description': 'Timeout(seconds) between consequtive reconnection attempts'},
+                           {'name': 'hot_reconnect',                'default': 'false', 'description': 'keep the publishers and parameters when the device is disconnected'},
                           ]
 
 def declare_configurable_parameters(parameters):
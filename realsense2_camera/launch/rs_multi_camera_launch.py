@@ -20,11 +20,16 @@
 # For example: to set camera_name for device1 set parameter camera_name1.
 # command line example:
 # ros2 launch realsense2_camera rs_multi_camera_launch.py camera_name1:=D400 device_type2:=l5. device_type1:=d4..
+# With use_container:=true, both cameras are loaded in a single component container and share a librealsense context
+# (shared_context): the devices are discovered once for both, the cameras start concurrently and their initial resets
+# are staggered by initial_reset_stagger seconds. Choose each camera by serial_no or usb_port_id.
 
 """Launch realsense2_camera node."""
 import copy
 from launch import LaunchDescription, LaunchContext
 import launch_ros.actions
+from launch_ros.actions import ComposableNodeContainer
+from launch_ros.descriptions import ComposableNode
 from launch.actions import IncludeLaunchDescription, OpaqueFunction
 from launch.substitutions import LaunchConfiguration, ThisLaunchFileDir
 from launch.launch_description_sources import PythonLaunchDescriptionSource
@@ -37,6 +42,7 @@ local_parameters = [{'name': 'camera_name1', 'default': 'camera1', 'description'
                     {'name': 'camera_name2', 'default': 'camera2', 'description': 'camera2 unique name'},
                     {'name': 'camera_namespace1', 'default': 'camera1', 'description': 'camera1 namespace'},
                     {'name': 'camera_namespace2', 'default': 'camera2', 'description': 'camera2 namespace'},
+                    {'name': 'use_container',     'default': 'false', 'description': 'load both cameras in a single component container'},
                     ]
 
 def set_configurable_parameters(local_params):
@@ -60,6 +66,30 @@ def launch_static_transform_publisher_node(context : LaunchContext):
     )
     return [node]
 
+def launch_cameras(context, params1, params2):
+    if LaunchConfiguration('use_container').perform(context).lower() != 'true':
+        return rs_launch.launch_setup(context, params1, '1') + rs_launch.launch_setup(context, params2, '2')
+    nodes = []
+    for params, param_name_suffix in [(params1, '1'), (params2, '2')]:
+        _config_file = LaunchConfiguration('config_file' + param_name_suffix).perform(context)
+        params_from_file = {} if _config_file == "''" else rs_launch.yaml_to_dict(_config_file)
+        nodes.append(ComposableNode(
+            package='realsense2_camera',
+            namespace=LaunchConfiguration('camera_namespace' + param_name_suffix),
+            name=LaunchConfiguration('camera_name' + param_name_suffix),
+            plugin='realsense2_camera::RealSenseNodeFactory',
+            parameters=[params, params_from_file, {'shared_context': True}]))
+    return [ComposableNodeContainer(
+        name='realsense_container',
+        namespace='',
+        package='rclcpp_components',
+        executable='component_container_mt',
+        composable_node_descriptions=nodes,
+        output=LaunchConfiguration('output1'),
+        arguments=['--ros-args', '--log-level', LaunchConfiguration('log_level1')],
+        emulate_tty=True,
+        )]
+
 def generate_launch_description():
     params1 = duplicate_params(rs_launch.configurable_parameters, '1')
     params2 = duplicate_params(rs_launch.configurable_parameters, '2')
@@ -68,11 +98,8 @@ def generate_launch_description():
         rs_launch.declare_configurable_parameters(params1) +
         rs_launch.declare_configurable_parameters(params2) +
         [
-        OpaqueFunction(function=rs_launch.launch_setup,
-                       kwargs = {'params'           : set_configurable_parameters(params1),
-                                 'param_name_suffix': '1'}),
-        OpaqueFunction(function=rs_launch.launch_setup,
-                       kwargs = {'params'           : set_configurable_parameters(params2),
-                                 'param_name_suffix': '2'}),
+        OpaqueFunction(function=launch_cameras,
+                       kwargs = {'params1' : set_configurable_parameters(params1),
+                                 'params2' : set_configurable_parameters(params2)}),
         OpaqueFunction(function=launch_static_transform_publisher_node)
     ])
@@ -18,7 +18,7 @@ import sys
 import rclpy
 from rclpy.node import Node
 from rclpy import qos
-from realsense2_camera_msgs.msg import Metadata
+from realsense2_camera_msgs.msg import Metadata, MetadataValues
 import json
 
 def metadata_cb(msg):
@@ -27,6 +27,14 @@ def metadata_cb(msg):
     print('header:\nstamp:\n  secs:', msg.header.stamp.sec, '\n  nsecs:',  msg.header.stamp.nanosec)
     print('\n'.join(['%10s:%-10s' % (key, str(value)) for key, value in aa.items()]))
 
+def metadata_values_cb(msg):
+    os.system('clear')
+    print('header:\nstamp:\n  secs:', msg.header.stamp.sec, '\n  nsecs:',  msg.header.stamp.nanosec)
+    print('%10s:%-10s' % ('frame_number', str(msg.frame_number)))
+    print('%10s:%-10s' % ('clock_domain', str(msg.clock_domain)))
+    print('%10s:%-10s' % ('frame_timestamp', str(msg.frame_timestamp)))
+    print('\n'.join(['%10s:%-10s' % (key, str(value)) for key, value in zip(msg.keys, msg.values)]))
+
 def main():
     if len(sys.argv) < 2 or '--help' in sys.argv or '/?' in sys.argv:
         print ('USAGE:')
@@ -36,6 +44,7 @@ def main():
         print('App then prints metadata from messages')
         print('')
         print('Example: echo_metadata.py /camera/depth/metadata')
+        print('Topics ending with metadata_values are printed by metadata key number.')
         print('')
         exit(-1)
 
@@ -44,7 +53,10 @@ def main():
     rclpy.init()
     node = Node('metadata_tester')
 
-    depth_sub = node.create_subscription(Metadata, topic, metadata_cb, qos.qos_profile_sensor_data)
+    if topic.endswith('metadata_values'):
+        depth_sub = node.create_subscription(MetadataValues, topic, metadata_values_cb, qos.qos_profile_sensor_data)
+    else:
+        depth_sub = node.create_subscription(Metadata, topic, metadata_cb, qos.qos_profile_sensor_data)
 
     rclpy.spin(node)
 
@@ -15,6 +15,10 @@
 #include "../include/base_realsense_node.h"
 #include "assert.h"
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <depth_kernels.h>
+#include <task_pool.h>
 #include <mutex>
 #include <rclcpp/clock.hpp>
 #include <fstream>
@@ -28,56 +32,78 @@ using namespace realsense2_camera;
 
 SyncedImuPublisher::SyncedImuPublisher(rclcpp::Publisher<sensor_msgs::msg::Imu>::SharedPtr imu_publisher, 
                                        std::size_t waiting_list_size):
-            _publisher(imu_publisher), _pause_mode(false),
-            _waiting_list_size(waiting_list_size), _is_enabled(false)
+            _publisher(imu_publisher), _pending_messages(waiting_list_size), _is_publishing(false),
+            _messages_count(0), _published_count(0), _release_limit(std::numeric_limits<size_t>::max()),
+            _dropped_count(0), _is_enabled(false)
             {}
 
 SyncedImuPublisher::~SyncedImuPublisher()
 {
-    PublishPendingMessages();
+    _release_limit = std::numeric_limits<size_t>::max();
+    PublishPendingMessages(std::numeric_limits<size_t>::max());
 }
 
-void SyncedImuPublisher::Publish(sensor_msgs::msg::Imu imu_msg)
+bool SyncedImuPublisher::Publish(const sensor_msgs::msg::Imu& imu_msg)
 {
-    std::lock_guard<std::mutex> lock_guard(_mutex);
-    if (_pause_mode)
+    // While paused, the messages wait in the queue until the release limit passes them.
+    if (!_pending_messages.push(imu_msg))
     {
-        if (_pending_messages.size() >= _waiting_list_size)
-        {
-            throw std::runtime_error("SyncedImuPublisher inner list reached maximum size of " + std::to_string(_pending_messages.size()));
-        }
-        _pending_messages.push(imu_msg);
-    }
-    else
-    {
-        _publisher->publish(imu_msg);
+        _dropped_count++;
+        return false;
     }
-    return;
+    _messages_count++;
+    PublishPendingMessages(_release_limit);
+    return true;
+}
+
+bool SyncedImuPublisher::Pause(PausePoints::Id& pause_id)
+{
+    if (!_is_enabled) return false;
+    std::lock_guard<std::mutex> lock_guard(_pause_mutex);
+    pause_id = _pause_points.add(_messages_count);
+    setReleaseLimit();
+    return true;
 }
 
-void SyncedImuPublisher::Pause()
+void SyncedImuPublisher::Resume(PausePoints::Id pause_id)
 {
-    if (!_is_enabled) return;
-    std::lock_guard<std::mutex> lock_guard(_mutex);
-    _pause_mode = true;
+    {
+        std::lock_guard<std::mutex> lock_guard(_pause_mutex);
+        _pause_points.remove(pause_id);
+        // Several frames are processed at once (pipelined mode), and may finish or be dropped in any order:
+        // only release the messages received before the oldest frame still in process started.
+        setReleaseLimit();
+    }
+    PublishPendingMessages(_release_limit);
 }
 
-void SyncedImuPublisher::Resume()
+void SyncedImuPublisher::setReleaseLimit()
 {
-    std::lock_guard<std::mutex> lock_guard(_mutex);
-    PublishPendingMessages();
-    _pause_mode = false;
+    _release_limit = _pause_points.releaseLimit();
 }
 
-void SyncedImuPublisher::PublishPendingMessages()
+void SyncedImuPublisher::PublishPendingMessages(size_t release_limit)
 {
-    while (!_pending_messages.empty())
+    // One thread at a time pops the messages. A thread finding it busy leaves its messages to it:
+    // the publishing thread checks again for messages, or a new release limit, after it is done.
+    // The counters are pushed before taking _is_publishing, and read after releasing it, so none is missed.
+    do
     {
-        const sensor_msgs::msg::Imu &imu_msg = _pending_messages.front();
-        _publisher->publish(imu_msg);
-        _pending_messages.pop();
-    }
+        if (_is_publishing.exchange(true))
+            return;
+        for (sensor_msgs::msg::Imu* imu_msg = _pending_messages.front();
+             imu_msg && _published_count < release_limit;
+             imu_msg = _pending_messages.front())
+        {
+            _publisher->publish(*imu_msg);
+            _pending_messages.pop();
+            _published_count++;
+        }
+        _is_publishing = false;
+        release_limit = _release_limit;
+    } while (_published_count < std::min<size_t>(_messages_count, release_limit));
 }
+
 size_t SyncedImuPublisher::getNumSubscribers()
 { 
     if (!_publisher) return 0;
@@ -94,6 +120,8 @@ BaseRealSenseNode::BaseRealSenseNode(rclcpp::Node& node,
     _parameters(parameters),
     _dev(dev),
     _json_file_path(""),
+    _raw_record_segment_size(RAW_RECORD_SEGMENT_SIZE),
+    _raw_recordings_count(0),
     _depth_scale_meters(0),
     _clipping_distance(0),
     _linear_accel_cov(0),
@@ -101,10 +129,19 @@ BaseRealSenseNode::BaseRealSenseNode(rclcpp::Node& node,
     _hold_back_imu_for_frames(false),
     _publish_tf(false),
     _tf_publish_rate(TF_PUBLISH_RATE),
+    _static_tf_msgs_version(0),
+    _sent_tf_msgs_version(0),
+    _tf_publish_on_change(TF_PUBLISH_ON_CHANGE),
+    _tf_shared_timer(TF_SHARED_TIMER),
+    _tf_hub_client_id(0),
     _diagnostics_period(0),
     _use_intra_process(use_intra_process),
+    _use_loaned_messages(USE_LOANED_MESSAGES),
+    _can_loan_image_messages(-1),
+    _imu_batch_size(IMU_BATCH_SIZE),
+    _imu_batch_period(IMU_BATCH_PERIOD),
+    _is_camera_info_decimated(false),
     _is_initialized_time_base(false),
-    _camera_time_base(0),
     _sync_frames(SYNC_FRAMES),
     _enable_rgbd(ENABLE_RGBD),
     _is_color_enabled(false),
@@ -114,14 +151,27 @@ BaseRealSenseNode::BaseRealSenseNode(rclcpp::Node& node,
     _pointcloud(false),
     _imu_sync_method(imu_sync_method::NONE),
     _is_profile_changed(false),
-    _is_align_depth_changed(false)
+    _profile_change_debounce(PROFILE_CHANGE_DEBOUNCE),
+    _is_align_depth_changed(false),
+    _enable_pipelining(ENABLE_PIPELINING),
+    _pipeline_queue_size(PIPELINE_QUEUE_SIZE),
+    _pipeline_drop_policy(PIPELINE_DROP_POLICY),
+    _pipeline_split_filter(0),
+    _enable_parallel_publish(ENABLE_PARALLEL_PUBLISH),
+    _parallel_publish_threads(PARALLEL_PUBLISH_THREADS),
+    _enable_lazy_filters(ENABLE_LAZY_FILTERS),
+    _filters_demand(ALL_OUTPUTS),
+    _is_filters_demand_stale(true),
+    _enable_latency_stats(ENABLE_LATENCY_STATS),
+    _latency_stats_publish_period(LATENCY_STATS_PUBLISH_PERIOD),
+    _frameset_callback_latency(_latency_stats.getHistogram("callback", "frameset")),
+    _pointcloud_publish_latency(_latency_stats.getHistogram("publish", "pointcloud"))
 {
     if ( use_intra_process )
     {
         ROS_INFO("Intra-Process communication enabled");
     }
 
-    initializeFormatsMaps();
     _monitor_options = {RS2_OPTION_ASIC_TEMPERATURE, RS2_OPTION_PROJECTOR_TEMPERATURE};
 }
 
@@ -129,6 +179,10 @@ BaseRealSenseNode::~BaseRealSenseNode()
 {
     // Kill dynamic transform thread
     _is_running = false;
+    if (_tf_hub)
+        _tf_hub->removeClient(_tf_hub_client_id);
+    if (_multi_camera_syncer)
+        _multi_camera_syncer->removeMember(_camera_name);
     _cv_tf.notify_one();
     if (_tf_t && _tf_t->joinable())
         _tf_t->join();
@@ -143,11 +197,25 @@ BaseRealSenseNode::~BaseRealSenseNode()
     {
         _monitoring_pc->join();
     }
+    if (_monitoring_graph && _monitoring_graph->joinable())
+    {
+        _monitoring_graph->join();
+    }
+    _cv_latency.notify_one();
+    if (_monitoring_latency && _monitoring_latency->joinable())
+    {
+        _monitoring_latency->join();
+    }
+    if (_options_cache_validation && _options_cache_validation->joinable())
+    {
+        _options_cache_validation->join();
+    }
     clearParameters();
     for(auto&& sensor : _available_ros_sensors)
     {
         sensor->stop();
     }
+    flushPipeline();
 }
 
 void BaseRealSenseNode::hardwareResetRequest()
@@ -163,50 +231,58 @@ void BaseRealSenseNode::publishTopics()
     ROS_INFO_STREAM("RealSense Node Is Up!");
 }
 
-void BaseRealSenseNode::initializeFormatsMaps()
+void BaseRealSenseNode::reconnect(rs2::device dev)
 {
-    // from rs2_format to OpenCV format
-    // https://docs.opencv.org/3.4/d1/d1b/group__core__hal__interface.html
-    // https://docs.opencv.org/2.4/modules/core/doc/basic_structures.html
-    // CV_<bit-depth>{U|S|F}C(<number_of_channels>)
-    // where U is unsigned integer type, S is signed integer type, and F is float type.
-    // For example, CV_8UC1 means a 8-bit single-channel array,
-    // CV_32FC2 means a 2-channel (complex) floating-point array, and so on.
-    _rs_format_to_cv_format[RS2_FORMAT_Y8] = CV_8UC1;
-    _rs_format_to_cv_format[RS2_FORMAT_Y16] = CV_16UC1;
-    _rs_format_to_cv_format[RS2_FORMAT_Z16] = CV_16UC1;
-    _rs_format_to_cv_format[RS2_FORMAT_RGB8] = CV_8UC3;
-    _rs_format_to_cv_format[RS2_FORMAT_BGR8] = CV_8UC3;
-    _rs_format_to_cv_format[RS2_FORMAT_RGBA8] = CV_8UC4;
-    _rs_format_to_cv_format[RS2_FORMAT_BGRA8] = CV_8UC4;
-    _rs_format_to_cv_format[RS2_FORMAT_YUYV] = CV_8UC2;
-    _rs_format_to_cv_format[RS2_FORMAT_UYVY] = CV_8UC2;
-    // _rs_format_to_cv_format[RS2_FORMAT_M420] = not supported yet in ROS2
-    _rs_format_to_cv_format[RS2_FORMAT_RAW8] = CV_8UC1;
-    _rs_format_to_cv_format[RS2_FORMAT_RAW10] = CV_16UC1;
-    _rs_format_to_cv_format[RS2_FORMAT_RAW16] = CV_16UC1;
-
-    // from rs2_format to ROS2 image msg encoding (format)
-    // http://docs.ros.org/en/noetic/api/sensor_msgs/html/msg/Image.html
-    // http://docs.ros.org/en/jade/api/sensor_msgs/html/image__encodings_8h_source.html
-    _rs_format_to_ros_format[RS2_FORMAT_Y8] = sensor_msgs::image_encodings::MONO8;
-    _rs_format_to_ros_format[RS2_FORMAT_Y16] = sensor_msgs::image_encodings::MONO16;
-    _rs_format_to_ros_format[RS2_FORMAT_Z16] = sensor_msgs::image_encodings::TYPE_16UC1;
-    _rs_format_to_ros_format[RS2_FORMAT_RGB8] = sensor_msgs::image_encodings::RGB8;
-    _rs_format_to_ros_format[RS2_FORMAT_BGR8] = sensor_msgs::image_encodings::BGR8;
-    _rs_format_to_ros_format[RS2_FORMAT_RGBA8] = sensor_msgs::image_encodings::RGBA8;
-    _rs_format_to_ros_format[RS2_FORMAT_BGRA8] = sensor_msgs::image_encodings::BGRA8;
-    _rs_format_to_ros_format[RS2_FORMAT_YUYV] = sensor_msgs::image_encodings::YUV422_YUY2;
-    _rs_format_to_ros_format[RS2_FORMAT_UYVY] = sensor_msgs::image_encodings::YUV422;
-    // _rs_format_to_ros_format[RS2_FORMAT_M420] =  not supported yet in ROS2
-    _rs_format_to_ros_format[RS2_FORMAT_RAW8] = sensor_msgs::image_encodings::TYPE_8UC1;
-    _rs_format_to_ros_format[RS2_FORMAT_RAW10] = sensor_msgs::image_encodings::TYPE_16UC1;
-    _rs_format_to_ros_format[RS2_FORMAT_RAW16] = sensor_msgs::image_encodings::TYPE_16UC1;
+    ROS_INFO_STREAM("Reconnecting to device " << dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER) << "...");
+    if (_options_cache_validation && _options_cache_validation->joinable())
+    {
+        _options_cache_validation->join();
+    }
+
+    // The parameters are declared again with the sensors: their values, including the ones set at runtime, are restored from here.
+    std::vector<rclcpp::Parameter> saved_parameters(_node.get_parameters(_node.list_parameters({}, 0).names));
+    {
+        std::lock_guard<std::mutex> lock_guard(_update_sensor_mutex);
+        _kept_profiles.clear();
+        for(auto&& sensor : _available_ros_sensors)
+        {
+            for (auto& profile : sensor->get_active_streams())
+                _kept_profiles.push_back(profile);
+            sensor->stop();
+        }
+        flushPipeline();
+        _available_ros_sensors.clear();
+        if (_publish_tf)
+        {
+            // The transforms are calculated again from the calibration of the reconnected device
+            for (auto& profile : _kept_profiles)
+                eraseTransformMsgs(stream_index_pair(profile.stream_type(), profile.stream_index()), profile);
+        }
+
+        _dev = dev;
+        _is_initialized_time_base = false;
+        setAvailableSensors();
+        SetBaseStream();
+    }
+
+    // The options are written before the sensors are started again: some can only be set while not streaming.
+    _parameters->restoreParamValues(saved_parameters);
+    updateSensors();
+
+    // The streams that were not started again lose their publishers now
+    {
+        std::lock_guard<std::mutex> lock_guard(_update_sensor_mutex);
+        stopPublishers(_kept_profiles);
+        _kept_profiles.clear();
+    }
+    validateOptionsCache();
+    ROS_INFO_STREAM("RealSense Node Is Reconnected!");
 }
 
 void BaseRealSenseNode::setupFilters()
 {
-    _filters.push_back(std::make_shared<NamedFilter>(std::make_shared<rs2::decimation_filter>(), _parameters, _logger));
+    _decimation_filter = std::make_shared<NamedFilter>(std::make_shared<rs2::decimation_filter>(), _parameters, _logger);
+    _filters.push_back(_decimation_filter);
     _filters.push_back(std::make_shared<NamedFilter>(std::make_shared<rs2::hdr_merge>(), _parameters, _logger));
     _filters.push_back(std::make_shared<NamedFilter>(std::make_shared<rs2::sequence_id_filter>(), _parameters, _logger));
     _filters.push_back(std::make_shared<NamedFilter>(std::make_shared<rs2::disparity_transform>(), _parameters, _logger));
@@ -229,60 +305,88 @@ void BaseRealSenseNode::setupFilters()
         _cv_mpc.notify_one();
     };
 
+    // The pipelined mode runs the filters from the colorizer on in a separate stage.
+    _pipeline_split_filter = _filters.size();
     _colorizer_filter = std::make_shared<NamedFilter>(std::make_shared<rs2::colorizer>(), _parameters, _logger); 
     _filters.push_back(_colorizer_filter);
 
-    _pc_filter = std::make_shared<PointcloudFilter>(std::make_shared<rs2::pointcloud>(), _node, _parameters, _logger);
+    _pc_filter = std::make_shared<PointcloudFilter>(std::make_shared<rs2::pointcloud>(), _node, _parameters, _logger, false, _use_loaned_messages && !_use_intra_process);
     _filters.push_back(_pc_filter);
 
     _align_depth_filter = std::make_shared<AlignDepthFilter>(std::make_shared<rs2::align>(RS2_STREAM_COLOR), update_align_depth_func, _parameters, _logger);
     _filters.push_back(_align_depth_filter);
+
+    // The topics depending on each filter. The filters before the colorizer process depth and infrared frames.
+    for (auto& filter : _filters)
+    {
+        unsigned int outputs(DEPTH_STREAMS_OUTPUT | DEPTH_OUTPUT | POINTCLOUD_OUTPUT | ALIGNED_DEPTH_OUTPUT);
+        if (filter == _colorizer_filter)
+            outputs = DEPTH_OUTPUT | POINTCLOUD_OUTPUT | ALIGNED_DEPTH_OUTPUT;
+        else if (filter == _pc_filter)
+            outputs = POINTCLOUD_OUTPUT;
+        else if (filter == _align_depth_filter)
+            outputs = ALIGNED_DEPTH_OUTPUT;
+        _filters_outputs.push_back(outputs);
+        std::string filter_name = create_graph_resource_name(rs2_to_ros(filter->_filter->get_info(RS2_CAMERA_INFO_NAME)));
+        _filters_latency.push_back(_latency_stats.getHistogram(filter_name, "frameset"));
+    }
+    checkProcessingBackend();
 }
 
-cv::Mat& BaseRealSenseNode::fix_depth_scale(const cv::Mat& from_image, cv::Mat& to_image)
+void BaseRealSenseNode::checkProcessingBackend()
 {
-    static const float meter_to_mm = 0.001f;
-    if (fabs(_depth_scale_meters - meter_to_mm) < 1e-6)
+    // librealsense runs align and pointcloud on CUDA when it is built with BUILD_WITH_CUDA, keeping the frames on the GPU
+    // within each of them. There is no runtime switch: this checks that the backend is the requested one.
+    const std::string align_name(_align_depth_filter->_filter->get_info(RS2_CAMERA_INFO_NAME));
+    const std::string pointcloud_name(_pc_filter->_filter->get_info(RS2_CAMERA_INFO_NAME));
+    const std::string cuda_suffix("(CUDA)");
+    bool is_cuda = (align_name.find(cuda_suffix) != std::string::npos) && (pointcloud_name.find(cuda_suffix) != std::string::npos);
+    ROS_INFO_STREAM("Processing backend: " << align_name << ", " << pointcloud_name);
+    if (_processing_backend == "cuda" && !is_cuda)
     {
-        to_image = from_image;
-        return to_image;
+        ROS_ERROR_STREAM("processing_backend is cuda, but librealsense was built without BUILD_WITH_CUDA: align and pointcloud run on the CPU. "
+                         "Rebuild librealsense with -DBUILD_WITH_CUDA=ON or set processing_backend to auto");
     }
-
-    if (to_image.size() != from_image.size())
+    else if (_processing_backend != "cuda" && _processing_backend != "auto")
     {
-        to_image.create(from_image.rows, from_image.cols, from_image.type());
+        ROS_WARN_STREAM("Unknown processing_backend: " << _processing_backend << ". Using auto");
     }
+}
 
-    CV_Assert(CV_MAKETYPE(from_image.depth(),from_image.channels()) == _rs_format_to_cv_format[RS2_FORMAT_Z16]);
-
-    int nRows = from_image.rows;
-    int nCols = from_image.cols;
-
-    if (from_image.isContinuous())
+void BaseRealSenseNode::fix_depth_scale(const uint16_t* from_data, uint16_t* to_data, size_t count, float clipping_dist)
+{
+    // Scaling and clipping are done in a single pass over the buffer, using the CPU's vector instructions.
+    static const float meter_to_mm = 0.001f;
+    const DepthKernels& kernels = getDepthKernels();
+    bool is_mm_scale = fabs(_depth_scale_meters - meter_to_mm) < 1e-6;
+    if (clipping_dist > 0)
     {
-        nCols *= nRows;
-        nRows = 1;
+        uint16_t clipping_value = getClippingValue(clipping_dist);
+        if (is_mm_scale)
+            kernels.clip(from_data, to_data, count, clipping_value);
+        else
+            kernels.scale_and_clip(from_data, to_data, count, _depth_scale_meters, clipping_value);
     }
-
-    int i,j;
-    const uint16_t* p_from;
-    uint16_t* p_to;
-    for( i = 0; i < nRows; ++i)
+    else if (is_mm_scale)
     {
-        p_from = from_image.ptr<uint16_t>(i);
-        p_to = to_image.ptr<uint16_t>(i);
-        for ( j = 0; j < nCols; ++j)
-        {
-            p_to[j] = p_from[j] * _depth_scale_meters / meter_to_mm;
-        }
+        memcpy(to_data, from_data, count * sizeof(uint16_t));
+    }
+    else
+    {
+        kernels.scale(from_data, to_data, count, _depth_scale_meters);
     }
-    return to_image;
+}
+
+uint16_t BaseRealSenseNode::getClippingValue(float clipping_dist) const
+{
+    return static_cast<uint16_t>(clipping_dist / _depth_scale_meters);
 }
 
 void BaseRealSenseNode::clip_depth(rs2::depth_frame depth_frame, float clipping_dist)
 {
     uint16_t* p_depth_frame = reinterpret_cast<uint16_t*>(const_cast<void*>(depth_frame.get_data()));
-    uint16_t clipping_value = static_cast<uint16_t>(clipping_dist / _depth_scale_meters);
+    uint16_t clipping_value = getClippingValue(clipping_dist);
+    const DepthKernels& kernels = getDepthKernels();
 
     int width = depth_frame.get_width();
     int height = depth_frame.get_height();
@@ -292,15 +396,9 @@ void BaseRealSenseNode::clip_depth(rs2::depth_frame depth_frame, float clipping_
     #endif
     for (int y = 0; y < height; y++)
     {
-        auto depth_pixel_index = y * width;
-        for (int x = 0; x < width; x++, ++depth_pixel_index)
-        {
-            // Check if the depth value is greater than the threashold
-            if (p_depth_frame[depth_pixel_index] > clipping_value)
-            {
-                p_depth_frame[depth_pixel_index] = 0; //Set to invalid (<=0) value.
-            }
-        }
+        // Set depth values greater than the threshold to invalid (0) value.
+        uint16_t* row = p_depth_frame + y * width;
+        kernels.clip(row, row, width, clipping_value);
     }
 }
 
@@ -326,7 +424,6 @@ template <typename T> T lerp(const T &a, const T &b, const double t) {
 
 void BaseRealSenseNode::FillImuData_LinearInterpolation(const CimuData imu_data, std::deque<sensor_msgs::msg::Imu>& imu_msgs)
 {
-    static std::deque<CimuData> _imu_history;
     _imu_history.push_back(imu_data);
     stream_index_pair type(imu_data.m_type);
     imu_msgs.clear();
@@ -373,7 +470,6 @@ void BaseRealSenseNode::FillImuData_Copy(const CimuData imu_data, std::deque<sen
 {
     stream_index_pair type(imu_data.m_type);
 
-    static CimuData _accel_data(ACCEL, {0,0,0}, -1.0);
     if (ACCEL == type)
     {
         _accel_data = imu_data;
@@ -387,7 +483,7 @@ void BaseRealSenseNode::FillImuData_Copy(const CimuData imu_data, std::deque<sen
 
 void BaseRealSenseNode::ImuMessage_AddDefaultValues(sensor_msgs::msg::Imu& imu_msg)
 {
-    imu_msg.header.frame_id = IMU_OPTICAL_FRAME_ID;
+    imu_msg.header.frame_id = _imu_optical_frame_id;
     imu_msg.orientation.x = 0.0;
     imu_msg.orientation.y = 0.0;
     imu_msg.orientation.z = 0.0;
@@ -400,9 +496,9 @@ void BaseRealSenseNode::ImuMessage_AddDefaultValues(sensor_msgs::msg::Imu& imu_m
 
 void BaseRealSenseNode::imu_callback_sync(rs2::frame frame, imu_sync_method sync_method)
 {
-    static std::mutex m_mutex;
-
-    m_mutex.lock();
+    // The sync state is shared by the gyro and accel callbacks. They hardly ever contend on the lock,
+    // as both streams come from the motion sensor, and the frame threads never take it.
+    std::lock_guard<std::mutex> lock_guard(_imu_sync_mutex);
 
     auto stream = frame.get_profile().stream_type();
     auto stream_index = (stream == GYRO.first)?GYRO:ACCEL;
@@ -414,7 +510,9 @@ void BaseRealSenseNode::imu_callback_sync(rs2::frame frame, imu_sync_method sync
         _is_initialized_time_base = setBaseTime(frame_time, frame.get_frame_timestamp_domain());
     }
 
-    if (_synced_imu_publisher && (0 != _synced_imu_publisher->getNumSubscribers()))
+    bool is_publish_synced = _synced_imu_publisher && (0 != _synced_imu_publisher->getNumSubscribers());
+    bool is_publish_batch = _synced_imu_batcher && (0 != _synced_imu_batcher->getNumSubscribers());
+    if (is_publish_synced || is_publish_batch)
     {
         auto crnt_reading = *(reinterpret_cast<const float3*>(frame.get_data()));
         Eigen::Vector3d v(crnt_reading.x, crnt_reading.y, crnt_reading.z);
@@ -436,12 +534,18 @@ void BaseRealSenseNode::imu_callback_sync(rs2::frame frame, imu_sync_method sync
         {
             sensor_msgs::msg::Imu imu_msg = imu_msgs.front();
             ImuMessage_AddDefaultValues(imu_msg);
-            _synced_imu_publisher->Publish(imu_msg);
-            ROS_DEBUG("Publish united %s stream", rs2_stream_to_string(frame.get_profile().stream_type()));
+            if (is_publish_batch)
+                _synced_imu_batcher->add(imu_msg);
+            if (is_publish_synced)
+            {
+                if (_synced_imu_publisher->Publish(imu_msg))
+                    ROS_DEBUG("Publish united %s stream", rs2_stream_to_string(frame.get_profile().stream_type()));
+                else
+                    ROS_WARN_STREAM_COND(_synced_imu_publisher->getDroppedCount() % 100 == 1, "Synced IMU queue is full. Messages dropped so far: " << _synced_imu_publisher->getDroppedCount());
+            }
             imu_msgs.pop_front();
          }
     }
-    m_mutex.unlock();
 }
 
 void BaseRealSenseNode::imu_callback(rs2::frame frame)
@@ -468,11 +572,14 @@ void BaseRealSenseNode::imu_callback(rs2::frame frame)
         return;
     }
 
-    if (0 != _imu_publishers[stream_index]->get_subscription_count())
+    auto batcher_itr = _imu_batchers.find(stream_index);
+    bool is_publish_batch = (batcher_itr != _imu_batchers.end()) && (0 != batcher_itr->second->getNumSubscribers());
+    bool is_publish_sample = (0 != _imu_publishers[stream_index]->get_subscription_count());
+    if (is_publish_sample || is_publish_batch)
     {
         auto imu_msg = sensor_msgs::msg::Imu();
         ImuMessage_AddDefaultValues(imu_msg);
-        imu_msg.header.frame_id = OPTICAL_FRAME_ID(stream_index);
+        imu_msg.header.frame_id = opticalFrameId(stream_index);
 
         auto crnt_reading = *(reinterpret_cast<const float3*>(frame.get_data()));
         if (GYRO == stream_index)
@@ -488,17 +595,21 @@ void BaseRealSenseNode::imu_callback(rs2::frame frame)
             imu_msg.linear_acceleration.z = crnt_reading.z;
         }
         imu_msg.header.stamp = t;
-        _imu_publishers[stream_index]->publish(imu_msg);
-        ROS_DEBUG("Publish %s stream", ros_stream_to_string(frame.get_profile().stream_type()).c_str());
+        if (is_publish_batch)
+            batcher_itr->second->add(imu_msg);
+        if (is_publish_sample)
+        {
+            _imu_publishers[stream_index]->publish(imu_msg);
+            ROS_DEBUG("Publish %s stream", ros_stream_to_string(frame.get_profile().stream_type()).c_str());
+        }
     }
-    publishMetadata(frame, t, OPTICAL_FRAME_ID(stream_index));
+    publishMetadata(frame, t, opticalFrameId(stream_index));
 }
 
 
 void BaseRealSenseNode::frame_callback(rs2::frame frame)
 {
-    if (_synced_imu_publisher)
-        _synced_imu_publisher->Pause();
+    auto imu_pause = std::make_shared<ImuPauseToken>(_synced_imu_publisher);
     double frame_time = frame.get_timestamp();
 
     // We compute a ROS timestamp which is based on an initial ROS time at point of first frame,
@@ -511,6 +622,16 @@ void BaseRealSenseNode::frame_callback(rs2::frame frame)
     }
 
     rclcpp::Time t(frameSystemTimeSec(frame));
+    // Latencies are measured from here, at the steady clock, to the end of each stage.
+    // The latency before the callback is measured from the frame arrival, see arrivalLatency(): it is recorded,
+    // and it is the load signal of the output throttle.
+    const bool is_throttle_enabled(_output_throttle.isEnabled());
+    int64_t callback_time_ns(0);
+    int64_t callback_latency_ns(-1);
+    if (_enable_latency_stats)
+        callback_time_ns = LatencyStats::now();
+    if (_enable_latency_stats || is_throttle_enabled)
+        callback_latency_ns = arrivalLatency(frame);
     if (frame.is<rs2::frameset>())
     {
         ROS_DEBUG("Frameset arrived.");
@@ -527,94 +648,341 @@ void BaseRealSenseNode::frame_callback(rs2::frame frame)
             ROS_DEBUG("Frameset contain (%s, %d, %s %d) frame. frame_number: %llu ; frame_TS: %f ; ros_TS(NSec): %lu",
                         rs2_stream_to_string(stream_type), stream_index, rs2_format_to_string(stream_format), stream_unique_id, frame.get_frame_number(), frame_time, t.nanoseconds());
         }
+
+        auto job = std::make_shared<FramesetJob>();
+        job->frameset = frameset;
+        job->t = t;
+        job->frame_time = frame_time;
+        job->imu_pause = imu_pause;
         // Clip depth_frame for max range:
-        rs2::depth_frame original_depth_frame = frameset.get_depth_frame();
-        if (original_depth_frame && _clipping_distance > 0)
+        // In place before the first enabled filter, so that filters only see clipped depth.
+        // With no filter enabled the frame is clipped while it is copied into the published message instead.
+        job->original_depth_frame = frameset.get_depth_frame();
+        job->is_depth_clipping_pending = (job->original_depth_frame && _clipping_distance > 0);
+        job->original_color_frame = frameset.get_color_frame();
+        job->filters_demand = getFiltersDemand();
+        // Decided here, before the filters run
+        if (is_throttle_enabled)
+            job->filters_demand = _output_throttle.filter(job->filters_demand, t.nanoseconds(), callback_latency_ns);
+        job->callback_time_ns = callback_time_ns;
+        if (_enable_latency_stats && callback_latency_ns >= 0)
+            _frameset_callback_latency->record(callback_latency_ns);
+
+        if (_enable_pipelining)
+        {
+            // Each stage hands the frameset over to the next one and is free for the next frameset.
+            pushPipelineJob(FILTERS_STAGE, [this, job]()
+            {
+                processFrameset(*job, 0, _pipeline_split_filter);
+                pushPipelineJob(PROCESSING_STAGE, [this, job]()
+                {
+                    processFrameset(*job, _pipeline_split_filter, _filters.size());
+                    pushPipelineJob(PUBLISHING_STAGE, [this, job]()
+                    {
+                        publishFrameset(*job);
+                    });
+                });
+            });
+        }
+        else
+        {
+            processFrameset(*job, 0, _filters.size());
+            publishFrameset(*job);
+        }
+    }
+    else if (frame.is<rs2::video_frame>())
+    {
+        auto stream_type = frame.get_profile().stream_type();
+        auto stream_index = frame.get_profile().stream_index();
+        ROS_DEBUG("Single video frame arrived (%s, %d). frame_number: %llu ; frame_TS: %f ; ros_TS(NSec): %lu",
+                    rs2_stream_to_string(stream_type), stream_index, frame.get_frame_number(), frame_time, t.nanoseconds());
+        if (_enable_latency_stats && callback_latency_ns >= 0)
         {
-            clip_depth(original_depth_frame, _clipping_distance);
+            LatencyHistogram* stream_callback_latency = _stream_descriptors[streamSlot(stream_index_pair(stream_type, stream_index))].output.latency.callback;
+            if (stream_callback_latency)
+                stream_callback_latency->record(callback_latency_ns);
         }
 
-        rs2::video_frame original_color_frame = frameset.get_color_frame();
+        if (_enable_pipelining)
+        {
+            // imu_pause is kept by the job, to hold back the IMU messages until the frame is published.
+            pushPipelineJob(PUBLISHING_STAGE, [this, frame, t, imu_pause, callback_time_ns]()
+            {
+                publishVideoFrame(frame, t, callback_time_ns);
+            });
+        }
+        else
+        {
+            publishVideoFrame(frame, t, callback_time_ns);
+        }
+    }
+} // frame_callback
 
-        ROS_DEBUG("num_filters: %d", static_cast<int>(_filters.size()));
-        for (auto filter_it : _filters)
+void BaseRealSenseNode::processFrameset(FramesetJob& job, size_t first_filter, size_t last_filter)
+{
+    ROS_DEBUG("num_filters: %d", static_cast<int>(last_filter - first_filter));
+    for (size_t i = first_filter; i < last_filter; ++i)
+    {
+        auto& filter = _filters[i];
+        // Filters nobody listens to are skipped, like the disabled ones.
+        if (!filter->is_enabled() || !(job.filters_demand & _filters_outputs[i]))
+            continue;
+        if (job.is_depth_clipping_pending)
         {
-            frameset = filter_it->Process(frameset);
+            clip_depth(job.original_depth_frame, _clipping_distance);
+            job.is_depth_clipping_pending = false;
         }
+        job.frameset = filter->Process(job.frameset);
+        recordLatency(_filters_latency[i], job.callback_time_ns);
+        if (filter == _align_depth_filter)
+            job.is_align_depth_applied = true;
+        else if (filter == _decimation_filter)
+            job.is_decimation_applied = true;
+    }
 
-        ROS_DEBUG("List of frameset after applying filters: size: %d", static_cast<int>(frameset.size()));
-        bool sent_depth_frame(false);
-        for (auto it = frameset.begin(); it != frameset.end(); ++it)
+    if (last_filter == _filters.size() && job.original_depth_frame && _align_depth_filter->is_enabled())
+    {
+        if (_colorizer_filter->is_enabled() && (job.filters_demand & DEPTH_OUTPUT))
         {
-            auto f = (*it);
-            auto stream_type = f.get_profile().stream_type();
-            auto stream_index = f.get_profile().stream_index();
-            auto stream_format = f.get_profile().format();
-            stream_index_pair sip{stream_type,stream_index};
+            if (job.is_depth_clipping_pending)
+            {
+                clip_depth(job.original_depth_frame, _clipping_distance);
+                job.is_depth_clipping_pending = false;
+            }
+            job.depth_frame_to_send = _colorizer_filter->Process(job.original_depth_frame);
+        }
+        else
+            job.depth_frame_to_send = job.original_depth_frame;
+    }
+}
 
-            ROS_DEBUG("Frameset contain (%s, %d, %s) frame. frame_number: %llu ; frame_TS: %f ; ros_TS(NSec): %lu", 
-                rs2_stream_to_string(stream_type), stream_index, rs2_format_to_string(stream_format), f.get_frame_number(), frame_time, t.nanoseconds());
-            if (f.is<rs2::video_frame>())
-                ROS_DEBUG_STREAM("frame: " << f.as<rs2::video_frame>().get_width() << " x " << f.as<rs2::video_frame>().get_height());
+void BaseRealSenseNode::publishFrameset(FramesetJob& job)
+{
+    const rclcpp::Time t = job.t;
+    const rs2::frameset& frameset = job.frameset;
+    const int64_t callback_time_ns = job.callback_time_ns;
+    ROS_DEBUG("List of frameset after applying filters: size: %d", static_cast<int>(frameset.size()));
+    // The outputs of a frameset don't depend on each other: they are gathered first,
+    // then published one after the other or in parallel (enable_parallel_publish).
+    std::vector<TaskPool::Task> tasks;
+    // The camera info of a stream is set for its profile: it follows the frames size while they are decimated,
+    // and is set back on the first frameset after.
+    const bool is_resized(_is_camera_info_decimated.exchange(job.is_decimation_applied) || job.is_decimation_applied);
+    bool sent_depth_frame(false);
+    rs2::video_frame color_frame(rs2::frame{});
+    rs2::video_frame aligned_depth_frame(rs2::frame{});
+    for (auto it = frameset.begin(); it != frameset.end(); ++it)
+    {
+        auto f = (*it);
+        auto stream_type = f.get_profile().stream_type();
+        auto stream_index = f.get_profile().stream_index();
+        auto stream_format = f.get_profile().format();
+        stream_index_pair sip{stream_type,stream_index};
+
+        ROS_DEBUG("Frameset contain (%s, %d, %s) frame. frame_number: %llu ; frame_TS: %f ; ros_TS(NSec): %lu", 
+            rs2_stream_to_string(stream_type), stream_index, rs2_format_to_string(stream_format), f.get_frame_number(), job.frame_time, t.nanoseconds());
+        if (f.is<rs2::video_frame>())
+            ROS_DEBUG_STREAM("frame: " << f.as<rs2::video_frame>().get_width() << " x " << f.as<rs2::video_frame>().get_height());
 
-            if (f.is<rs2::points>())
+        if (f.is<rs2::points>())
+        {
+            tasks.push_back([this, f, t, &frameset, callback_time_ns]()
             {
                 publishPointCloud(f.as<rs2::points>(), t, frameset);
-            }
-            else
+                if (callback_time_ns && _pc_filter->getSubscriptionCount() > 0)
+                    recordLatency(_pointcloud_publish_latency, callback_time_ns);
+            });
+        }
+        else
+        {
+            if (stream_type == RS2_STREAM_DEPTH)
             {
-                if (stream_type == RS2_STREAM_DEPTH)
+                if (sent_depth_frame) continue;
+                sent_depth_frame = true;
+                if (job.original_color_frame && _align_depth_filter->is_enabled())
                 {
-                    if (sent_depth_frame) continue;
-                    sent_depth_frame = true;
-                    if (original_color_frame && _align_depth_filter->is_enabled())
+                    // Not aligned if align_depth was skipped: the original depth is sent below.
+                    if (!job.is_align_depth_applied) continue;
+                    aligned_depth_frame = f;
+                    tasks.push_back([this, f, t, callback_time_ns, is_resized]()
                     {
-                        publishFrame(f, t, COLOR, _depth_aligned_image, _depth_aligned_info_publisher, _depth_aligned_image_publishers, false);
-                        continue;
-                    }
+                        publishFrame(f, t, COLOR, _stream_descriptors[streamSlot(COLOR)].aligned_depth_output,
+                                     false, 0, callback_time_ns, is_resized);
+                    });
+                    continue;
                 }
-                publishFrame(f, t, sip, _images, _info_publishers, _image_publishers);
             }
+            else if (sip == COLOR)
+            {
+                color_frame = f;
+            }
+            float depth_clipping_dist = (stream_type == RS2_STREAM_DEPTH && job.is_depth_clipping_pending) ? _clipping_distance : 0;
+            tasks.push_back([this, f, t, sip, depth_clipping_dist, callback_time_ns, is_resized]()
+            {
+                publishFrame(f, t, sip, _stream_descriptors[streamSlot(sip)].output, false, depth_clipping_dist, callback_time_ns, is_resized);
+            });
+            tasks.push_back([this, f, t, sip]() { publishMetadata(f, t, opticalFrameId(sip)); });
         }
-        if (original_depth_frame && _align_depth_filter->is_enabled())
+    }
+    if (job.depth_frame_to_send)
+    {
+        rs2::frame depth_frame_to_send = job.depth_frame_to_send;
+        // Still pending if all the filters were skipped.
+        float depth_clipping_dist = job.is_depth_clipping_pending ? _clipping_distance : 0;
+        tasks.push_back([this, depth_frame_to_send, t, depth_clipping_dist, callback_time_ns, is_resized]()
         {
-            rs2::frame frame_to_send;
-            if (_colorizer_filter->is_enabled())
-                frame_to_send = _colorizer_filter->Process(original_depth_frame);
-            else
-                frame_to_send = original_depth_frame;
-            publishFrame(frame_to_send, t, DEPTH, _images, _info_publishers, _image_publishers);
+            publishFrame(depth_frame_to_send, t, DEPTH, _stream_descriptors[streamSlot(DEPTH)].output, false, depth_clipping_dist, callback_time_ns, is_resized);
+        });
+        tasks.push_back([this, depth_frame_to_send, t]() { publishMetadata(depth_frame_to_send, t, opticalFrameId(DEPTH)); });
 
-            // Publish RGBD only if rgbd enabled and both depth and color frames exist.
-            // On this line we already know original_depth_frame is valid.
-            if(_enable_rgbd && original_color_frame)
-            {
-                auto color_format = original_color_frame.get_profile().format();
-                auto depth_format = original_depth_frame.get_profile().format();
-                publishRGBD(_images[COLOR], color_format, _depth_aligned_image[COLOR], depth_format, t);
-            }  
+        // Publish RGBD only if rgbd enabled and both aligned depth and color frames exist.
+        if(_enable_rgbd && color_frame && aligned_depth_frame)
+        {
+            tasks.push_back([this, color_frame, aligned_depth_frame, t]() { publishRGBD(color_frame, aligned_depth_frame, t); });
         }
     }
-    else if (frame.is<rs2::video_frame>())
+
+    if (_publish_task_pool && tasks.size() > 1)
     {
-        auto stream_type = frame.get_profile().stream_type();
-        auto stream_index = frame.get_profile().stream_index();
-        ROS_DEBUG("Single video frame arrived (%s, %d). frame_number: %llu ; frame_TS: %f ; ros_TS(NSec): %lu",
-                    rs2_stream_to_string(stream_type), stream_index, frame.get_frame_number(), frame_time, t.nanoseconds());
-            
-        stream_index_pair sip{stream_type,stream_index};
-        if (frame.is<rs2::depth_frame>())
+        _publish_task_pool->run(tasks);
+    }
+    else
+    {
+        for (auto& task : tasks)
         {
-            if (_clipping_distance > 0)
-            {
-                clip_depth(frame, _clipping_distance);
-            }
+            task();
         }
-        publishFrame(frame, t, sip, _images, _info_publishers, _image_publishers);
-     }
-     if (_synced_imu_publisher)
-        _synced_imu_publisher->Resume();
-} // frame_callback
+    }
+}
+
+void BaseRealSenseNode::publishVideoFrame(rs2::frame frame, const rclcpp::Time& t, int64_t callback_time_ns)
+{
+    stream_index_pair sip{frame.get_profile().stream_type(), frame.get_profile().stream_index()};
+    // Clip depth_frame for max range, while copying it into the published message.
+    float depth_clipping_dist = frame.is<rs2::depth_frame>() ? _clipping_distance : 0;
+    publishFrame(frame, t, sip, _stream_descriptors[streamSlot(sip)].output, true, depth_clipping_dist, callback_time_ns);
+}
+
+void BaseRealSenseNode::setupPipeline()
+{
+    if (!_enable_pipelining) return;
+
+    PipelineStage::DropPolicy drop_policy;
+    if (!PipelineStage::parseDropPolicy(_pipeline_drop_policy, drop_policy))
+    {
+        ROS_WARN_STREAM("Unknown pipeline_drop_policy: " << _pipeline_drop_policy << ". Using " << PIPELINE_DROP_POLICY);
+        PipelineStage::parseDropPolicy(PIPELINE_DROP_POLICY, drop_policy);
+    }
+    if (_pipeline_queue_size < 1)
+    {
+        ROS_WARN_STREAM("pipeline_queue_size must be at least 1. Using " << PIPELINE_QUEUE_SIZE);
+        _pipeline_queue_size = PIPELINE_QUEUE_SIZE;
+    }
+
+    ROS_INFO_STREAM("Pipelined frame processing enabled. Queue size: " << _pipeline_queue_size << ", drop policy: " << _pipeline_drop_policy);
+    const char* stage_names[PIPELINE_STAGES_COUNT] = {"filters", "processing", "publishing"};
+    for (int i = 0; i < PIPELINE_STAGES_COUNT; ++i)
+    {
+        _pipeline_stages.push_back(std::make_shared<PipelineStage>(stage_names[i], _pipeline_queue_size, drop_policy));
+    }
+}
+
+void BaseRealSenseNode::setupParallelPublish()
+{
+    if (!_enable_parallel_publish) return;
+
+    if (_parallel_publish_threads < 2)
+    {
+        ROS_WARN_STREAM("parallel_publish_threads must be at least 2. Using " << PARALLEL_PUBLISH_THREADS);
+        _parallel_publish_threads = PARALLEL_PUBLISH_THREADS;
+    }
+    ROS_INFO_STREAM("Parallel publishing enabled. Threads: " << _parallel_publish_threads);
+    _publish_task_pool = std::make_shared<TaskPool>(_parallel_publish_threads);
+}
+
+void BaseRealSenseNode::pushPipelineJob(PipelineStageIndex stage, PipelineStage::Job job)
+{
+    auto& pipeline_stage = _pipeline_stages[stage];
+    const std::string& stage_name = pipeline_stage->getName();
+    bool is_pushed = pipeline_stage->push([this, stage_name, job]()
+    {
+        try
+        {
+            job();
+        }
+        catch(const std::exception& ex)
+        {
+            ROS_ERROR_STREAM("An error has occurred in the " << stage_name << " pipeline stage: " << ex.what());
+        }
+    });
+    if (!is_pushed)
+        ROS_DEBUG_STREAM("Pipeline stage " << stage_name << " is full. Frame dropped.");
+}
+
+void BaseRealSenseNode::flushPipeline()
+{
+    // In stages order, so that jobs handed over by a flushed stage are flushed as well.
+    for (auto& stage : _pipeline_stages)
+    {
+        stage->flush();
+    }
+}
+
+unsigned int BaseRealSenseNode::getFiltersDemand()
+{
+    if (!_enable_lazy_filters)
+        return ALL_OUTPUTS;
+
+    // The publishers are not queried here: the frame threads would race the publishers changes.
+    if (_is_filters_demand_stale)
+        return ALL_OUTPUTS;
+    return _filters_demand;
+}
+
+void BaseRealSenseNode::updateFiltersDemand()
+{
+    // The publishers are changed under _update_sensor_mutex, which also marks the demand as stale.
+    std::lock_guard<std::mutex> lock_guard(_update_sensor_mutex);
+    unsigned int filters_demand = countFiltersDemand();
+    if (filters_demand != _filters_demand)
+        ROS_DEBUG_STREAM("Filters demand changed: " << _filters_demand << " -> " << filters_demand);
+    _filters_demand = filters_demand;
+    _is_filters_demand_stale = false;
+}
+
+unsigned int BaseRealSenseNode::countFiltersDemand()
+{
+    unsigned int filters_demand(0);
+    auto add_demand = [&filters_demand](const stream_index_pair& sip, size_t subscription_count)
+    {
+        if (subscription_count == 0 || sip.first == RS2_STREAM_COLOR || sip.first == RS2_STREAM_GYRO || sip.first == RS2_STREAM_ACCEL)
+            return;
+        filters_demand |= DEPTH_STREAMS_OUTPUT;
+        if (sip == DEPTH)
+            filters_demand |= DEPTH_OUTPUT;
+    };
+    for (auto& descriptor : _stream_descriptors)
+    {
+        if (descriptor.output.image)
+            add_demand(descriptor.sip, descriptor.output.image->get_subscription_count());
+        if (descriptor.output.info)
+            add_demand(descriptor.sip, descriptor.output.info->get_subscription_count());
+        if ((descriptor.aligned_depth_output.image && descriptor.aligned_depth_output.image->get_subscription_count() > 0) ||
+            (descriptor.aligned_depth_output.info && descriptor.aligned_depth_output.info->get_subscription_count() > 0))
+            filters_demand |= ALIGNED_DEPTH_OUTPUT;
+    }
+    for (auto& publisher : _metadata_publishers)
+        add_demand(publisher.first, publisher.second->get_subscription_count());
+    for (auto& publisher : _metadata_values_publishers)
+        add_demand(publisher.first, publisher.second->get_subscription_count());
+
+    if (_pc_filter->getSubscriptionCount() > 0)
+        filters_demand |= POINTCLOUD_OUTPUT;
+
+    if (isRGBDSubscribed())
+        filters_demand |= ALIGNED_DEPTH_OUTPUT;
+    return filters_demand;
+}
 
 void BaseRealSenseNode::multiple_message_callback(rs2::frame frame, imu_sync_method sync_method)
 {
@@ -636,9 +1004,9 @@ bool BaseRealSenseNode::setBaseTime(double frame_time, rs2_timestamp_domain time
     ROS_WARN_ONCE(time_domain == RS2_TIMESTAMP_DOMAIN_SYSTEM_TIME ? "Frame metadata isn't available! (frame_timestamp_domain = RS2_TIMESTAMP_DOMAIN_SYSTEM_TIME)" : "");
     if (time_domain == RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK)
     {
-        ROS_WARN("frame's time domain is HARDWARE_CLOCK. Timestamps may reset periodically.");
-        _ros_time_base = _node.now();
-        _camera_time_base = frame_time;
+        ROS_INFO_STREAM("frame's time domain is HARDWARE_CLOCK: the timestamps are mapped to ROS time by a clock offset estimator, from "
+                        << frame_time << " ms.");
+        _clock_offset_estimator.reset();
         return true;
     }
     return false;
@@ -663,11 +1031,8 @@ rclcpp::Time BaseRealSenseNode::frameSystemTimeSec(rs2::frame frame)
     double timestamp_ms = frame.get_timestamp();
     if (frame.get_frame_timestamp_domain() == RS2_TIMESTAMP_DOMAIN_HARDWARE_CLOCK)
     {
-        double elapsed_camera_ns = millisecondsToNanoseconds(timestamp_ms - _camera_time_base);
-
-        auto duration = rclcpp::Duration::from_nanoseconds(elapsed_camera_ns);
-
-        return rclcpp::Time(_ros_time_base + duration);
+        // The arrival time of every frame refines the clock offset and skew, and the wraps of the device clock
+        return rclcpp::Time(_clock_offset_estimator.update(timestamp_ms, _node.now().nanoseconds()), _node.get_clock()->get_clock_type());
     }
     else
     {
@@ -677,6 +1042,7 @@ rclcpp::Time BaseRealSenseNode::frameSystemTimeSec(rs2::frame frame)
 
 void BaseRealSenseNode::updateProfilesStreamCalibData(const std::vector<rs2::stream_profile>& profiles)
 {
+    std::lock_guard<std::mutex> lock_guard(_camera_info_mutex);
     std::shared_ptr<rs2::stream_profile> left_profile;
     std::shared_ptr<rs2::stream_profile> right_profile;
     for (auto& profile : profiles)
@@ -799,10 +1165,14 @@ void BaseRealSenseNode::SetBaseStream()
     _base_profile = available_profiles[*base_stream];
 }
 
+const std::string& BaseRealSenseNode::opticalFrameId(const stream_index_pair& sip) const
+{
+    return _stream_descriptors[streamSlot(sip)].optical_frame_id;
+}
+
 void BaseRealSenseNode::publishPointCloud(rs2::points pc, const rclcpp::Time& t, const rs2::frameset& frameset)
 {
-    std::string frame_id = OPTICAL_FRAME_ID(DEPTH);
-    _pc_filter->Publish(pc, t, frameset, frame_id);
+    _pc_filter->Publish(pc, t, frameset, opticalFrameId(DEPTH));
 }
 
 
@@ -850,69 +1220,58 @@ IMUInfo BaseRealSenseNode::getImuInfo(const rs2::stream_profile& profile)
 }
 
 bool BaseRealSenseNode::fillROSImageMsgAndReturnStatus(
-    const cv::Mat& cv_matrix_image,
+    const rs2::video_frame& frame,
     const stream_index_pair& stream,
-    unsigned int width,
-    unsigned int height,
-    const rs2_format& stream_format,
+    const char* encoding,
     const rclcpp::Time& t,
-    sensor_msgs::msg::Image* img_msg_ptr)
+    sensor_msgs::msg::Image* img_msg_ptr,
+    float depth_clipping_dist)
 {
-    if (cv_matrix_image.empty())
+    if (!encoding)
     {
-        ROS_ERROR_STREAM("cv::Mat is empty. Ignoring this frame.");
-        return false;
-    }
-    else if (_rs_format_to_ros_format.find(stream_format) == _rs_format_to_ros_format.end())
-    {
-        ROS_ERROR_STREAM("Format " << rs2_format_to_string(stream_format) << " is not supported in ROS2 image messages"
+        ROS_ERROR_STREAM("Format " << rs2_format_to_string(frame.get_profile().format()) << " is not supported in ROS2 image messages"
                                    << "Please try different format of this stream.");
         return false;
     }
-    // Convert the CV::Mat into a ROS image message (1 copy is done here)
-    cv_bridge::CvImage(std_msgs::msg::Header(), _rs_format_to_ros_format[stream_format], cv_matrix_image).toImageMsg(*img_msg_ptr);
 
-    // Convert OpenCV Mat to ROS Image
-    img_msg_ptr->header.frame_id = OPTICAL_FRAME_ID(stream);
+    unsigned int width = frame.get_width();
+    unsigned int height = frame.get_height();
+    unsigned int step = width * frame.get_bytes_per_pixel();
+    unsigned int src_stride = frame.get_stride_in_bytes();
+
+    img_msg_ptr->header.frame_id = opticalFrameId(stream);
     img_msg_ptr->header.stamp = t;
     img_msg_ptr->height = height;
     img_msg_ptr->width = width;
+    img_msg_ptr->encoding = encoding;
     img_msg_ptr->is_bigendian = false;
-    img_msg_ptr->step = width * cv_matrix_image.elemSize();
-    return true;
-}
+    img_msg_ptr->step = step;
+    img_msg_ptr->data.resize(step * height);
 
-bool BaseRealSenseNode::fillCVMatImageAndReturnStatus(
-    rs2::frame& frame,
-    std::map<stream_index_pair, cv::Mat>& images,
-    unsigned int width,
-    unsigned int height,
-    const stream_index_pair& stream)
-{
-    auto& image = images[stream];
-    auto stream_format = frame.get_profile().format();
-
-    if (_rs_format_to_cv_format.find(stream_format) == _rs_format_to_cv_format.end())
+    // Copy the frame buffer straight into the message (1 copy is done here).
+    // Depth frames get their scale fixed, and are clipped if requested, on the way, so no intermediate buffer is needed.
+    const uint8_t* src = static_cast<const uint8_t*>(frame.get_data());
+    uint8_t* dst = img_msg_ptr->data.data();
+    if (frame.is<rs2::depth_frame>())
     {
-        ROS_ERROR_STREAM("Format " << rs2_format_to_string(stream_format) << " is not supported in realsense2_camera node."
-                                   << "\nPlease try different format of this stream.");
-        return false;
+        for (unsigned int row = 0; row < height; ++row)
+        {
+            fix_depth_scale(reinterpret_cast<const uint16_t*>(src + row * src_stride),
+                            reinterpret_cast<uint16_t*>(dst + row * step), width, depth_clipping_dist);
+        }
     }
-    // we try to reduce image creation as much we can, so we check if the same image structure
-    // was already created before, and we fill this image next with the frame data
-    // image.create() should be called once per <stream>_<profile>_<format>
-    if (image.size() != cv::Size(width, height) || CV_MAKETYPE(image.depth(), image.channels()) != _rs_format_to_cv_format[stream_format])
+    else if (src_stride == step)
     {
-        image.create(height, width, _rs_format_to_cv_format[stream_format]);
+        memcpy(dst, src, step * height);
     }
-
-    image.data = (uint8_t*)frame.get_data();
-
-    if (frame.is<rs2::depth_frame>())
+    else
     {
-        image = fix_depth_scale(image, _depth_scaled_image[stream]);
+        unsigned int row_size = std::min(step, src_stride);
+        for (unsigned int row = 0; row < height; ++row)
+        {
+            memcpy(dst + row * step, src + row * src_stride, row_size);
+        }
     }
-
     return true;
 }
 
@@ -920,21 +1279,17 @@ void BaseRealSenseNode::publishFrame(
     rs2::frame f,
     const rclcpp::Time& t,
     const stream_index_pair& stream,
-    std::map<stream_index_pair, cv::Mat>& images,
-    const std::map<stream_index_pair, rclcpp::Publisher<sensor_msgs::msg::CameraInfo>::SharedPtr>& info_publishers,
-    const std::map<stream_index_pair, std::shared_ptr<image_publisher>>& image_publishers,
-    const bool is_publishMetadata)
+    const StreamOutput& output,
+    const bool is_publishMetadata,
+    float depth_clipping_dist,
+    int64_t callback_time_ns,
+    bool is_resized)
 {
     ROS_DEBUG("publishFrame(...)");
     unsigned int width = 0;
-    unsigned int height = 0;
-    auto stream_format = RS2_FORMAT_ANY;
     if (f.is<rs2::video_frame>())
     {
-        auto timage = f.as<rs2::video_frame>();
-        width = timage.get_width();
-        height = timage.get_height();
-        stream_format = timage.get_profile().format();
+        width = f.as<rs2::video_frame>().get_width();
     }
     else
     {
@@ -942,150 +1297,182 @@ void BaseRealSenseNode::publishFrame(
         return;
     }
 
+    const StreamDescriptor& descriptor(_stream_descriptors[streamSlot(stream)]);
+    if (is_resized && descriptor.camera_info)
+    {
+        std::lock_guard<std::mutex> lock_guard(_camera_info_mutex);
+        if (descriptor.camera_info->width != width)
+            updateStreamCalibData(f.get_profile().as<rs2::video_stream_profile>());
+    }
+
     // Publish stream image
-    if (image_publishers.find(stream) != image_publishers.end())
+    if (output.image && 0 != output.image->get_subscription_count())
     {
-        auto &image_publisher = image_publishers.at(stream);
-        cv::Mat image_cv_matrix;
+        // Unless a filter changed the frames format
+        rs2_format format = f.get_profile().format();
+        const char* encoding = (format == output.format) ? output.encoding : formatTraits(format).encoding;
+        // The publisher owns the message: a unique pointer for intra-process or a middleware loaned message
+        bool is_published = output.image->fill_and_publish([&](sensor_msgs::msg::Image& img_msg)
+        {
+            bool is_filled = fillROSImageMsgAndReturnStatus(f.as<rs2::video_frame>(), stream, encoding, t, &img_msg, depth_clipping_dist);
+            recordLatency(output.latency.fill, callback_time_ns);
+            return is_filled;
+        });
 
-        // if rgbd has subscribers we fetch the CV image here
-        if (_rgbd_publisher && 0 != _rgbd_publisher->get_subscription_count())
+        if (is_published)
         {
-            if (fillCVMatImageAndReturnStatus(f, images, width, height, stream))
-            {
-                image_cv_matrix = images[stream];
-            }
+            recordLatency(output.latency.publish, callback_time_ns);
+            ROS_DEBUG_STREAM(rs2_stream_to_string(f.get_profile().stream_type()) << " stream published");
         }
-
-        // if depth/color has subscribers, ask first if rgbd already fetched
-        // the images from the frame. if not, fetch the relevant color/depth image.
-        if (0 != image_publisher->get_subscription_count())
+        else
         {
-            if (image_cv_matrix.empty() && fillCVMatImageAndReturnStatus(f, images, width, height, stream))
-            {
-                image_cv_matrix = images[stream];
-            }
-
-            // Prepare image topic to be published
-            // We use UniquePtr for allow intra-process publish when subscribers of that type are available
-            sensor_msgs::msg::Image::UniquePtr img_msg_ptr(new sensor_msgs::msg::Image());
-            if (!img_msg_ptr)
-            {
-                ROS_ERROR("Sensor image message allocation failed. Frame was dropped.");
-                return;
-            }
-
-            if (fillROSImageMsgAndReturnStatus(image_cv_matrix, stream, width, height, stream_format, t, img_msg_ptr.get()))
-            {
-
-                // Transfer the unique pointer ownership to the RMW
-                sensor_msgs::msg::Image *msg_address = img_msg_ptr.get();
-                image_publisher->publish(std::move(img_msg_ptr));
-
-                ROS_DEBUG_STREAM(rs2_stream_to_string(f.get_profile().stream_type()) << " stream published, message address: " << std::hex << msg_address);
-            }
-            else
-            {
-                ROS_ERROR("Could not fill ROS message. Frame was dropped.");
-            }
+            ROS_ERROR("Could not fill ROS message. Frame was dropped.");
         }
     }
 
     // Publish stream camera info
-    if(info_publishers.find(stream) != info_publishers.end())
+    if (output.info && descriptor.camera_info)
     {
-        auto& info_publisher = info_publishers.at(stream);
+        bool is_info_subscribed = (0 != output.info->get_subscription_count());
 
-        // If rgbd has subscribers, get the camera info of color/detph sensors from _camera_info map.
-        // We need this camera info to fill the rgbd msg, regardless if there subscribers to depth/color camera info.
-        // We are not publishing this cam_info here, but will be published by rgbd publisher.
-        if (_rgbd_publisher && 0 != _rgbd_publisher->get_subscription_count())
+        // If rgbd has subscribers, the camera info of color/depth sensors is stamped in the _camera_info map,
+        // regardless if there are subscribers to depth/color camera info: it is published by the rgbd publisher.
+        if (is_info_subscribed || isRGBDSubscribed())
         {
-            auto& cam_info = _camera_info.at(stream);
-
-            // Fix the camera info if needed, usually only in the first time
-            // when we init this object in the _camera_info map
-            if (cam_info.width != width)
+            sensor_msgs::msg::CameraInfo stamped_cam_info;
             {
-                updateStreamCalibData(f.get_profile().as<rs2::video_stream_profile>());
+                // Color camera info is shared by the color and the aligned depth streams, which may be published in parallel.
+                // Only the map is guarded: the stamped copy is published outside of the lock.
+                // The camera info is set once per profile, only its stamp changes from frame to frame.
+                std::lock_guard<std::mutex> lock_guard(_camera_info_mutex);
+                descriptor.camera_info->header.stamp = t;
+                if (is_info_subscribed)
+                    stamped_cam_info = *descriptor.camera_info;
             }
-            cam_info.header.stamp = t;
-        }
-
-        // If depth/color camera info has subscribers get camera info from _camera_info map,
-        // and publish this msg.
-        if(0 != info_publisher->get_subscription_count())
-        {
-            auto& cam_info = _camera_info.at(stream);
-
-            // Fix the camera info if needed, usually only in the first time
-            // when we init this object in the _camera_info map
-            if (cam_info.width != width)
-            {
-                updateStreamCalibData(f.get_profile().as<rs2::video_stream_profile>());
-            }
-            cam_info.header.stamp = t;
-            info_publisher->publish(cam_info);
+            if (is_info_subscribed)
+                output.info->publish(stamped_cam_info);
         }
     }
 
     // Publish stream metadata
     if (is_publishMetadata)
     {
-        publishMetadata(f, t, OPTICAL_FRAME_ID(stream));
+        publishMetadata(f, t, opticalFrameId(stream));
+    }
+}
+
+
+bool BaseRealSenseNode::fillRGBDMsgAndReturnStatus(
+    const rs2::video_frame& color_frame,
+    const rs2::video_frame& depth_frame,
+    const rclcpp::Time& t,
+    realsense2_camera_msgs::msg::RGBD* msg)
+{
+    bool rgb_message_filled = fillROSImageMsgAndReturnStatus(color_frame, COLOR, formatTraits(color_frame.get_profile().format()).encoding, t, &msg->rgb);
+    if(!rgb_message_filled)
+    {
+        ROS_ERROR_STREAM("Failed to fill rgb message inside RGBD message");
+        return false;
+    }
+
+    bool depth_messages_filled = fillROSImageMsgAndReturnStatus(depth_frame, DEPTH, formatTraits(depth_frame.get_profile().format()).encoding, t, &msg->depth);
+    if(!depth_messages_filled)
+    {
+        ROS_ERROR_STREAM("Failed to fill depth message inside RGBD message");
+        return false;
     }
+
+    msg->header.frame_id = "camera_rgbd_optical_frame";
+    msg->header.stamp = t;
+
+    std::lock_guard<std::mutex> lock_guard(_camera_info_mutex);
+    msg->rgb_camera_info = _camera_info.at(COLOR);
+    msg->depth_camera_info = _camera_info.at(DEPTH);
+    return true;
 }
 
+bool BaseRealSenseNode::isRGBDSubscribed()
+{
+    return (_rgbd_publisher && 0 != _rgbd_publisher->get_subscription_count()) ||
+           (_rgbd_publisher && _multi_camera_syncer && _multi_camera_syncer->isSubscribed());
+}
 
 void BaseRealSenseNode::publishRGBD(
-    const cv::Mat& rgb_cv_matrix,
-    const rs2_format& color_format,
-    const cv::Mat& depth_cv_matrix,
-    const rs2_format& depth_format,
+    const rs2::video_frame& color_frame,
+    const rs2::video_frame& depth_frame,
     const rclcpp::Time& t)
 {
+    if (_rgbd_publisher && _multi_camera_syncer && _multi_camera_syncer->isSubscribed())
+    {
+        // Kept by the syncer until the frames of the other cameras are there, so not taken from the pool
+        auto msg = std::make_shared<realsense2_camera_msgs::msg::RGBD>();
+        if (fillRGBDMsgAndReturnStatus(color_frame, depth_frame, t, msg.get()))
+            _multi_camera_syncer->push(_camera_name, msg);
+    }
     if (_rgbd_publisher && 0 != _rgbd_publisher->get_subscription_count())
     {
         ROS_DEBUG_STREAM("Publishing RGBD message");
-        unsigned int rgb_width = rgb_cv_matrix.size().width;
-        unsigned int rgb_height = rgb_cv_matrix.size().height;
-        unsigned int depth_width = depth_cv_matrix.size().width;
-        unsigned int depth_height = depth_cv_matrix.size().height;
-
-        realsense2_camera_msgs::msg::RGBD::UniquePtr msg(new realsense2_camera_msgs::msg::RGBD());
-
-        bool rgb_message_filled = fillROSImageMsgAndReturnStatus(rgb_cv_matrix, COLOR, rgb_width, rgb_height, color_format, t, &msg->rgb);
-        if(!rgb_message_filled)
+        if (_use_intra_process)
         {
-            ROS_ERROR_STREAM("Failed to fill rgb message inside RGBD message");
-            return;
-        }
+            // We use UniquePtr for allow intra-process publish when subscribers of that type are available
+            realsense2_camera_msgs::msg::RGBD::UniquePtr msg(new realsense2_camera_msgs::msg::RGBD());
+            if (!fillRGBDMsgAndReturnStatus(color_frame, depth_frame, t, msg.get()))
+                return;
 
-        bool depth_messages_filled = fillROSImageMsgAndReturnStatus(depth_cv_matrix, DEPTH, depth_width, depth_height, depth_format, t, &msg->depth);
-        if(!depth_messages_filled)
-        {
-            ROS_ERROR_STREAM("Failed to fill depth message inside RGBD message");
-            return;
+            realsense2_camera_msgs::msg::RGBD *msg_address = msg.get();
+            _rgbd_publisher->publish(std::move(msg));
+            ROS_DEBUG_STREAM("rgbd stream published, message address: " << std::hex << msg_address);
         }
+        else
+        {
+            // Inter-process publishing only borrows the message, so its buffers are reused for the next frame
+            auto msg = _rgbd_msg_pool.acquire();
+            if (!fillRGBDMsgAndReturnStatus(color_frame, depth_frame, t, msg.get()))
+                return;
 
-        msg->header.frame_id = "camera_rgbd_optical_frame";
-        msg->header.stamp = t;
-
-        auto rgb_camera_info = _camera_info.at(COLOR);
-        msg->rgb_camera_info = rgb_camera_info;
+            _rgbd_publisher->publish(*msg);
+            ROS_DEBUG_STREAM("rgbd stream published");
+        }
+    }
+}
 
-        auto depth_camera_info = _camera_info.at(DEPTH);
-        msg->depth_camera_info = depth_camera_info;
+namespace
+{
+    // The json names of the metadata values and clock domains, instead of converting them on every frame.
+    const std::vector<std::string>& metadataNames()
+    {
+        static const std::vector<std::string> names = []()
+        {
+            std::vector<std::string> names;
+            for (int i = 0; i < RS2_FRAME_METADATA_COUNT; i++)
+            {
+                if (RS2_FRAME_METADATA_FRAME_TIMESTAMP == i)
+                    names.push_back("hw_timestamp");
+                else
+                    names.push_back(create_graph_resource_name(rs2_frame_metadata_to_string((rs2_frame_metadata_value)i)));
+            }
+            return names;
+        }();
+        return names;
+    }
 
-        realsense2_camera_msgs::msg::RGBD *msg_address = msg.get();
-        _rgbd_publisher->publish(std::move(msg));
-        ROS_DEBUG_STREAM("rgbd stream published, message address: " << std::hex << msg_address);
+    const std::string& clockDomainName(rs2_timestamp_domain domain)
+    {
+        static const std::vector<std::string> names = []()
+        {
+            std::vector<std::string> names;
+            for (int i = 0; i < RS2_TIMESTAMP_DOMAIN_COUNT; i++)
+                names.push_back(create_graph_resource_name(rs2_timestamp_domain_to_string((rs2_timestamp_domain)i)));
+            return names;
+        }();
+        static const std::string unknown_name("unknown");
+        return (domain >= 0 && domain < RS2_TIMESTAMP_DOMAIN_COUNT) ? names[domain] : unknown_name;
     }
 }
 
 void BaseRealSenseNode::publishMetadata(rs2::frame f, const rclcpp::Time& header_time, const std::string& frame_id)
 {
-    stream_index_pair stream = {f.get_profile().stream_type(), f.get_profile().stream_index()};    
+    stream_index_pair stream = {f.get_profile().stream_type(), f.get_profile().stream_index()};
     if (_metadata_publishers.find(stream) != _metadata_publishers.end())
     {
         auto& md_publisher = _metadata_publishers.at(stream);
@@ -1096,24 +1483,19 @@ void BaseRealSenseNode::publishMetadata(rs2::frame f, const rclcpp::Time& header
             msg.header.stamp = header_time;
             std::stringstream json_data;
             const char* separator = ",";
+            const std::vector<std::string>& names = metadataNames();
             json_data << "{";
             // Add additional fields:
             json_data << "\"" << "frame_number" << "\":" << f.get_frame_number();
-            json_data << separator << "\"" << "clock_domain" << "\":" << "\"" << create_graph_resource_name(rs2_timestamp_domain_to_string(f.get_frame_timestamp_domain())) << "\"";
+            json_data << separator << "\"" << "clock_domain" << "\":" << "\"" << clockDomainName(f.get_frame_timestamp_domain()) << "\"";
             json_data << separator << "\"" << "frame_timestamp" << "\":" << std::fixed << f.get_timestamp();
 
             for (auto i = 0; i < RS2_FRAME_METADATA_COUNT; i++)
             {
                 if (f.supports_frame_metadata((rs2_frame_metadata_value)i))
                 {
-                    rs2_frame_metadata_value mparam = (rs2_frame_metadata_value)i;
-                    std::string name = create_graph_resource_name(rs2_frame_metadata_to_string(mparam));
-                    if (RS2_FRAME_METADATA_FRAME_TIMESTAMP == i)
-                    {
-                        name = "hw_timestamp";
-                    }
-                    rs2_metadata_type val = f.get_frame_metadata(mparam);
-                    json_data << separator << "\"" << name << "\":" << val;
+                    rs2_metadata_type val = f.get_frame_metadata((rs2_frame_metadata_value)i);
+                    json_data << separator << "\"" << names[i] << "\":" << val;
                 }
             }
             json_data << "}";
@@ -1121,6 +1503,70 @@ void BaseRealSenseNode::publishMetadata(rs2::frame f, const rclcpp::Time& header
             md_publisher->publish(msg);
         }
     }
+
+    // Same values as the json message, without formatting: consumers read them without parsing.
+    if (_metadata_values_publishers.find(stream) != _metadata_values_publishers.end())
+    {
+        auto& md_publisher = _metadata_values_publishers.at(stream);
+        if (0 != md_publisher->get_subscription_count())
+        {
+            realsense2_camera_msgs::msg::MetadataValues msg;
+            msg.header.frame_id = frame_id;
+            msg.header.stamp = header_time;
+            msg.frame_number = f.get_frame_number();
+            msg.clock_domain = static_cast<uint8_t>(f.get_frame_timestamp_domain());
+            msg.frame_timestamp = f.get_timestamp();
+            msg.keys.reserve(RS2_FRAME_METADATA_COUNT);
+            msg.values.reserve(RS2_FRAME_METADATA_COUNT);
+            for (auto i = 0; i < RS2_FRAME_METADATA_COUNT; i++)
+            {
+                if (f.supports_frame_metadata((rs2_frame_metadata_value)i))
+                {
+                    msg.keys.push_back(static_cast<uint16_t>(i));
+                    msg.values.push_back(f.get_frame_metadata((rs2_frame_metadata_value)i));
+                }
+            }
+            md_publisher->publish(msg);
+        }
+    }
+}
+
+int64_t BaseRealSenseNode::arrivalLatency(const rs2::frame& frame)
+{
+    // Not from the ROS stamp: the ROS clock may be simulated and the frame timestamp mapped from the device clock.
+    // librealsense stamps the frame arrival with the host system clock only, hence the latency is measured on it.
+    double arrival_ms(0);
+    if (frame.supports_frame_metadata(RS2_FRAME_METADATA_TIME_OF_ARRIVAL))
+        arrival_ms = static_cast<double>(frame.get_frame_metadata(RS2_FRAME_METADATA_TIME_OF_ARRIVAL));
+    else if (frame.get_frame_timestamp_domain() == RS2_TIMESTAMP_DOMAIN_SYSTEM_TIME)
+        arrival_ms = frame.get_timestamp();
+    else
+        return -1;
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    return std::max<int64_t>(0, now_ns - static_cast<int64_t>(millisecondsToNanoseconds(arrival_ms)));
+}
+
+void BaseRealSenseNode::recordLatency(LatencyHistogram* histogram, int64_t callback_time_ns)
+{
+    if (callback_time_ns && histogram)
+        histogram->record(LatencyStats::now() - callback_time_ns);
+}
+
+void BaseRealSenseNode::addLatencyStats(diagnostic_updater::DiagnosticStatusWrapper& status)
+{
+    if (!_enable_latency_stats)
+    {
+        status.summary(0, "Disabled. Set latency_stats.enable to record the latencies");
+        return;
+    }
+    // Milliseconds since the frame callback entry, except for the callback stage: since the frame timestamp.
+    for (auto& entry : _latency_stats.getEntries())
+    {
+        status.addf(entry.stage + "/" + entry.stream, "count: %lu, p50: %.3f, p95: %.3f, p99: %.3f, max: %.3f",
+                    static_cast<unsigned long>(entry.summary.count), entry.summary.p50_ms, entry.summary.p95_ms,
+                    entry.summary.p99_ms, entry.summary.max_ms);
+    }
+    status.summary(0, "OK");
 }
 
 void BaseRealSenseNode::startDiagnosticsUpdater()
@@ -1136,6 +1582,7 @@ void BaseRealSenseNode::startDiagnosticsUpdater()
         _diagnostics_updater->add("Temperatures", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
         {
             bool got_temperature(false);
+            std::lock_guard<std::mutex> lock_guard(_update_sensor_mutex);     // the sensors are replaced on reconnect
             for(auto&& sensor : _available_ros_sensors)
             {
                 for (rs2_option option : _monitor_options)
@@ -1158,5 +1605,98 @@ void BaseRealSenseNode::startDiagnosticsUpdater()
             }
             status.summary(0, "OK");
         });
+
+        _diagnostics_updater->add("Clock Offset", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
+        {
+            // Only estimated for the HARDWARE_CLOCK time domain
+            ClockOffsetEstimator::Estimate estimate = _clock_offset_estimator.getEstimate();
+            status.add("offset_ms", estimate.offset_ns * 1e-6);
+            status.add("skew_ppm", estimate.skew_ppm);
+            status.add("samples", estimate.samples);
+            status.summary(0, "OK");
+        });
+
+        _diagnostics_updater->add("Output Throttle", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
+        {
+            status.add("latency_ms", _output_throttle.getLatencySeconds() * 1e3);
+            const bool is_overloaded(_output_throttle.isOverloaded());
+            status.add("overloaded", is_overloaded);
+            for (auto& stats : _output_throttle.getStats())
+            {
+                status.addf(_throttled_output_names.at(stats.first), "computed: %lu, rate limited: %lu, decimated: %lu",
+                            stats.second.computed, stats.second.rate_limited, stats.second.decimated);
+            }
+            if (is_overloaded)
+                status.summary(1, "Overloaded, outputs are decimated");
+            else
+                status.summary(0, "OK");
+        });
+
+        _diagnostics_updater->add("Raw Recording", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
+        {
+            std::shared_ptr<RawRecorder> recorder;
+            {
+                std::lock_guard<std::mutex> lock_guard(_raw_recorder_mutex);
+                recorder = _raw_recorder;
+            }
+            if (!recorder)
+            {
+                status.summary(0, "Not recording");
+                return;
+            }
+            status.add("dir", recorder->getWriter().getDirPath());
+            status.add("frames", recorder->getWriter().getFramesCount());
+            const uint64_t dropped_count(recorder->getWriter().getDroppedCount());
+            status.add("dropped", dropped_count);
+            if (dropped_count > 0)
+                status.summary(1, "Frames were dropped");
+            else
+                status.summary(0, "OK");
+        });
+
+        _diagnostics_updater->add("Message Pools", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
+        {
+            auto add_pool_stats = [&status](const std::string& name, const MessagePoolStats& stats)
+            {
+                status.addf(name, "in use: %zu, free: %zu, high water mark: %zu, allocations: %zu",
+                            stats.in_use, stats.free, stats.high_water_mark, stats.allocations);
+            };
+
+            MessagePoolStats stats;
+            {
+                std::lock_guard<std::mutex> lock_guard(_update_sensor_mutex);
+                for (auto& descriptor : _stream_descriptors)
+                {
+                    if (descriptor.output.image && descriptor.output.image->get_message_pool_stats(stats))
+                        add_pool_stats(STREAM_NAME(descriptor.sip), stats);
+                    if (descriptor.aligned_depth_output.image && descriptor.aligned_depth_output.image->get_message_pool_stats(stats))
+                        add_pool_stats("aligned_depth_to_" + STREAM_NAME(descriptor.sip), stats);
+                }
+            }
+            if (!_use_intra_process)
+                add_pool_stats("rgbd", _rgbd_msg_pool.getStats());
+            if (_pc_filter && _pc_filter->getMessagePoolStats(stats))
+                add_pool_stats("pointcloud", stats);
+            status.summary(0, "OK");
+        });
+
+        _diagnostics_updater->add("Latency", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
+        {
+            addLatencyStats(status);
+        });
+
+        if (_enable_pipelining)
+        {
+            _diagnostics_updater->add("Processing Pipeline", [this](diagnostic_updater::DiagnosticStatusWrapper& status)
+            {
+                for (auto& stage : _pipeline_stages)
+                {
+                    PipelineStageStats stats = stage->getStats();
+                    status.addf(stage->getName(), "queue: %zu/%zu, processed: %zu, dropped: %zu",
+                                stats.queue_size, stats.max_queue_size, stats.processed, stats.dropped);
+                }
+                status.summary(0, "OK");
+            });
+        }
     }
 }
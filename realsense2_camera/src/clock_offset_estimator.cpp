@@ -0,0 +1,161 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <clock_offset_estimator.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    const double NS_PER_MS(1e6);
+    const double CLOCK_RESET_MS(1000.0);        // a device clock going back by more is restarted
+    const double MAX_SKEW(1e-3);                // crystals are well within 1000 ppm: more is noise
+    const double MIN_FIT_SPAN_MS(1000.0);       // the skew isn't estimated from a shorter span
+}
+
+constexpr double ClockOffsetEstimator::HARDWARE_CLOCK_WRAP_MS;
+
+ClockOffsetEstimator::ClockOffsetEstimator(size_t capacity, double sample_interval_ms, double wrap_period_ms) :
+    _capacity(std::max<size_t>(capacity, 2)),
+    _sample_interval_ms(sample_interval_ms),
+    _wrap_period_ms(wrap_period_ms)
+{
+    resetLocked();
+}
+
+void ClockOffsetEstimator::reset()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    resetLocked();
+}
+
+void ClockOffsetEstimator::resetLocked()
+{
+    _is_initialized = false;
+    _device_ref_ms = 0;
+    _host_ref_ns = 0;
+    _wrap_offset_ms = 0;
+    _last_device_ms = 0;
+    _samples.clear();
+    _next_sample = 0;
+    _has_bucket_sample = false;
+    _bucket_end_ms = 0;
+    _intercept_ns = 0;
+    _slope_ns_per_ms = NS_PER_MS;
+}
+
+int64_t ClockOffsetEstimator::update(double device_time_ms, int64_t host_time_ns)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    double wrap_offset_ms(_wrap_offset_ms);
+    if (_is_initialized)
+    {
+        double device_ms = device_time_ms + _wrap_offset_ms - _device_ref_ms;
+        if (device_ms < _last_device_ms - _wrap_period_ms / 2)
+        {
+            _wrap_offset_ms += _wrap_period_ms;
+            wrap_offset_ms = _wrap_offset_ms;
+        }
+        else if (device_ms > _last_device_ms + _wrap_period_ms / 2)
+        {
+            // A frame from before the wrap, arriving after a frame from after it
+            wrap_offset_ms -= _wrap_period_ms;
+        }
+        else if (device_ms < _last_device_ms - CLOCK_RESET_MS)
+        {
+            resetLocked();
+        }
+    }
+    if (!_is_initialized)
+    {
+        // The first frame anchors the clocks, as a line of no skew
+        _is_initialized = true;
+        _device_ref_ms = device_time_ms;
+        _host_ref_ns = host_time_ns;
+        _bucket_end_ms = _sample_interval_ms;
+        commit(Sample{0, 0});
+        return host_time_ns;
+    }
+
+    // Frames of several streams are not in order: the device clock goes back by a few milliseconds
+    Sample sample{device_time_ms + wrap_offset_ms - _device_ref_ms, static_cast<double>(host_time_ns - _host_ref_ns)};
+    _last_device_ms = std::max(_last_device_ms, sample.device_ms);
+    if (sample.device_ms >= _bucket_end_ms)
+    {
+        if (_has_bucket_sample)
+            commit(_bucket_sample);
+        _bucket_sample = sample;
+        _has_bucket_sample = true;
+        _bucket_end_ms = std::floor(sample.device_ms / _sample_interval_ms + 1) * _sample_interval_ms;
+    }
+    else if (!_has_bucket_sample ||
+             sample.host_ns - sample.device_ms * NS_PER_MS < _bucket_sample.host_ns - _bucket_sample.device_ms * NS_PER_MS)
+    {
+        _bucket_sample = sample;
+        _has_bucket_sample = true;
+    }
+    return _host_ref_ns + static_cast<int64_t>(std::llround(toHost(sample.device_ms)));
+}
+
+ClockOffsetEstimator::Estimate ClockOffsetEstimator::getEstimate() const
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    Estimate estimate;
+    estimate.offset_ns = _host_ref_ns + static_cast<int64_t>(std::llround(toHost(_last_device_ms))) -
+                         static_cast<int64_t>(std::llround((_device_ref_ms + _last_device_ms - _wrap_offset_ms) * NS_PER_MS));
+    estimate.skew_ppm = (NS_PER_MS / _slope_ns_per_ms - 1.0) * 1e6;
+    estimate.samples = _samples.size();
+    return estimate;
+}
+
+void ClockOffsetEstimator::commit(const Sample& sample)
+{
+    if (_samples.size() < _capacity)
+        _samples.push_back(sample);
+    else
+        _samples[_next_sample] = sample;
+    _next_sample = (_next_sample + 1) % _capacity;
+    fit();
+}
+
+void ClockOffsetEstimator::fit()
+{
+    double mean_device(0), mean_host(0);
+    double min_device(_samples.front().device_ms), max_device(min_device);
+    for (auto& sample : _samples)
+    {
+        mean_device += sample.device_ms;
+        mean_host += sample.host_ns;
+        min_device = std::min(min_device, sample.device_ms);
+        max_device = std::max(max_device, sample.device_ms);
+    }
+    mean_device /= _samples.size();
+    mean_host /= _samples.size();
+
+    double slope(NS_PER_MS);
+    if (max_device - min_device >= MIN_FIT_SPAN_MS)
+    {
+        double covariance(0), variance(0);
+        for (auto& sample : _samples)
+        {
+            covariance += (sample.device_ms - mean_device) * (sample.host_ns - mean_host);
+            variance += (sample.device_ms - mean_device) * (sample.device_ms - mean_device);
+        }
+        slope = std::min(std::max(covariance / variance, NS_PER_MS * (1 - MAX_SKEW)), NS_PER_MS * (1 + MAX_SKEW));
+    }
+    _slope_ns_per_ms = slope;
+    _intercept_ns = mean_host - slope * mean_device;
+}
@@ -0,0 +1,89 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <coalescing_queue.h>
+#include <algorithm>
+#include <exception>
+
+using namespace realsense2_camera;
+
+CoalescingQueue::~CoalescingQueue()
+{
+    // The updates never applied fail
+    for (auto& queued_update : _updates)
+        setResults(queued_update, false);
+}
+
+std::shared_future<bool> CoalescingQueue::push(const std::string& name, Update update)
+{
+    auto result = std::make_shared<std::promise<bool> >();
+    std::shared_future<bool> future(result->get_future().share());
+
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    QueuedUpdate queued_update{name, update, {}};
+    auto replaced = std::find_if(_updates.begin(), _updates.end(), [&name](const QueuedUpdate& u){ return u.name == name; });
+    if (replaced != _updates.end())
+    {
+        queued_update.results.swap(replaced->results);
+        _updates.erase(replaced);
+    }
+    queued_update.results.push_back(result);
+    _updates.push_back(std::move(queued_update));
+    return future;
+}
+
+bool CoalescingQueue::empty() const
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _updates.empty();
+}
+
+CoalescingQueue::Batch CoalescingQueue::takeAll()
+{
+    Batch batch;
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    batch.swap(_updates);
+    return batch;
+}
+
+void CoalescingQueue::apply(Batch& batch, ErrorCallback on_error)
+{
+    for (auto& queued_update : batch)
+    {
+        bool result(true);
+        try
+        {
+            queued_update.update();
+        }
+        catch(const std::exception& e)
+        {
+            result = false;
+            if (on_error) on_error(queued_update.name, e.what());
+        }
+        catch(...)
+        {
+            result = false;
+            if (on_error) on_error(queued_update.name, "unknown exception");
+        }
+        setResults(queued_update, result);
+    }
+    batch.clear();
+}
+
+void CoalescingQueue::setResults(QueuedUpdate& queued_update, bool result)
+{
+    for (auto& promise : queued_update.results)
+        promise->set_value(result);
+    queued_update.results.clear();
+}
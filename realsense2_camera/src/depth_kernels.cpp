@@ -0,0 +1,282 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <depth_kernels.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RS2_DEPTH_KERNELS_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__)
+// AVX2 is compiled per function and selected at runtime, so the package still runs on any x86-64.
+#define RS2_DEPTH_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#if defined(__aarch64__)
+#define RS2_DEPTH_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace realsense2_camera;
+
+namespace
+{
+    // Scaling is done in float, with the same two operations as the original per pixel loop,
+    // so that all the kernels give the same results. Values above the uint16 range are saturated.
+    const float METER_TO_MM = 0.001f;
+    const float MAX_DEPTH_VALUE = 65535.0f;
+
+    inline uint16_t scalePixel(uint16_t value, float depth_scale_meters)
+    {
+        float scaled = static_cast<float>(value) * depth_scale_meters / METER_TO_MM;
+        return static_cast<uint16_t>(scaled < MAX_DEPTH_VALUE ? scaled : MAX_DEPTH_VALUE);
+    }
+
+    void scaleScalar(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = scalePixel(src[i], depth_scale_meters);
+    }
+
+    void clipScalar(const uint16_t* src, uint16_t* dst, size_t count, uint16_t clipping_value)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = (src[i] > clipping_value) ? 0 : src[i];
+    }
+
+    void scaleAndClipScalar(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters, uint16_t clipping_value)
+    {
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = (src[i] > clipping_value) ? 0 : scalePixel(src[i], depth_scale_meters);
+    }
+
+    const DepthKernels SCALAR_KERNELS = {"scalar", scaleScalar, clipScalar, scaleAndClipScalar};
+
+#ifdef RS2_DEPTH_KERNELS_SSE2
+    // 8 pixels per iteration.
+    inline __m128i scaleSSE2(__m128i pixels, __m128 scale, __m128 to_mm, __m128 max_value)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(pixels, zero));
+        __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(pixels, zero));
+        lo = _mm_min_ps(_mm_div_ps(_mm_mul_ps(lo, scale), to_mm), max_value);
+        hi = _mm_min_ps(_mm_div_ps(_mm_mul_ps(hi, scale), to_mm), max_value);
+        // SSE2 has no unsigned 32 to 16 bit pack: shift to the signed range, pack with saturation and shift back.
+        const __m128i bias32 = _mm_set1_epi32(0x8000);
+        const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+        __m128i lo_i = _mm_sub_epi32(_mm_cvttps_epi32(lo), bias32);
+        __m128i hi_i = _mm_sub_epi32(_mm_cvttps_epi32(hi), bias32);
+        return _mm_xor_si128(_mm_packs_epi32(lo_i, hi_i), bias16);
+    }
+
+    // All ones where pixels <= clipping_value. SSE2 has no unsigned compare: a saturated subtraction is zero instead.
+    inline __m128i keepMaskSSE2(__m128i pixels, __m128i clipping_value)
+    {
+        return _mm_cmpeq_epi16(_mm_subs_epu16(pixels, clipping_value), _mm_setzero_si128());
+    }
+
+    void scaleSSE2(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters)
+    {
+        const __m128 scale = _mm_set1_ps(depth_scale_meters);
+        const __m128 to_mm = _mm_set1_ps(METER_TO_MM);
+        const __m128 max_value = _mm_set1_ps(MAX_DEPTH_VALUE);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), scaleSSE2(pixels, scale, to_mm, max_value));
+        }
+        scaleScalar(src + i, dst + i, count - i, depth_scale_meters);
+    }
+
+    void clipSSE2(const uint16_t* src, uint16_t* dst, size_t count, uint16_t clipping_value)
+    {
+        const __m128i clip = _mm_set1_epi16(static_cast<short>(clipping_value));
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(keepMaskSSE2(pixels, clip), pixels));
+        }
+        clipScalar(src + i, dst + i, count - i, clipping_value);
+    }
+
+    void scaleAndClipSSE2(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters, uint16_t clipping_value)
+    {
+        const __m128 scale = _mm_set1_ps(depth_scale_meters);
+        const __m128 to_mm = _mm_set1_ps(METER_TO_MM);
+        const __m128 max_value = _mm_set1_ps(MAX_DEPTH_VALUE);
+        const __m128i clip = _mm_set1_epi16(static_cast<short>(clipping_value));
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i scaled = scaleSSE2(pixels, scale, to_mm, max_value);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(keepMaskSSE2(pixels, clip), scaled));
+        }
+        scaleAndClipScalar(src + i, dst + i, count - i, depth_scale_meters, clipping_value);
+    }
+
+    const DepthKernels SSE2_KERNELS = {"sse2", scaleSSE2, clipSSE2, scaleAndClipSSE2};
+#endif
+
+#ifdef RS2_DEPTH_KERNELS_AVX2
+#define RS2_TARGET_AVX2 __attribute__((target("avx2")))
+
+    // 16 pixels per iteration.
+    RS2_TARGET_AVX2 inline __m256i scaleAVX2(__m256i pixels, __m256 scale, __m256 to_mm, __m256 max_value)
+    {
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(pixels)));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(pixels, 1)));
+        lo = _mm256_min_ps(_mm256_div_ps(_mm256_mul_ps(lo, scale), to_mm), max_value);
+        hi = _mm256_min_ps(_mm256_div_ps(_mm256_mul_ps(hi, scale), to_mm), max_value);
+        // packus works per 128 bit lane: restore the pixel order afterwards.
+        __m256i packed = _mm256_packus_epi32(_mm256_cvttps_epi32(lo), _mm256_cvttps_epi32(hi));
+        return _mm256_permute4x64_epi64(packed, 0xD8);
+    }
+
+    // All ones where pixels <= clipping_value, that is where max(pixels, clipping_value) == clipping_value.
+    RS2_TARGET_AVX2 inline __m256i keepMaskAVX2(__m256i pixels, __m256i clipping_value)
+    {
+        return _mm256_cmpeq_epi16(_mm256_max_epu16(pixels, clipping_value), clipping_value);
+    }
+
+    RS2_TARGET_AVX2 void scaleAVX2(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters)
+    {
+        const __m256 scale = _mm256_set1_ps(depth_scale_meters);
+        const __m256 to_mm = _mm256_set1_ps(METER_TO_MM);
+        const __m256 max_value = _mm256_set1_ps(MAX_DEPTH_VALUE);
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), scaleAVX2(pixels, scale, to_mm, max_value));
+        }
+        scaleScalar(src + i, dst + i, count - i, depth_scale_meters);
+    }
+
+    RS2_TARGET_AVX2 void clipAVX2(const uint16_t* src, uint16_t* dst, size_t count, uint16_t clipping_value)
+    {
+        const __m256i clip = _mm256_set1_epi16(static_cast<short>(clipping_value));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(keepMaskAVX2(pixels, clip), pixels));
+        }
+        clipScalar(src + i, dst + i, count - i, clipping_value);
+    }
+
+    RS2_TARGET_AVX2 void scaleAndClipAVX2(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters, uint16_t clipping_value)
+    {
+        const __m256 scale = _mm256_set1_ps(depth_scale_meters);
+        const __m256 to_mm = _mm256_set1_ps(METER_TO_MM);
+        const __m256 max_value = _mm256_set1_ps(MAX_DEPTH_VALUE);
+        const __m256i clip = _mm256_set1_epi16(static_cast<short>(clipping_value));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i scaled = scaleAVX2(pixels, scale, to_mm, max_value);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(keepMaskAVX2(pixels, clip), scaled));
+        }
+        scaleAndClipScalar(src + i, dst + i, count - i, depth_scale_meters, clipping_value);
+    }
+
+    const DepthKernels AVX2_KERNELS = {"avx2", scaleAVX2, clipAVX2, scaleAndClipAVX2};
+
+    bool cpuSupportsAVX2()
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+
+#ifdef RS2_DEPTH_KERNELS_NEON
+    // 8 pixels per iteration. NEON is part of the aarch64 baseline: no runtime check needed.
+    inline uint16x8_t scaleNEON(uint16x8_t pixels, float32x4_t scale, float32x4_t to_mm, float32x4_t max_value)
+    {
+        float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(pixels)));
+        float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(pixels)));
+        lo = vminq_f32(vdivq_f32(vmulq_f32(lo, scale), to_mm), max_value);
+        hi = vminq_f32(vdivq_f32(vmulq_f32(hi, scale), to_mm), max_value);
+        return vcombine_u16(vqmovn_u32(vcvtq_u32_f32(lo)), vqmovn_u32(vcvtq_u32_f32(hi)));
+    }
+
+    void scaleNEON(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters)
+    {
+        const float32x4_t scale = vdupq_n_f32(depth_scale_meters);
+        const float32x4_t to_mm = vdupq_n_f32(METER_TO_MM);
+        const float32x4_t max_value = vdupq_n_f32(MAX_DEPTH_VALUE);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            vst1q_u16(dst + i, scaleNEON(vld1q_u16(src + i), scale, to_mm, max_value));
+        scaleScalar(src + i, dst + i, count - i, depth_scale_meters);
+    }
+
+    void clipNEON(const uint16_t* src, uint16_t* dst, size_t count, uint16_t clipping_value)
+    {
+        const uint16x8_t clip = vdupq_n_u16(clipping_value);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            uint16x8_t pixels = vld1q_u16(src + i);
+            vst1q_u16(dst + i, vandq_u16(pixels, vcleq_u16(pixels, clip)));
+        }
+        clipScalar(src + i, dst + i, count - i, clipping_value);
+    }
+
+    void scaleAndClipNEON(const uint16_t* src, uint16_t* dst, size_t count, float depth_scale_meters, uint16_t clipping_value)
+    {
+        const float32x4_t scale = vdupq_n_f32(depth_scale_meters);
+        const float32x4_t to_mm = vdupq_n_f32(METER_TO_MM);
+        const float32x4_t max_value = vdupq_n_f32(MAX_DEPTH_VALUE);
+        const uint16x8_t clip = vdupq_n_u16(clipping_value);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            uint16x8_t pixels = vld1q_u16(src + i);
+            uint16x8_t scaled = scaleNEON(pixels, scale, to_mm, max_value);
+            vst1q_u16(dst + i, vandq_u16(scaled, vcleq_u16(pixels, clip)));
+        }
+        scaleAndClipScalar(src + i, dst + i, count - i, depth_scale_meters, clipping_value);
+    }
+
+    const DepthKernels NEON_KERNELS = {"neon", scaleNEON, clipNEON, scaleAndClipNEON};
+#endif
+}
+
+std::vector<const DepthKernels*> realsense2_camera::getSupportedDepthKernels()
+{
+    std::vector<const DepthKernels*> kernels;
+    kernels.push_back(&SCALAR_KERNELS);
+#ifdef RS2_DEPTH_KERNELS_SSE2
+    kernels.push_back(&SSE2_KERNELS);
+#endif
+#ifdef RS2_DEPTH_KERNELS_AVX2
+    if (cpuSupportsAVX2())
+        kernels.push_back(&AVX2_KERNELS);
+#endif
+#ifdef RS2_DEPTH_KERNELS_NEON
+    kernels.push_back(&NEON_KERNELS);
+#endif
+    return kernels;
+}
+
+const DepthKernels& realsense2_camera::getDepthKernels()
+{
+    static const DepthKernels* kernels = getSupportedDepthKernels().back();
+    return *kernels;
+}
@@ -0,0 +1,213 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <device_registry.h>
+#include <constants.h>
+
+using namespace realsense2_camera;
+
+std::shared_ptr<DeviceRegistry> DeviceRegistry::getInstance()
+{
+    static std::mutex instance_mutex;
+    static std::weak_ptr<DeviceRegistry> instance;
+    std::lock_guard<std::mutex> lock_guard(instance_mutex);
+    std::shared_ptr<DeviceRegistry> registry = instance.lock();
+    if (!registry)
+    {
+        registry.reset(new DeviceRegistry());
+        instance = registry;
+    }
+    return registry;
+}
+
+DeviceRegistry::DeviceRegistry() :
+    _logger(rclcpp::get_logger("realsense2_camera")),
+    _next_client_id(0),
+    _is_running(true),
+    _is_query_needed(false),
+    _last_reset_time(std::chrono::steady_clock::now() - std::chrono::hours(1))
+{
+    _ctx.set_devices_changed_callback([this](rs2::event_information& info){changeDeviceCallback(info);});
+    _discovery_thread = std::thread([this](){discover();});
+}
+
+DeviceRegistry::~DeviceRegistry()
+{
+    _ctx.set_devices_changed_callback([](rs2::event_information&){});
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        _is_running = false;
+    }
+    _cv_discovery.notify_one();
+    if (_discovery_thread.joinable())
+        _discovery_thread.join();
+}
+
+size_t DeviceRegistry::addClient(DeviceMatcher matcher, DeviceCallback on_device, RemovedCallback on_removed)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    size_t client_id = _next_client_id++;
+    _clients[client_id] = Client{matcher, on_device, on_removed, rs2::device(), "", false};
+    _is_query_needed = true;
+    _cv_discovery.notify_one();
+    return client_id;
+}
+
+void DeviceRegistry::removeClient(size_t client_id)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _clients.erase(client_id);
+}
+
+void DeviceRegistry::releaseDevice(size_t client_id)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    auto client = _clients.find(client_id);
+    if (client == _clients.end())
+        return;
+    client->second.device = rs2::device();
+    client->second.serial_no.clear();
+    client->second.is_resetting = false;
+    _is_query_needed = true;
+    _cv_discovery.notify_one();
+}
+
+void DeviceRegistry::hardwareReset(size_t client_id, rs2::device device, double stagger_seconds)
+{
+    std::lock_guard<std::mutex> reset_lock_guard(_reset_mutex);
+    std::this_thread::sleep_until(_last_reset_time +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(stagger_seconds)));
+    {
+        // The device stays given to the client until it is removed, so that it isn't given again before the reset
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        auto client = _clients.find(client_id);
+        if (client != _clients.end())
+            client->second.is_resetting = true;
+    }
+    try
+    {
+        ROS_INFO_STREAM("Resetting device " << device.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER) << "...");
+        device.hardware_reset();
+        _last_reset_time = std::chrono::steady_clock::now();
+    }
+    catch(const std::exception& ex)
+    {
+        ROS_WARN_STREAM("An exception has been thrown: " << __FILE__ << ":" << __LINE__ << ":" << ex.what());
+        _last_reset_time = std::chrono::steady_clock::now();
+        releaseDevice(client_id);
+    }
+}
+
+void DeviceRegistry::changeDeviceCallback(rs2::event_information& info)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    for (auto& client : _clients)
+    {
+        if (client.second.device && info.was_removed(client.second.device))
+        {
+            bool is_resetting = client.second.is_resetting;
+            client.second.device = rs2::device();
+            client.second.serial_no.clear();
+            client.second.is_resetting = false;
+            if (!is_resetting)
+                client.second.on_removed();
+        }
+    }
+    if (info.get_new_devices().size() > 0)
+    {
+        _is_query_needed = true;
+        _cv_discovery.notify_one();
+    }
+}
+
+void DeviceRegistry::discover()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_is_running)
+    {
+        _cv_discovery.wait(lock, [this]{return !_is_running || _is_query_needed;});
+        if (!_is_running)
+            break;
+        _is_query_needed = false;
+        bool is_device_wanted(false);
+        for (auto& client : _clients)
+            is_device_wanted = is_device_wanted || !client.second.device;
+        if (!is_device_wanted)
+            continue;
+
+        // Queried without the lock, so that removals and new clients are not held back by the USB enumeration
+        lock.unlock();
+        try
+        {
+            rs2::device_list list = _ctx.query_devices();
+            lock.lock();
+            assignDevices(list);
+        }
+        catch(const std::exception& e)
+        {
+            if (!lock.owns_lock())
+                lock.lock();
+            ROS_ERROR_STREAM("Error querying the devices: " << e.what());
+        }
+    }
+}
+
+void DeviceRegistry::assignDevices(rs2::device_list list)
+{
+    if (0 == list.size())
+    {
+        ROS_WARN("No RealSense devices were found!");
+        return;
+    }
+    for (size_t count = 0; count < list.size(); count++)
+    {
+        rs2::device dev;
+        std::string serial_no;
+        try
+        {
+            dev = list[count];
+            serial_no = dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
+        }
+        catch(const std::exception& ex)
+        {
+            ROS_WARN_STREAM("Device " << count+1 << "/" << list.size() << " failed with exception: " << ex.what());
+            continue;
+        }
+        bool is_taken(false);
+        for (auto& client : _clients)
+            is_taken = is_taken || (client.second.device && client.second.serial_no == serial_no);
+        if (is_taken)
+            continue;
+        for (auto& client : _clients)
+        {
+            if (client.second.device)
+                continue;
+            try
+            {
+                if (!client.second.matcher(dev))
+                    continue;
+            }
+            catch(const std::exception& ex)
+            {
+                ROS_WARN_STREAM("Device " << serial_no << " failed with exception: " << ex.what());
+                break;
+            }
+            client.second.device = dev;
+            client.second.serial_no = serial_no;
+            client.second.is_resetting = false;
+            client.second.on_device(dev);
+            break;
+        }
+    }
+}
@@ -16,6 +16,18 @@
 
 namespace realsense2_camera
 {
+    namespace
+    {
+        // Set while setParam() applies a launch value through the parameter callback, on the registering thread
+        thread_local int registering_params_count(0);
+
+        struct RegisteringParam
+        {
+            RegisteringParam() { ++registering_params_count; }
+            ~RegisteringParam() { --registering_params_count; }
+        };
+    }
+
     Parameters::Parameters(rclcpp::Node& node) :
     _node(node),
     _logger(node.get_logger()),
@@ -64,22 +76,64 @@ namespace realsense2_camera
     // This function is used by the parameter callback function to update other ros parameters.
     void Parameters::pushUpdateFunctions(std::vector<std::function<void()> > funcs)
     {
+        std::lock_guard<std::mutex> lock_guard(_mu);
         _update_functions_v.insert(_update_functions_v.end(), funcs.begin(), funcs.end());
         _update_functions_cv.notify_one();
     }
 
+    std::shared_future<bool> Parameters::queueSetOption(const std::string& param_name, std::function<void()> set_option)
+    {
+        if (registering_params_count > 0)
+        {
+            // A launch value is written while it is registered, before the sensor starts:
+            // some options can only be set while not streaming. An error is thrown to setParam().
+            std::promise<bool> written;
+            set_option();
+            written.set_value(true);
+            return written.get_future().share();
+        }
+        std::shared_future<bool> result(_option_writes.push(param_name, set_option));
+        std::lock_guard<std::mutex> lock_guard(_mu);
+        _update_functions_cv.notify_one();
+        return result;
+    }
+
+    // monitor_update_functions:
+    // Once an update is queued, the updates queued within PARAMETERS_UPDATE_TICK are applied together:
+    // the device writes first, so that the update functions read the written values, e.g. the exposure echoed
+    // when the sequence_id changes, then the update functions and last the parameters server values.
     void Parameters::monitor_update_functions()
     {
-        int time_interval(1000);
-        std::function<void()> func = [this, time_interval](){
+        std::function<void()> func = [this](){
             std::unique_lock<std::mutex> lock(_mu);
             while(_is_running) {
-                _update_functions_cv.wait_for(lock, std::chrono::milliseconds(time_interval), [&]{return !_is_running || !_update_functions_v.empty();});
-                while (!_update_functions_v.empty())
+                _update_functions_cv.wait(lock, [&]{return !_is_running || !_update_functions_v.empty() || !_ros_values.empty() || !_option_writes.empty();});
+                _update_functions_cv.wait_for(lock, std::chrono::duration<double>(PARAMETERS_UPDATE_TICK), [&]{return !_is_running;});
+                if (!_is_running)
+                    break;
+
+                lock.unlock();
+                CoalescingQueue::Batch option_writes(_option_writes.takeAll());
+                CoalescingQueue::apply(option_writes, [this](const std::string& param_name, const std::string& error)
                 {
-                    _update_functions_v.front()();
-                    _update_functions_v.pop_front();
+                    ROS_WARN_STREAM("Set parameter {" << param_name << "} failed: " << error);
+                });
+                lock.lock();
+
+                std::deque<std::function<void()> > update_functions;
+                update_functions.swap(_update_functions_v);
+                lock.unlock();
+                for (auto& update_function : update_functions)
+                {
+                    update_function();
                 }
+                lock.lock();
+
+                std::vector<rclcpp::Parameter> ros_values;
+                ros_values.swap(_ros_values);
+                lock.unlock();
+                setRosParamValues(ros_values);
+                lock.lock();
             }
         };
         _update_functions_t = std::make_shared<std::thread>(func);
@@ -87,7 +141,11 @@ namespace realsense2_camera
 
     Parameters::~Parameters()
     {
-        _is_running = false;
+        {
+            std::lock_guard<std::mutex> lock_guard(_mu);
+            _is_running = false;
+        }
+        _update_functions_cv.notify_one();
         if (_update_functions_t && _update_functions_t->joinable())
             _update_functions_t->join();
         for (auto const& param : _param_functions)
@@ -153,6 +211,7 @@ namespace realsense2_camera
         {
             try
             {
+                RegisteringParam registering_param;
                 func(rclcpp::Parameter(param_name, result_value));
             }
             catch(const std::exception& e)
@@ -248,16 +307,82 @@ namespace realsense2_camera
         }
     }
 
-    // queueSetRosValue - Set parameter in queue to be pushed to ROS parameter by monitor_update_functions
+    // setRosParamValues - As setRosParamValue, for several parameters set by a single call.
+    void Parameters::setRosParamValues(const std::vector<rclcpp::Parameter>& parameters)
+    {
+        std::vector<rclcpp::Parameter> declared_parameters;
+        for (auto& parameter : parameters)
+        {
+            // The parameters of a sensor are removed with it
+            if (_node.has_parameter(parameter.get_name()))
+            {
+                declared_parameters.push_back(parameter);
+                self_set_parameters.push_back(parameter.get_name());
+                ROS_DEBUG_STREAM("Set " << parameter.get_name() << " to " << parameter.value_to_string());
+            }
+        }
+        if (declared_parameters.empty())
+            return;
+
+        std::vector<rcl_interfaces::msg::SetParametersResult> results;
+        try
+        {
+            results = _node.set_parameters(declared_parameters);
+        }
+        catch(const std::exception& e)
+        {
+            ROS_WARN_STREAM("Parameters were not set: " << e.what());
+        }
+        for (size_t i = 0; i < declared_parameters.size(); ++i)
+        {
+            if (i < results.size() && results[i].successful)
+                continue;
+            if (i < results.size())
+                ROS_WARN_STREAM("Parameter: " << declared_parameters[i].get_name() << " was not set:" << results[i].reason);
+            auto name_iter(std::find(self_set_parameters.begin(), self_set_parameters.end(), declared_parameters[i].get_name()));
+            if (name_iter != self_set_parameters.end())
+                self_set_parameters.erase(name_iter);
+        }
+    }
+
+    // queueSetRosValue - Set parameter in queue to be pushed to ROS parameter by monitor_update_functions.
+    // A value queued again before it is pushed replaces the previous one.
     template <class T>
     void Parameters::queueSetRosValue(const std::string& param_name, const T value)
     {
-        std::vector<std::function<void()> > funcs;
-        funcs.push_back([this, param_name, value](){setRosParamValue(param_name, &value);});
-        pushUpdateFunctions(funcs);
+        std::lock_guard<std::mutex> lock_guard(_mu);
+        _ros_values.erase(std::remove_if(_ros_values.begin(), _ros_values.end(),
+                                         [&param_name](const rclcpp::Parameter& p){ return p.get_name() == param_name; }),
+                          _ros_values.end());
+        _ros_values.push_back(rclcpp::Parameter(param_name, value));
+        _update_functions_cv.notify_one();
     }
 
 
+    // restoreParamValues - The parameters callback is called by set_parameter() on this thread: the device writes
+    // are applied before it returns, as for the launch values, and not by the update thread later on.
+    void Parameters::restoreParamValues(const std::vector<rclcpp::Parameter>& parameters)
+    {
+        for (auto& parameter : parameters)
+        {
+            if (!_node.has_parameter(parameter.get_name()) || _node.get_parameter(parameter.get_name()) == parameter)
+                continue;
+            try
+            {
+                RegisteringParam registering_param;
+                rcl_interfaces::msg::SetParametersResult result = _node.set_parameter(parameter);
+                if (!result.successful)
+                {
+                    ROS_WARN_STREAM("Failed to restore parameter " << parameter.get_name() << ": " << result.reason);
+                }
+            }
+            catch(const std::exception& e)
+            {
+                ROS_WARN_STREAM("Failed to restore parameter " << parameter.get_name() << ": " << e.what());
+            }
+        }
+    }
+
     void Parameters::removeParam(std::string param_name)
     {
         if (_node.has_parameter(param_name))
@@ -282,6 +407,8 @@ namespace realsense2_camera
 
     template void Parameters::queueSetRosValue<std::string>(const std::string& param_name, const std::string value);
     template void Parameters::queueSetRosValue<int>(const std::string& param_name, const int value);
+    template void Parameters::queueSetRosValue<bool>(const std::string& param_name, const bool value);
+    template void Parameters::queueSetRosValue<double>(const std::string& param_name, const double value);
 
     template int Parameters::readAndDeleteParam<int>(std::string param_name, const int& initial_value);
 }
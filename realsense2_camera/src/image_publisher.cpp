@@ -16,14 +16,26 @@
 
 using namespace realsense2_camera;
 
+// --- image_publisher implementation ---
+bool image_publisher::fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func )
+{
+    sensor_msgs::msg::Image::UniquePtr image_ptr( new sensor_msgs::msg::Image() );
+    if( ! fill_func( *image_ptr ) )
+        return false;
+    publish( std::move( image_ptr ) );
+    return true;
+}
+
 // --- image_rcl_publisher implementation ---
 image_rcl_publisher::image_rcl_publisher( rclcpp::Node & node,
                                           const std::string & topic_name,
-                                          const rmw_qos_profile_t & qos )
+                                          const rmw_qos_profile_t & qos,
+                                          bool use_loaned_messages )
 {
     image_publisher_impl = node.create_publisher< sensor_msgs::msg::Image >(
         topic_name,
         rclcpp::QoS( rclcpp::QoSInitialization::from_rmw( qos ), qos ) );
+    loan_messages = use_loaned_messages && image_publisher_impl->can_loan_messages();
 }
 
 void image_rcl_publisher::publish( sensor_msgs::msg::Image::UniquePtr image_ptr )
@@ -31,6 +43,19 @@ void image_rcl_publisher::publish( sensor_msgs::msg::Image::UniquePtr image_ptr
     image_publisher_impl->publish( std::move( image_ptr ) );
 }
 
+bool image_rcl_publisher::fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func )
+{
+    if( ! loan_messages )
+        return image_publisher::fill_and_publish( fill_func );
+
+    // The message is filled in the middleware buffer. An unpublished loan is returned when it goes out of scope.
+    auto loaned_msg = image_publisher_impl->borrow_loaned_message();
+    if( ! fill_func( loaned_msg.get() ) )
+        return false;
+    image_publisher_impl->publish( std::move( loaned_msg ) );
+    return true;
+}
+
 size_t image_rcl_publisher::get_subscription_count() const
 {
     return image_publisher_impl->get_subscription_count();
@@ -49,7 +74,22 @@ void image_transport_publisher::publish( sensor_msgs::msg::Image::UniquePtr imag
     image_publisher_impl->publish( *image_ptr );
 }
 
+bool image_transport_publisher::fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func )
+{
+    auto image_ptr = message_pool.acquire();
+    if( ! fill_func( *image_ptr ) )
+        return false;
+    image_publisher_impl->publish( *image_ptr );
+    return true;
+}
+
 size_t image_transport_publisher::get_subscription_count() const
 {
     return image_publisher_impl->getNumSubscribers();
 }
+
+bool image_transport_publisher::get_message_pool_stats( MessagePoolStats & stats ) const
+{
+    stats = message_pool.getStats();
+    return true;
+}
@@ -0,0 +1,77 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <imu_batcher.h>
+#include <algorithm>
+#include <iterator>
+
+using namespace realsense2_camera;
+
+ImuBatcher::ImuBatcher(rclcpp::Publisher<realsense2_camera_msgs::msg::ImuBatch>::SharedPtr publisher, size_t batch_size, double batch_period) :
+    _publisher(publisher),
+    _batch_size(std::max<size_t>(batch_size, 1)),
+    _batch_period(rclcpp::Duration::from_nanoseconds(static_cast<int64_t>(batch_period * 1e9))),
+    _samples_count(0)
+{
+    _batch.samples.resize(_batch_size);
+    _unused_samples.reserve(_batch_size);
+}
+
+ImuBatcher::~ImuBatcher()
+{
+    flush();
+}
+
+void ImuBatcher::add(const sensor_msgs::msg::Imu& imu_msg)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    // The samples vector keeps its size: samples are copied over the ones of the previous batch.
+    if (_samples_count == _batch.samples.size())
+        _batch.samples.push_back(imu_msg);
+    else
+        _batch.samples[_samples_count] = imu_msg;
+    _samples_count++;
+
+    bool is_period_done = (_batch_period.nanoseconds() > 0) &&
+        (rclcpp::Time(imu_msg.header.stamp) - rclcpp::Time(_batch.samples.front().header.stamp) >= _batch_period);
+    if (_samples_count >= _batch_size || is_period_done)
+        publishBatch();
+}
+
+void ImuBatcher::flush()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    publishBatch();
+}
+
+void ImuBatcher::publishBatch()
+{
+    if (_samples_count == 0) return;
+
+    // A partial batch is published without its unused samples. They are moved aside and back rather than
+    // destroyed and constructed again, so that their frame_id strings keep their buffers.
+    auto unused_begin = _batch.samples.begin() + _samples_count;
+    _unused_samples.assign(std::make_move_iterator(unused_begin), std::make_move_iterator(_batch.samples.end()));
+    _batch.samples.erase(unused_begin, _batch.samples.end());
+    _batch.header = _batch.samples.back().header;
+    _publisher->publish(_batch);
+    _batch.samples.insert(_batch.samples.end(), std::make_move_iterator(_unused_samples.begin()), std::make_move_iterator(_unused_samples.end()));
+    _unused_samples.clear();
+    _samples_count = 0;
+}
+
+size_t ImuBatcher::getNumSubscribers() const
+{
+    return _publisher->get_subscription_count();
+}
@@ -0,0 +1,131 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <latency_stats.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace realsense2_camera;
+
+const int LatencyHistogram::SUB_BUCKETS_BITS;
+const int LatencyHistogram::BUCKETS_COUNT;
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+int LatencyHistogram::bucketIndex(uint64_t latency_ns)
+{
+    // Latencies below 2^SUB_BUCKETS_BITS have a bucket each. Above it, a bucket is the position of
+    // the most significant bit followed by the next SUB_BUCKETS_BITS bits.
+    const uint64_t sub_buckets(1 << SUB_BUCKETS_BITS);
+    if (latency_ns < sub_buckets)
+        return static_cast<int>(latency_ns);
+    int msb(63);
+    while (!(latency_ns >> msb))
+        --msb;
+    int shift = msb - SUB_BUCKETS_BITS;
+    int sub_bucket = static_cast<int>((latency_ns >> shift) & (sub_buckets - 1));
+    return ((shift + 1) << SUB_BUCKETS_BITS) + sub_bucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index)
+{
+    const int sub_buckets(1 << SUB_BUCKETS_BITS);
+    if (index < sub_buckets)
+        return index;
+    int shift = (index >> SUB_BUCKETS_BITS) - 1;
+    uint64_t lower_bound = static_cast<uint64_t>(sub_buckets + (index & (sub_buckets - 1))) << shift;
+    return lower_bound + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(int64_t latency_ns)
+{
+    uint64_t latency = latency_ns > 0 ? static_cast<uint64_t>(latency_ns) : 0;
+    _buckets[bucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+    uint64_t max_ns = _max_ns.load(std::memory_order_relaxed);
+    while (latency > max_ns && !_max_ns.compare_exchange_weak(max_ns, latency, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Summary LatencyHistogram::getSummary() const
+{
+    uint64_t buckets[BUCKETS_COUNT];
+    uint64_t count(0);
+    for (int i = 0; i < BUCKETS_COUNT; ++i)
+    {
+        buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+    uint64_t max_ns = _max_ns.load(std::memory_order_relaxed);
+
+    const double percentiles[] = {0.5, 0.95, 0.99};
+    double values_ms[] = {0, 0, 0};
+    if (count > 0)
+    {
+        int index(0);
+        uint64_t accumulated(buckets[0]);
+        for (int p = 0; p < 3; ++p)
+        {
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentiles[p] * count)));
+            while (accumulated < rank && index + 1 < BUCKETS_COUNT)
+                accumulated += buckets[++index];
+            values_ms[p] = std::min(bucketUpperBound(index), max_ns) * 1e-6;
+        }
+    }
+    return Summary{count, values_ms[0], values_ms[1], values_ms[2], max_ns * 1e-6};
+}
+
+void LatencyHistogram::reset()
+{
+    // Latencies recorded while resetting may be kept or lost.
+    for (int i = 0; i < BUCKETS_COUNT; ++i)
+        _buckets[i].store(0, std::memory_order_relaxed);
+    _max_ns.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram* LatencyStats::getHistogram(const std::string& stage, const std::string& stream)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    auto& histogram = _histograms[std::make_pair(stage, stream)];
+    if (!histogram)
+        histogram.reset(new LatencyHistogram());
+    return histogram.get();
+}
+
+std::vector<LatencyStats::Entry> LatencyStats::getEntries() const
+{
+    std::vector<Entry> entries;
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    for (auto& histogram : _histograms)
+    {
+        LatencyHistogram::Summary summary = histogram.second->getSummary();
+        if (summary.count > 0)
+            entries.push_back(Entry{histogram.first.first, histogram.first.second, summary});
+    }
+    return entries;
+}
+
+void LatencyStats::reset()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    for (auto& histogram : _histograms)
+        histogram.second->reset();
+}
+
+int64_t LatencyStats::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,82 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <multi_camera_syncer.h>
+
+using namespace realsense2_camera;
+
+std::shared_ptr<MultiCameraSyncer> MultiCameraSyncer::getInstance(const std::string& group, double tolerance_seconds, size_t queue_size)
+{
+    static std::mutex instances_mutex;
+    static std::map<std::string, std::weak_ptr<MultiCameraSyncer> > instances;
+    std::lock_guard<std::mutex> lock_guard(instances_mutex);
+    std::shared_ptr<MultiCameraSyncer> syncer = instances[group].lock();
+    if (!syncer)
+    {
+        syncer.reset(new MultiCameraSyncer(tolerance_seconds, queue_size));
+        instances[group] = syncer;
+    }
+    return syncer;
+}
+
+MultiCameraSyncer::MultiCameraSyncer(double tolerance_seconds, size_t queue_size) :
+    _syncer(static_cast<int64_t>(tolerance_seconds * 1e9), queue_size)
+{
+}
+
+void MultiCameraSyncer::addMember(const std::string& camera_name, MultiRGBDPublisher publisher)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _syncer.addMember(camera_name);
+    _publishers[camera_name] = publisher;
+}
+
+void MultiCameraSyncer::removeMember(const std::string& camera_name)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _syncer.removeMember(camera_name);
+    _publishers.erase(camera_name);
+}
+
+bool MultiCameraSyncer::isSubscribed()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    // All the publishers are on the same topic
+    return !_publishers.empty() && 0 != _publishers.begin()->second->get_subscription_count();
+}
+
+void MultiCameraSyncer::push(const std::string& camera_name, RGBDConstPtr msg)
+{
+    FrameGroupSyncer<RGBDConstPtr>::Group group;
+    MultiRGBDPublisher publisher;
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        if (!_syncer.push(camera_name, rclcpp::Time(msg->header.stamp).nanoseconds(), msg, group))
+            return;
+        publisher = _publishers.begin()->second;
+    }
+
+    // The images are copied once, into the unique message, without the lock
+    realsense2_camera_msgs::msg::MultiRGBD::UniquePtr multi_msg(new realsense2_camera_msgs::msg::MultiRGBD());
+    multi_msg->header.stamp = group.front().second->header.stamp;
+    for (auto& member : group)
+    {
+        if (rclcpp::Time(member.second->header.stamp) < rclcpp::Time(multi_msg->header.stamp))
+            multi_msg->header.stamp = member.second->header.stamp;
+        multi_msg->camera_names.push_back(member.first);
+        multi_msg->cameras.push_back(*member.second);
+    }
+    publisher->publish(std::move(multi_msg));
+}
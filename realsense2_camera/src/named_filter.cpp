@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <named_filter.h>
+#include <pointcloud_packing.h>
 #include <fstream>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 
@@ -73,11 +74,15 @@ rs2::frame NamedFilter::Process(rs2::frame frame)
 }
 
 
-PointcloudFilter::PointcloudFilter(std::shared_ptr<rs2::filter> filter, rclcpp::Node& node, std::shared_ptr<Parameters> parameters, rclcpp::Logger logger, bool is_enabled):
+PointcloudFilter::PointcloudFilter(std::shared_ptr<rs2::filter> filter, rclcpp::Node& node, std::shared_ptr<Parameters> parameters, rclcpp::Logger logger, bool is_enabled, bool use_loaned_messages):
     NamedFilter(filter, parameters, logger, is_enabled, false),
     _node(node),
-    _allow_no_texture_points(ALLOW_NO_TEXTURE_POINTS),
-    _ordered_pc(ORDERED_PC)
+    _settings{ALLOW_NO_TEXTURE_POINTS, ORDERED_PC, POINTCLOUD_NUM_THREADS, 0, 0, 0, 0, POINTCLOUD_STRIDE, POINTCLOUD_MIN_Z, POINTCLOUD_MAX_Z},
+    _encoding(POINTCLOUD_ENCODING),
+    _point_encoding(PointEncoding::FLOAT32),
+    _no_texture_warn_count(0),
+    _use_loaned_messages(use_loaned_messages),
+    _use_intra_process(node.get_node_options().use_intra_process_comms())
     {
         setParameters();
     }
@@ -85,13 +90,36 @@ PointcloudFilter::PointcloudFilter(std::shared_ptr<rs2::filter> filter, rclcpp::
 void PointcloudFilter::setParameters()
 {
     std::string module_name = create_graph_resource_name(rs2_to_ros(_filter->get_info(RS2_CAMERA_INFO_NAME)));
-    std::string param_name(module_name + "." + "allow_no_texture_points");
-    _params.getParameters()->setParamT(param_name, _allow_no_texture_points);
+    setSettingParam(module_name + "." + "allow_no_texture_points", &Settings::allow_no_texture_points);
+    setSettingParam(module_name + "." + std::string("ordered_pc"), &Settings::ordered_pc);
+    setSettingParam(module_name + "." + std::string("num_threads"), &Settings::num_threads);
+
+    std::string param_name(module_name + "." + std::string("encoding"));
+    rcl_interfaces::msg::ParameterDescriptor encoding_descriptor;
+    encoding_descriptor.description = "x, y, z fields encoding: float32, int16_mm (millimeters) or float16 (half floats in UINT16 fields)";
+    std::string encoding_name = _params.getParameters()->setParam<std::string>(param_name, POINTCLOUD_ENCODING, [this](const rclcpp::Parameter& parameter)
+            {
+                PointEncoding encoding;
+                if (parsePointEncoding(parameter.get_value<std::string>(), encoding))
+                {
+                    _encoding = parameter.get_value<std::string>();
+                    _point_encoding = encoding;
+                }
+                else
+                {
+                    ROS_ERROR_STREAM("Given value, " << parameter.get_value<std::string>() << " is unknown. Set ROS param back to: " << _encoding);
+                    _params.getParameters()->queueSetRosValue(parameter.get_name(), _encoding);
+                }
+            }, encoding_descriptor);
+    PointEncoding encoding;
+    if (parsePointEncoding(encoding_name, encoding))
+    {
+        _encoding = encoding_name;
+        _point_encoding = encoding;
+    }
     _parameters_names.push_back(param_name);
 
-    param_name = module_name + "." + std::string("ordered_pc");
-    _params.getParameters()->setParamT(param_name, _ordered_pc);
-    _parameters_names.push_back(param_name);
+    setROIParameters(module_name);
 
     param_name = module_name + "." + std::string("pointcloud_qos");
     rcl_interfaces::msg::ParameterDescriptor crnt_descriptor;
@@ -117,6 +145,56 @@ void PointcloudFilter::setParameters()
         });
 }
 
+void PointcloudFilter::setROIParameters(const std::string& module_name)
+{
+    // Applied while the message is filled, so they take effect on the next frame.
+    std::vector<std::pair<std::string, int Settings::*>> int_params = {{"roi_x", &Settings::roi_x}, {"roi_y", &Settings::roi_y},
+                                                                       {"roi_width", &Settings::roi_width}, {"roi_height", &Settings::roi_height}};
+    for (auto& int_param : int_params)
+    {
+        rcl_interfaces::msg::ParameterDescriptor crnt_descriptor;
+        crnt_descriptor.description = "Pixels. 0 width or height means up to the image edge";
+        crnt_descriptor.integer_range.push_back(rcl_interfaces::msg::IntegerRange().set__from_value(0).set__to_value(65535));
+        setSettingParam(module_name + "." + int_param.first, int_param.second, crnt_descriptor);
+    }
+
+    rcl_interfaces::msg::ParameterDescriptor stride_descriptor;
+    stride_descriptor.description = "Publish one pixel every stride pixels, in both directions";
+    stride_descriptor.integer_range.push_back(rcl_interfaces::msg::IntegerRange().set__from_value(1).set__to_value(64));
+    setSettingParam(module_name + "." + std::string("stride"), &Settings::stride, stride_descriptor);
+
+    std::vector<std::pair<std::string, double Settings::*>> z_params = {{"min_z", &Settings::min_z}, {"max_z", &Settings::max_z}};
+    for (auto& z_param : z_params)
+    {
+        rcl_interfaces::msg::ParameterDescriptor crnt_descriptor;
+        crnt_descriptor.description = "Meters. 0 means no limit";
+        crnt_descriptor.floating_point_range.push_back(rcl_interfaces::msg::FloatingPointRange().set__from_value(0.0).set__to_value(100.0));
+        setSettingParam(module_name + "." + z_param.first, z_param.second, crnt_descriptor);
+    }
+}
+
+// setSettingParam: as setParamT, for a member of _settings, which is only accessed under _settings_mutex.
+template <class T>
+void PointcloudFilter::setSettingParam(const std::string& param_name, T Settings::* setting, rcl_interfaces::msg::ParameterDescriptor descriptor)
+{
+    T value = _params.getParameters()->setParam<T>(param_name, getSettings().*setting, [this, setting](const rclcpp::Parameter& parameter)
+            {
+                std::lock_guard<std::mutex> lock_guard(_settings_mutex);
+                _settings.*setting = parameter.get_value<T>();
+            }, descriptor);
+    {
+        std::lock_guard<std::mutex> lock_guard(_settings_mutex);
+        _settings.*setting = value;
+    }
+    _parameters_names.push_back(param_name);
+}
+
+PointcloudFilter::Settings PointcloudFilter::getSettings()
+{
+    std::lock_guard<std::mutex> lock_guard(_settings_mutex);
+    return _settings;
+}
+
 void PointcloudFilter::setPublisher()
 {
     std::lock_guard<std::mutex> lock_guard(_mutex_publisher);
@@ -132,27 +210,26 @@ void PointcloudFilter::setPublisher()
     }
 }
 
-void reverse_memcpy(unsigned char* dst, const unsigned char* src, size_t n)
+size_t PointcloudFilter::getSubscriptionCount()
 {
-    size_t i;
-
-    for (i=0; i < n; ++i)
-        dst[n-1-i] = src[i];
-
+    std::lock_guard<std::mutex> lock_guard(_mutex_publisher);
+    return _pointcloud_publisher ? _pointcloud_publisher->get_subscription_count() : 0;
 }
 
 void PointcloudFilter::Publish(rs2::points pc, const rclcpp::Time& t, const rs2::frameset& frameset, const std::string& frame_id)
 {
+    rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pointcloud_publisher;
     {
         std::lock_guard<std::mutex> lock_guard(_mutex_publisher);
         if ((!_pointcloud_publisher) || (!(_pointcloud_publisher->get_subscription_count())))
             return;
+        pointcloud_publisher = _pointcloud_publisher;
     }
     rs2_stream texture_source_id = static_cast<rs2_stream>(_filter->get_option(rs2_option::RS2_OPTION_STREAM_FILTER));
     bool use_texture = texture_source_id != RS2_STREAM_ANY;
-    static int warn_count(0);
     static const int DISPLAY_WARN_NUMBER(5);
     rs2::frameset::iterator texture_frame_itr = frameset.end();
+    rs2::video_frame texture_frame(rs2::frame{});
     if (use_texture)
     {
         std::set<rs2_format> available_formats{ rs2_format::RS2_FORMAT_RGB8, rs2_format::RS2_FORMAT_Y8 };
@@ -162,43 +239,112 @@ void PointcloudFilter::Publish(rs2::points pc, const rclcpp::Time& t, const rs2:
                                             (available_formats.find(f.get_profile().format()) != available_formats.end()); });
         if (texture_frame_itr == frameset.end())
         {
-            warn_count++;
+            int count = ++_no_texture_warn_count;
             std::string texture_source_name = _filter->get_option_value_description(rs2_option::RS2_OPTION_STREAM_FILTER, static_cast<float>(texture_source_id));
-            ROS_WARN_STREAM_COND(warn_count == DISPLAY_WARN_NUMBER, "No stream match for pointcloud chosen texture " << texture_source_name);
+            ROS_WARN_STREAM_COND(count == DISPLAY_WARN_NUMBER, "No stream match for pointcloud chosen texture " << texture_source_name);
             return;
         }
-        warn_count = 0;
+        _no_texture_warn_count = 0;
+        texture_frame = (*texture_frame_itr).as<rs2::video_frame>();
     }
 
-    int texture_width(0), texture_height(0);
-    int num_colors(0);
+    // Middleware loaned messages, if the RMW can loan PointCloud2 (the current RMWs only loan fixed size types)
+    if (_use_loaned_messages && pointcloud_publisher->can_loan_messages())
+    {
+        auto loaned_msg = pointcloud_publisher->borrow_loaned_message();
+        fillPointCloudMsg(loaned_msg.get(), pc, texture_frame, t, frame_id);
+        pointcloud_publisher->publish(std::move(loaned_msg));
+    }
+    else if (_use_intra_process)
+    {
+        sensor_msgs::msg::PointCloud2::UniquePtr msg_pointcloud = std::make_unique<sensor_msgs::msg::PointCloud2>();
+        fillPointCloudMsg(*msg_pointcloud, pc, texture_frame, t, frame_id);
+        pointcloud_publisher->publish(std::move(msg_pointcloud));
+    }
+    else
+    {
+        // Inter-process publishing only borrows the message, so its buffer is reused for the next frame
+        auto msg_pointcloud = _msg_pool.acquire();
+        fillPointCloudMsg(*msg_pointcloud, pc, texture_frame, t, frame_id);
+        pointcloud_publisher->publish(*msg_pointcloud);
+    }
+}
 
-    const rs2::vertex* vertex = pc.get_vertices();
-    const rs2::texture_coordinate* color_point = pc.get_texture_coordinates();
+bool PointcloudFilter::getMessagePoolStats(MessagePoolStats& stats) const
+{
+    if (_use_intra_process)
+        return false;
+    stats = _msg_pool.getStats();
+    return true;
+}
 
-    rs2_intrinsics depth_intrin = pc.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
+void PointcloudFilter::updateTaskPool(size_t threads_count)
+{
+    if (threads_count <= 1)
+        _task_pool.reset();
+    else if (!_task_pool || _task_pool->getThreadsCount() != threads_count)
+        _task_pool = std::make_shared<TaskPool>(threads_count);
+}
+
+void PointcloudFilter::fillPointCloudMsg(sensor_msgs::msg::PointCloud2& msg_pointcloud, rs2::points pc, const rs2::video_frame& texture_frame,
+                                         const rclcpp::Time& t, const std::string& frame_id)
+{
+    bool use_texture(texture_frame);
+    // The parameters may change from another thread, so they are read once.
+    const Settings settings(getSettings());
 
-    sensor_msgs::msg::PointCloud2::UniquePtr msg_pointcloud = std::make_unique<sensor_msgs::msg::PointCloud2>();
+    rs2_intrinsics depth_intrin = pc.get_profile().as<rs2::video_stream_profile>().get_intrinsics();
 
-    sensor_msgs::PointCloud2Modifier modifier(*msg_pointcloud);
-    modifier.setPointCloud2FieldsByString(1, "xyz");
-    modifier.resize(pc.size());
-    if (_ordered_pc)
+    // The published pixels, clamped to the image.
+    size_t image_width = std::max(depth_intrin.width, 0);
+    size_t image_height = std::min(static_cast<size_t>(std::max(depth_intrin.height, 0)), image_width ? pc.size() / image_width : 0);
+    size_t stride = std::max(settings.stride, 1);
+    size_t roi_x = std::min(static_cast<size_t>(std::max(settings.roi_x, 0)), image_width);
+    size_t roi_y = std::min(static_cast<size_t>(std::max(settings.roi_y, 0)), image_height);
+    size_t roi_width = (settings.roi_width > 0) ? std::min(static_cast<size_t>(settings.roi_width), image_width - roi_x) : image_width - roi_x;
+    size_t roi_height = (settings.roi_height > 0) ? std::min(static_cast<size_t>(settings.roi_height), image_height - roi_y) : image_height - roi_y;
+    size_t columns = (roi_width + stride - 1) / stride;
+    size_t rows = (roi_height + stride - 1) / stride;
+    bool allow_no_texture_points(settings.allow_no_texture_points), ordered_pc(settings.ordered_pc);
+    PointSelection selection;
+    selection.stride = stride;
+    if (settings.min_z > 0)
+        selection.min_z = static_cast<float>(settings.min_z);
+    if (settings.max_z > 0)
+        selection.max_z = static_cast<float>(settings.max_z);
+
+    PointEncoding encoding = _point_encoding;
+
+    sensor_msgs::PointCloud2Modifier modifier(msg_pointcloud);
+    if (encoding == PointEncoding::FLOAT32)
+    {
+        modifier.setPointCloud2FieldsByString(1, "xyz");
+    }
+    else
     {
-        msg_pointcloud->width = depth_intrin.width;
-        msg_pointcloud->height = depth_intrin.height;
-        msg_pointcloud->is_dense = false;
+        // Half floats have no PointField datatype: their bits are given as UINT16.
+        uint8_t datatype = (encoding == PointEncoding::INT16_MM) ? sensor_msgs::msg::PointField::INT16 : sensor_msgs::msg::PointField::UINT16;
+        msg_pointcloud.fields.clear();
+        int offset(0);
+        for (const char* name : {"x", "y", "z"})
+            offset = addPointField(msg_pointcloud, name, 1, datatype, offset);
+        msg_pointcloud.point_step = offset;
+    }
+    modifier.resize(rows * columns);
+    if (ordered_pc)
+    {
+        msg_pointcloud.width = columns;
+        msg_pointcloud.height = rows;
+        msg_pointcloud.is_dense = false;
     }
 
-    vertex = pc.get_vertices();
-    size_t valid_count(0);
+    PointcloudTexture texture{nullptr, 0, 0, 0};
     if (use_texture)
     {
-        rs2::video_frame texture_frame = (*texture_frame_itr).as<rs2::video_frame>();
-        texture_width = texture_frame.get_width();
-        texture_height = texture_frame.get_height();
-        num_colors = texture_frame.get_bytes_per_pixel();
-        uint8_t* color_data = (uint8_t*)texture_frame.get_data();
+        texture.data = static_cast<const uint8_t*>(texture_frame.get_data());
+        texture.width = texture_frame.get_width();
+        texture.height = texture_frame.get_height();
+        texture.bytes_per_pixel = texture_frame.get_bytes_per_pixel();
         std::string format_str;
         switch(texture_frame.get_profile().format())
         {
@@ -211,84 +357,99 @@ void PointcloudFilter::Publish(rs2::points pc, const rclcpp::Time& t, const rs2:
             default:
                 throw std::runtime_error("Unhandled texture format passed in pointcloud " + std::to_string(texture_frame.get_profile().format()));
         }
-        msg_pointcloud->point_step = addPointField(*msg_pointcloud, format_str.c_str(), 1, sensor_msgs::msg::PointField::FLOAT32, msg_pointcloud->point_step);
-        msg_pointcloud->row_step = msg_pointcloud->width * msg_pointcloud->point_step;
-        msg_pointcloud->data.resize(msg_pointcloud->height * msg_pointcloud->row_step);
-
-        sensor_msgs::PointCloud2Iterator<float>iter_x(*msg_pointcloud, "x");
-        sensor_msgs::PointCloud2Iterator<float>iter_y(*msg_pointcloud, "y");
-        sensor_msgs::PointCloud2Iterator<float>iter_z(*msg_pointcloud, "z");
-        sensor_msgs::PointCloud2Iterator<uint8_t>iter_color(*msg_pointcloud, format_str);
-        color_point = pc.get_texture_coordinates();
-
-        float color_pixel[2];
-        for (size_t point_idx=0; point_idx < pc.size(); point_idx++, vertex++, color_point++)
+        msg_pointcloud.point_step = addPointField(msg_pointcloud, format_str.c_str(), 1, sensor_msgs::msg::PointField::FLOAT32, msg_pointcloud.point_step);
+    }
+    msg_pointcloud.row_step = msg_pointcloud.width * msg_pointcloud.point_step;
+    msg_pointcloud.data.resize(msg_pointcloud.height * msg_pointcloud.row_step);
+
+    // The points are written straight into the message buffer, laid out as the encoding's points
+    // to match the fields set above.
+    const float* vertices = reinterpret_cast<const float*>(pc.get_vertices());
+    const float* texture_coordinates = reinterpret_cast<const float*>(pc.get_texture_coordinates());
+    uint8_t* data = msg_pointcloud.data.data();
+    // Bands are ranges of published rows. Each row of the ROI is packed on its own, as rows are not contiguous in the image.
+    auto first_point = [&](size_t row) { return (roi_y + row * stride) * image_width + roi_x; };
+    auto pack_band = [&](size_t row_begin, size_t row_end, size_t out_begin, size_t capacity)
+    {
+        size_t out(0);
+        for (size_t row = row_begin; row < row_end; ++row)
         {
-            float i(color_point->u);
-            float j(color_point->v);
-            bool valid_color_pixel(i >= 0.f && i <=1.f && j >= 0.f && j <=1.f);
-            bool valid_pixel(vertex->z > 0 && (valid_color_pixel || _allow_no_texture_points));
-            if (valid_pixel || _ordered_pc)
-            {
-                *iter_x = vertex->x;
-                *iter_y = vertex->y;
-                *iter_z = vertex->z;
-
-                if (valid_color_pixel)
-                {
-                    color_pixel[0] = i * texture_width;
-                    color_pixel[1] = j * texture_height;
-                    int pixx = static_cast<int>(color_pixel[0]);
-                    int pixy = static_cast<int>(color_pixel[1]);
-                    int offset = (pixy * texture_width + pixx) * num_colors;
-                    reverse_memcpy(&(*iter_color), color_data+offset, num_colors);  // PointCloud2 order of rgb is bgr.
-                }
-                ++iter_x; ++iter_y; ++iter_z;
-                ++iter_color;
-                ++valid_count;
-            }
+            size_t begin = first_point(row);
+            out += packEncodedPoints(encoding, vertices + 3 * begin, texture_coordinates + 2 * begin, columns, use_texture ? &texture : nullptr,
+                                     allow_no_texture_points, ordered_pc, data + (out_begin + out) * msg_pointcloud.point_step, capacity - out, selection);
         }
+        return out;
+    };
+    auto count_band = [&](size_t row_begin, size_t row_end)
+    {
+        size_t count(0);
+        for (size_t row = row_begin; row < row_end; ++row)
+        {
+            size_t begin = first_point(row);
+            count += use_texture ?
+                countValidTexturedPoints(vertices + 3 * begin, texture_coordinates + 2 * begin, columns, allow_no_texture_points, selection) :
+                countValidPoints(vertices + 3 * begin, columns, selection);
+        }
+        return count;
+    };
+
+    size_t bands_count = std::min(static_cast<size_t>(std::max(settings.num_threads, 1)), std::max(rows, static_cast<size_t>(1)));
+    updateTaskPool(bands_count);
+    size_t valid_count(0);
+    if (bands_count == 1)
+    {
+        valid_count = pack_band(0, rows, 0, rows * columns);
     }
     else
     {
-        msg_pointcloud->row_step = msg_pointcloud->width * msg_pointcloud->point_step;
-        msg_pointcloud->data.resize(msg_pointcloud->height * msg_pointcloud->row_step);
-
-        sensor_msgs::PointCloud2Iterator<float>iter_x(*msg_pointcloud, "x");
-        sensor_msgs::PointCloud2Iterator<float>iter_y(*msg_pointcloud, "y");
-        sensor_msgs::PointCloud2Iterator<float>iter_z(*msg_pointcloud, "z");
-
-        for (size_t point_idx=0; point_idx < pc.size(); point_idx++, vertex++)
+        size_t rows_per_band = (rows + bands_count - 1) / bands_count;
+        std::vector<size_t> band_begins(bands_count + 1, rows);
+        for (size_t band = 0; band < bands_count; ++band)
+            band_begins[band] = std::min(band * rows_per_band, rows);
+
+        std::vector<size_t> out_begins(bands_count + 1);
+        for (size_t band = 0; band <= bands_count; ++band)
+            out_begins[band] = band_begins[band] * columns;
+        std::vector<TaskPool::Task> tasks;
+        if (!ordered_pc)
         {
-            bool valid_pixel(vertex->z > 0);
-            if (valid_pixel || _ordered_pc)
+            // Every band is compacted right after the previous one, so their valid points are counted first.
+            std::vector<size_t> valid_counts(bands_count);
+            for (size_t band = 0; band < bands_count; ++band)
             {
-                *iter_x = vertex->x;
-                *iter_y = vertex->y;
-                *iter_z = vertex->z;
-
-                ++iter_x; ++iter_y; ++iter_z;
-                ++valid_count;
+                tasks.push_back([&, band]()
+                {
+                    valid_counts[band] = count_band(band_begins[band], band_begins[band + 1]);
+                });
             }
+            _task_pool->run(tasks);
+            tasks.clear();
+            out_begins[0] = 0;
+            for (size_t band = 0; band < bands_count; ++band)
+                out_begins[band + 1] = out_begins[band] + valid_counts[band];
         }
+        for (size_t band = 0; band < bands_count; ++band)
+        {
+            tasks.push_back([&, band]()
+            {
+                pack_band(band_begins[band], band_begins[band + 1], out_begins[band], out_begins[band + 1] - out_begins[band]);
+            });
+        }
+        _task_pool->run(tasks);
+        valid_count = out_begins[bands_count];
     }
-    msg_pointcloud->header.stamp = t;
-    msg_pointcloud->header.frame_id = frame_id;
-    if (!_ordered_pc)
+
+    msg_pointcloud.header.stamp = t;
+    msg_pointcloud.header.frame_id = frame_id;
+    if (!ordered_pc)
     {
-        msg_pointcloud->width = valid_count;
-        msg_pointcloud->height = 1;
-        msg_pointcloud->is_dense = true;
+        msg_pointcloud.width = valid_count;
+        msg_pointcloud.height = 1;
+        msg_pointcloud.is_dense = true;
         modifier.resize(valid_count);
     }
-    {
-        std::lock_guard<std::mutex> lock_guard(_mutex_publisher);
-        if (_pointcloud_publisher)
-            _pointcloud_publisher->publish(std::move(msg_pointcloud));
-    }
 }
 
-
 AlignDepthFilter::AlignDepthFilter(std::shared_ptr<rs2::filter> filter,
     std::function<void(const rclcpp::Parameter&)> update_align_depth_func,
     std::shared_ptr<Parameters> parameters, rclcpp::Logger logger, bool is_enabled):
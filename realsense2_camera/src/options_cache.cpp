@@ -0,0 +1,228 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <options_cache.h>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+using namespace realsense2_camera;
+
+// File format, one record per line, with tab separated fields:
+// realsense2_camera options cache <signature>
+// sensor <module name>
+// option <rs2_option> <min> <max> <step> <default> <description>
+// value  <value> <description>          (the enum values of the option above)
+namespace
+{
+    const std::string FILE_HEADER("realsense2_camera options cache");
+
+    std::string escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '\\')
+                escaped += "\\\\";
+            else if (c == '\t')
+                escaped += "\\t";
+            else if (c == '\n')
+                escaped += "\\n";
+            else if (c != '\r')
+                escaped += c;
+        }
+        return escaped;
+    }
+
+    std::string unescape(const std::string& text)
+    {
+        std::string unescaped;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == '\\' && i + 1 < text.size())
+            {
+                ++i;
+                unescaped += (text[i] == 't') ? '\t' : ((text[i] == 'n') ? '\n' : text[i]);
+            }
+            else
+                unescaped += text[i];
+        }
+        return unescaped;
+    }
+
+    std::vector<std::string> splitFields(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        size_t begin(0);
+        while (true)
+        {
+            size_t end = line.find('\t', begin);
+            fields.push_back(line.substr(begin, end - begin));
+            if (end == std::string::npos)
+                return fields;
+            begin = end + 1;
+        }
+    }
+
+    // Numbers are written and read in the classic locale, whatever the locale of the node is.
+    template<class T>
+    bool parseNumber(const std::string& text, T& value)
+    {
+        std::istringstream stream(text);
+        stream.imbue(std::locale::classic());
+        stream >> value;
+        return !stream.fail() && stream.eof();
+    }
+}
+
+bool OptionInfo::operator==(const OptionInfo& other) const
+{
+    return option == other.option &&
+           min == other.min && max == other.max && step == other.step && def == other.def &&
+           description == other.description &&
+           value_descriptions == other.value_descriptions;
+}
+
+OptionsCache::OptionsCache(const std::string& file_path, const std::string& signature) :
+    _file_path(file_path),
+    _signature(escape(signature))
+{
+}
+
+std::string OptionsCache::filePath(const std::string& cache_dir, const std::string& serial_no, const std::string& firmware_version)
+{
+    std::string file_name(serial_no + "_" + firmware_version + ".options");
+    for (char& c : file_name)
+    {
+        if (c == '/' || c == '\\' || c == ' ')
+            c = '_';
+    }
+    if (cache_dir.empty() || cache_dir.back() == '/')
+        return cache_dir + file_name;
+    return cache_dir + "/" + file_name;
+}
+
+bool OptionsCache::load()
+{
+    std::ifstream file(_file_path);
+    if (!file.is_open())
+        return false;
+    std::stringstream content;
+    content << file.rdbuf();
+    return parse(content.str());
+}
+
+bool OptionsCache::save() const
+{
+    const std::string temp_file_path(_file_path + ".tmp");
+    {
+        std::ofstream file(temp_file_path, std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file << serialize();
+        file.close();
+        if (file.fail())
+        {
+            std::remove(temp_file_path.c_str());
+            return false;
+        }
+    }
+    if (0 != std::rename(temp_file_path.c_str(), _file_path.c_str()))
+    {
+        std::remove(temp_file_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool OptionsCache::get(const std::string& module_name, SensorOptionsInfo& options) const
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    auto sensor = _sensors.find(module_name);
+    if (sensor == _sensors.end())
+        return false;
+    options = sensor->second;
+    return true;
+}
+
+void OptionsCache::set(const std::string& module_name, const SensorOptionsInfo& options)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _sensors[module_name] = options;
+}
+
+std::string OptionsCache::serialize() const
+{
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream.precision(std::numeric_limits<float>::max_digits10);     // the floats are read back exactly
+    stream << FILE_HEADER << '\t' << _signature << '\n';
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    for (auto& sensor : _sensors)
+    {
+        stream << "sensor\t" << escape(sensor.first) << '\n';
+        for (auto& info : sensor.second)
+        {
+            stream << "option\t" << info.option << '\t' << info.min << '\t' << info.max << '\t' << info.step << '\t' << info.def
+                   << '\t' << escape(info.description) << '\n';
+            for (auto& value : info.value_descriptions)
+                stream << "value\t" << value.first << '\t' << escape(value.second) << '\n';
+        }
+    }
+    return stream.str();
+}
+
+bool OptionsCache::parse(const std::string& content)
+{
+    std::map<std::string, SensorOptionsInfo> sensors;
+    SensorOptionsInfo* sensor(nullptr);
+    std::istringstream stream(content);
+    std::string line;
+    if (!std::getline(stream, line) || line != FILE_HEADER + '\t' + _signature)
+        return false;
+    while (std::getline(stream, line))
+    {
+        if (line.empty())
+            continue;
+        std::vector<std::string> fields = splitFields(line);
+        if (fields[0] == "sensor" && fields.size() == 2)
+        {
+            sensor = &sensors[unescape(fields[1])];
+        }
+        else if (fields[0] == "option" && fields.size() == 7 && sensor)
+        {
+            OptionInfo info;
+            if (!parseNumber(fields[1], info.option) ||
+                !parseNumber(fields[2], info.min) || !parseNumber(fields[3], info.max) ||
+                !parseNumber(fields[4], info.step) || !parseNumber(fields[5], info.def))
+                return false;
+            info.description = unescape(fields[6]);
+            sensor->push_back(info);
+        }
+        else if (fields[0] == "value" && fields.size() == 3 && sensor && !sensor->empty())
+        {
+            int value;
+            if (!parseNumber(fields[1], value))
+                return false;
+            sensor->back().value_descriptions.push_back(std::make_pair(value, unescape(fields[2])));
+        }
+        else
+            return false;
+    }
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _sensors.swap(sensors);
+    return true;
+}
@@ -0,0 +1,136 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <output_throttle.h>
+#include <algorithm>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    const double LATENCY_SMOOTHING(0.1);            // weight of the last frameset
+    const double OVERLOAD_RECOVERY_RATIO(0.8);
+    const int64_t RATE_TOLERANCE_DIVISOR(10);       // a frame a tenth of a period early is on time
+    const int64_t MAX_LATENCY_BUDGETS(2);           // the latency of a frameset counts for at most twice the budget
+}
+
+OutputThrottle::OutputThrottle(double latency_budget_seconds) :
+    _latency_budget_ns(static_cast<int64_t>(latency_budget_seconds * 1e9)),
+    _latency_ns(0),
+    _has_latency(false),
+    _is_overloaded(false)
+{
+}
+
+void OutputThrottle::setLatencyBudget(double latency_budget_seconds)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _latency_budget_ns = static_cast<int64_t>(latency_budget_seconds * 1e9);
+    _is_overloaded = _is_overloaded && _latency_budget_ns > 0;
+}
+
+void OutputThrottle::setOutput(unsigned int output, const Settings& settings)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    if (settings.max_rate <= 0 && settings.load_decimation <= 1)
+    {
+        _outputs.erase(output);
+        return;
+    }
+    Output& throttled = _outputs[output];
+    throttled.settings = settings;
+    throttled.has_next_time = false;
+    throttled.decimation_count = 0;
+}
+
+bool OutputThrottle::isEnabled()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return !_outputs.empty();
+}
+
+unsigned int OutputThrottle::filter(unsigned int demand, int64_t time_ns, int64_t latency_ns)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    if (latency_ns >= 0)
+    {
+        if (_latency_budget_ns > 0)
+            latency_ns = std::min(latency_ns, MAX_LATENCY_BUDGETS * _latency_budget_ns);
+        _latency_ns = _has_latency ? _latency_ns + LATENCY_SMOOTHING * (latency_ns - _latency_ns) : latency_ns;
+        _has_latency = true;
+    }
+    if (_latency_budget_ns > 0 && _has_latency)
+    {
+        if (_latency_ns > _latency_budget_ns)
+            _is_overloaded = true;
+        else if (_latency_ns < OVERLOAD_RECOVERY_RATIO * _latency_budget_ns)
+            _is_overloaded = false;
+    }
+
+    for (auto& item : _outputs)
+    {
+        if (!(demand & item.first))
+            continue;
+        Output& output = item.second;
+        if (output.settings.max_rate > 0)
+        {
+            const int64_t period_ns(static_cast<int64_t>(1e9 / output.settings.max_rate));
+            if (output.has_next_time && time_ns < output.next_time_ns - period_ns / RATE_TOLERANCE_DIVISOR)
+            {
+                ++output.stats.rate_limited;
+                demand &= ~item.first;
+                continue;
+            }
+            // On the period grid, unless the frames were late by more than a period (e.g. after a pause)
+            output.next_time_ns = (output.has_next_time && time_ns - output.next_time_ns < period_ns) ?
+                                  output.next_time_ns + period_ns : time_ns + period_ns;
+            output.has_next_time = true;
+        }
+        if (_is_overloaded && output.settings.load_decimation > 1)
+        {
+            if (0 != (output.decimation_count++ % output.settings.load_decimation))
+            {
+                ++output.stats.decimated;
+                demand &= ~item.first;
+                continue;
+            }
+        }
+        else
+            output.decimation_count = 0;
+        ++output.stats.computed;
+    }
+    return demand;
+}
+
+bool OutputThrottle::isOverloaded()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _is_overloaded;
+}
+
+double OutputThrottle::getLatencySeconds()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _latency_ns * 1e-9;
+}
+
+std::map<unsigned int, OutputThrottle::Stats> OutputThrottle::getStats()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    std::map<unsigned int, Stats> stats;
+    for (auto& output : _outputs)
+        stats[output.first] = output.second.stats;
+    return stats;
+}
@@ -32,6 +32,15 @@ void BaseRealSenseNode::getParameters()
     _publish_tf = _parameters->setParam<bool>(param_name, PUBLISH_TF);
     _parameters_names.push_back(param_name);
 
+    // Read before tf_publish_rate, which starts the dynamic transforms
+    param_name = std::string("tf_publish_on_change");
+    _tf_publish_on_change = _parameters->setParam<bool>(param_name, TF_PUBLISH_ON_CHANGE);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("tf_shared_timer");
+    _tf_shared_timer = _parameters->setParam<bool>(param_name, TF_SHARED_TIMER);
+    _parameters_names.push_back(param_name);
+
     param_name = std::string("tf_publish_rate");
     _parameters->setParamT(param_name, _tf_publish_rate, [this](const rclcpp::Parameter& )
             {
@@ -43,6 +52,10 @@ void BaseRealSenseNode::getParameters()
     _diagnostics_period = _parameters->setParam<double>(param_name, DIAGNOSTICS_PERIOD);
     _parameters_names.push_back(param_name);
 
+    param_name = std::string("profile_change_debounce");
+    _profile_change_debounce = _parameters->setParam<double>(param_name, PROFILE_CHANGE_DEBOUNCE);
+    _parameters_names.push_back(param_name);
+
     param_name = std::string("enable_sync");
     _parameters->setParamT(param_name, _sync_frames);
     _parameters_names.push_back(param_name);
@@ -58,10 +71,30 @@ void BaseRealSenseNode::getParameters()
     });
     _parameters_names.push_back(param_name);
 
+    param_name = std::string("multi_camera_sync_group");
+    _multi_camera_sync_group = _parameters->setParam<std::string>(param_name, MULTI_CAMERA_SYNC_GROUP);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("multi_camera_sync_tolerance");
+    _multi_camera_sync_tolerance = _parameters->setParam<double>(param_name, MULTI_CAMERA_SYNC_TOLERANCE);
+    _parameters_names.push_back(param_name);
+
     param_name = std::string("json_file_path");
     _json_file_path = _parameters->setParam<std::string>(param_name, "");
     _parameters_names.push_back(param_name);
 
+    param_name = std::string("options_cache_dir");
+    _options_cache_dir = _parameters->setParam<std::string>(param_name, "");
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("raw_record_dir");
+    _raw_record_dir = _parameters->setParam<std::string>(param_name, RAW_RECORD_DIR);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("raw_record_segment_size");
+    _raw_record_segment_size = _parameters->setParam<int>(param_name, RAW_RECORD_SEGMENT_SIZE);
+    _parameters_names.push_back(param_name);
+
     param_name = std::string("clip_distance");
     _clipping_distance = _parameters->setParam<double>(param_name, -1.0);
     _parameters_names.push_back(param_name);
@@ -78,6 +111,100 @@ void BaseRealSenseNode::getParameters()
     _hold_back_imu_for_frames = _parameters->setParam<bool>(param_name, HOLD_BACK_IMU_FOR_FRAMES);
     _parameters_names.push_back(param_name);
 
+    param_name = std::string("use_loaned_messages");
+    _use_loaned_messages = _parameters->setParam<bool>(param_name, USE_LOANED_MESSAGES);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("imu_batch_size");
+    _imu_batch_size = _parameters->setParam<int>(param_name, IMU_BATCH_SIZE);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("imu_batch_period");
+    _imu_batch_period = _parameters->setParam<double>(param_name, IMU_BATCH_PERIOD);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("enable_pipelining");
+    _enable_pipelining = _parameters->setParam<bool>(param_name, ENABLE_PIPELINING);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("pipeline_queue_size");
+    _pipeline_queue_size = _parameters->setParam<int>(param_name, PIPELINE_QUEUE_SIZE);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("pipeline_drop_policy");
+    _pipeline_drop_policy = _parameters->setParam<std::string>(param_name, PIPELINE_DROP_POLICY);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("enable_parallel_publish");
+    _enable_parallel_publish = _parameters->setParam<bool>(param_name, ENABLE_PARALLEL_PUBLISH);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("parallel_publish_threads");
+    _parallel_publish_threads = _parameters->setParam<int>(param_name, PARALLEL_PUBLISH_THREADS);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("enable_lazy_filters");
+    _enable_lazy_filters = _parameters->setParam<bool>(param_name, ENABLE_LAZY_FILTERS);
+    _parameters_names.push_back(param_name);
+
+    // The outputs computed by the filters of a frameset can be throttled, e.g. the pointcloud under load
+    param_name = std::string("load_latency_budget");
+    _output_throttle.setLatencyBudget(_parameters->setParam<double>(param_name, LOAD_LATENCY_BUDGET, [this](const rclcpp::Parameter& parameter)
+    {
+        _output_throttle.setLatencyBudget(parameter.get_value<double>());
+    }));
+    _parameters_names.push_back(param_name);
+
+    _throttled_output_names = {{POINTCLOUD_OUTPUT, "pointcloud"}, {ALIGNED_DEPTH_OUTPUT, "align_depth"}};
+    for (auto& output : _throttled_output_names)
+    {
+        const unsigned int output_bit(output.first);
+        OutputThrottle::Settings& settings = _throttled_output_settings[output_bit];
+        param_name = output.second + ".max_rate";
+        settings.max_rate = _parameters->setParam<double>(param_name, OUTPUT_MAX_RATE, [this, output_bit](const rclcpp::Parameter& parameter)
+        {
+            _throttled_output_settings[output_bit].max_rate = parameter.get_value<double>();
+            _output_throttle.setOutput(output_bit, _throttled_output_settings[output_bit]);
+        });
+        _parameters_names.push_back(param_name);
+
+        param_name = output.second + ".load_decimation";
+        settings.load_decimation = _parameters->setParam<int>(param_name, OUTPUT_LOAD_DECIMATION, [this, output_bit](const rclcpp::Parameter& parameter)
+        {
+            _throttled_output_settings[output_bit].load_decimation = parameter.get_value<int>();
+            _output_throttle.setOutput(output_bit, _throttled_output_settings[output_bit]);
+        });
+        _parameters_names.push_back(param_name);
+        _output_throttle.setOutput(output_bit, settings);
+    }
+
+    param_name = std::string("latency_stats.enable");
+    _enable_latency_stats = _parameters->setParam<bool>(param_name, ENABLE_LATENCY_STATS, [this](const rclcpp::Parameter& parameter)
+    {
+        // Each recording starts over.
+        bool is_enabled(parameter.get_value<bool>());
+        if (is_enabled)
+            _latency_stats.reset();
+        _enable_latency_stats = is_enabled;
+    });
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("latency_stats.publish_period");
+    _latency_stats_publish_period = _parameters->setParam<double>(param_name, LATENCY_STATS_PUBLISH_PERIOD);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("video_encoder.bitrate");
+    _video_encoder_bitrate = _parameters->setParam<int>(param_name, VIDEO_ENCODER_BITRATE);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("video_encoder.gop_size");
+    _video_encoder_gop_size = _parameters->setParam<int>(param_name, VIDEO_ENCODER_GOP_SIZE);
+    _parameters_names.push_back(param_name);
+
+    param_name = std::string("processing_backend");
+    _processing_backend = _parameters->setParam<std::string>(param_name, PROCESSING_BACKEND);
+    _parameters_names.push_back(param_name);
+
     param_name = std::string("base_frame_id");
     _base_frame_id = _parameters->setParam<std::string>(param_name, DEFAULT_BASE_FRAME_ID);
     _base_frame_id = (static_cast<std::ostringstream&&>(std::ostringstream() << _camera_name << "_" << _base_frame_id)).str();
@@ -0,0 +1,116 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pipeline_stage.h>
+#include <algorithm>
+
+using namespace realsense2_camera;
+
+PipelineStage::PipelineStage(const std::string& name, size_t max_queue_size, DropPolicy drop_policy) :
+    _name(name),
+    _max_queue_size(std::max<size_t>(max_queue_size, 1)),
+    _drop_policy(drop_policy),
+    _is_running(true),
+    _is_busy(false)
+{
+    _stats.max_queue_size = _max_queue_size;
+    _thread = std::thread([this](){ run(); });
+}
+
+PipelineStage::~PipelineStage()
+{
+    std::deque<Job> discarded_jobs;
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        _is_running = false;
+        discarded_jobs.swap(_jobs);
+    }
+    _cv_job.notify_one();
+    if (_thread.joinable())
+        _thread.join();
+}
+
+bool PipelineStage::push(Job job)
+{
+    Job dropped_job;    // destroyed out of the lock: it may hold frames and other resources
+    bool is_dropped(false);
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        if (!_is_running)
+            return false;
+        if (_jobs.size() >= _max_queue_size)
+        {
+            is_dropped = true;
+            _stats.dropped++;
+            if (_drop_policy == DropPolicy::DROP_NEWEST)
+                return false;
+            dropped_job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        _jobs.push_back(std::move(job));
+    }
+    _cv_job.notify_one();
+    return !is_dropped;
+}
+
+void PipelineStage::flush()
+{
+    std::deque<Job> discarded_jobs;
+    std::unique_lock<std::mutex> lock(_mutex);
+    discarded_jobs.swap(_jobs);
+    _cv_idle.wait(lock, [this]{ return !_is_busy; });
+}
+
+PipelineStageStats PipelineStage::getStats() const
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    PipelineStageStats stats(_stats);
+    stats.queue_size = _jobs.size();
+    return stats;
+}
+
+bool PipelineStage::parseDropPolicy(const std::string& name, DropPolicy& drop_policy)
+{
+    if (name == "drop_oldest")
+        drop_policy = DropPolicy::DROP_OLDEST;
+    else if (name == "drop_newest")
+        drop_policy = DropPolicy::DROP_NEWEST;
+    else
+        return false;
+    return true;
+}
+
+void PipelineStage::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _cv_job.wait(lock, [this]{ return !_is_running || !_jobs.empty(); });
+        if (!_is_running)
+            break;
+
+        Job job = std::move(_jobs.front());
+        _jobs.pop_front();
+        _is_busy = true;
+        lock.unlock();
+
+        job();
+        job = nullptr;
+
+        lock.lock();
+        _is_busy = false;
+        _stats.processed++;
+        _cv_idle.notify_all();
+    }
+}
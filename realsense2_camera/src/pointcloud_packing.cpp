@@ -0,0 +1,210 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <pointcloud_packing.h>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RS2_POINTCLOUD_PACKING_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace realsense2_camera;
+
+// The points are compacted without branches: every point is written at the current output position,
+// which only moves forward for valid points. An invalid point is overwritten by the next one.
+// Once the output is full, the remaining points go to a scratch point.
+
+namespace
+{
+    const float ZERO_VERTEX[4] = {0.f, 0.f, 0.f, 0.f};
+
+    inline bool isValidColor(float u, float v)
+    {
+        return u >= 0.f && u <= 1.f && v >= 0.f && v <= 1.f;
+    }
+
+    inline bool isInRange(float z, const PointSelection& selection)
+    {
+        return z >= selection.min_z && z <= selection.max_z;
+    }
+
+    // Writes x, y, z and a zero padding. Reads 16 bytes from vertex when has_next_vertex, or when vertex is ZERO_VERTEX.
+    inline void storeXYZ(float* dst, const float* vertex, bool has_next_vertex)
+    {
+#ifdef RS2_POINTCLOUD_PACKING_SSE2
+        if (has_next_vertex)
+        {
+            static const __m128 xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+            _mm_storeu_ps(dst, _mm_and_ps(_mm_loadu_ps(vertex), xyz_mask));
+            return;
+        }
+#else
+        (void)has_next_vertex;
+#endif
+        dst[0] = vertex[0];
+        dst[1] = vertex[1];
+        dst[2] = vertex[2];
+        dst[3] = 0.f;
+    }
+
+    template<int BYTES_PER_PIXEL>
+    inline void storeColor(uint8_t* dst, const PointcloudTexture& texture, float u, float v, bool is_valid_color)
+    {
+        // Same pixel as the texture lookup of the PointCloud2Iterator implementation, clamped to the image.
+        int pixx = std::min(static_cast<int>((is_valid_color ? u : 0.f) * texture.width), texture.width - 1);
+        int pixy = std::min(static_cast<int>((is_valid_color ? v : 0.f) * texture.height), texture.height - 1);
+        const uint8_t* pixel = texture.data + (pixy * texture.width + pixx) * BYTES_PER_PIXEL;
+        uint8_t mask = is_valid_color ? 0xff : 0;
+        if (BYTES_PER_PIXEL == 3)
+        {
+            dst[0] = pixel[2] & mask;
+            dst[1] = pixel[1] & mask;
+            dst[2] = pixel[0] & mask;
+        }
+        else
+        {
+            dst[0] = pixel[0] & mask;
+            dst[1] = 0;
+            dst[2] = 0;
+        }
+        dst[3] = 0;
+    }
+
+    // Stores the xyz fields of the encodings, XYZ::SIZE bytes.
+    struct Float32XYZ
+    {
+        static const size_t SIZE = 16;
+        static void store(uint8_t* dst, const float* vertex, bool has_next_vertex)
+        {
+            storeXYZ(reinterpret_cast<float*>(dst), vertex, has_next_vertex);
+        }
+    };
+
+    struct Int16MmXYZ
+    {
+        static const size_t SIZE = 6;
+        static void store(uint8_t* dst, const float* vertex, bool)
+        {
+            int16_t xyz[3] = {metersToInt16Mm(vertex[0]), metersToInt16Mm(vertex[1]), metersToInt16Mm(vertex[2])};
+            memcpy(dst, xyz, sizeof(xyz));
+        }
+    };
+
+    struct Float16XYZ
+    {
+        static const size_t SIZE = 6;
+        static void store(uint8_t* dst, const float* vertex, bool)
+        {
+            uint16_t xyz[3] = {floatToHalf(vertex[0]), floatToHalf(vertex[1]), floatToHalf(vertex[2])};
+            memcpy(dst, xyz, sizeof(xyz));
+        }
+    };
+
+    // BYTES_PER_PIXEL is 0 without texture.
+    template<class XYZ, int BYTES_PER_PIXEL>
+    size_t packPointsT(const float* vertices, const float* texture_coordinates, size_t count,
+                       const PointcloudTexture& texture, bool allow_no_texture_points, bool ordered,
+                       uint8_t* dst, size_t capacity, const PointSelection& selection)
+    {
+        const size_t point_step = XYZ::SIZE + (BYTES_PER_PIXEL ? 4 : 0);
+        uint8_t scratch[XYZ::SIZE + 4];
+        size_t out(0);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float* vertex = vertices + 3 * i * selection.stride;
+            bool is_in_range = isInRange(vertex[2], selection);
+            bool is_valid = (vertex[2] > 0) && is_in_range;
+
+            uint8_t* point = (out < capacity) ? dst + out * point_step : scratch;
+            XYZ::store(point, is_in_range ? vertex : ZERO_VERTEX, i + 1 < count);
+            if (BYTES_PER_PIXEL)
+            {
+                const float* uv = texture_coordinates + 2 * i * selection.stride;
+                bool is_valid_color = isValidColor(uv[0], uv[1]);
+                storeColor<BYTES_PER_PIXEL>(point + XYZ::SIZE, texture, uv[0], uv[1], is_valid_color);
+                is_valid = is_valid && (is_valid_color || allow_no_texture_points);
+            }
+            out += (is_valid || ordered) ? 1 : 0;
+        }
+        return std::min(out, capacity);
+    }
+
+    template<class XYZ>
+    size_t packPointsT(const float* vertices, const float* texture_coordinates, size_t count,
+                       const PointcloudTexture* texture, bool allow_no_texture_points, bool ordered,
+                       uint8_t* dst, size_t capacity, const PointSelection& selection)
+    {
+        if (!texture)
+            return packPointsT<XYZ, 0>(vertices, nullptr, count, PointcloudTexture{nullptr, 0, 0, 0}, false, ordered, dst, capacity, selection);
+        if (texture->bytes_per_pixel == 3)
+            return packPointsT<XYZ, 3>(vertices, texture_coordinates, count, *texture, allow_no_texture_points, ordered, dst, capacity, selection);
+        return packPointsT<XYZ, 1>(vertices, texture_coordinates, count, *texture, allow_no_texture_points, ordered, dst, capacity, selection);
+    }
+}
+
+size_t realsense2_camera::packPoints(const float* vertices, size_t count, bool ordered, PackedPoint* dst, size_t capacity,
+                                     const PointSelection& selection)
+{
+    return packPointsT<Float32XYZ>(vertices, nullptr, count, nullptr, false, ordered, reinterpret_cast<uint8_t*>(dst), capacity, selection);
+}
+
+size_t realsense2_camera::countValidPoints(const float* vertices, size_t count, const PointSelection& selection)
+{
+    size_t valid_count(0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float z = vertices[3 * i * selection.stride + 2];
+        valid_count += (z > 0 && isInRange(z, selection)) ? 1 : 0;
+    }
+    return valid_count;
+}
+
+size_t realsense2_camera::packTexturedPoints(const float* vertices, const float* texture_coordinates, size_t count,
+                                             const PointcloudTexture& texture, bool allow_no_texture_points, bool ordered,
+                                             PackedTexturedPoint* dst, size_t capacity, const PointSelection& selection)
+{
+    return packPointsT<Float32XYZ>(vertices, texture_coordinates, count, &texture, allow_no_texture_points, ordered,
+                                   reinterpret_cast<uint8_t*>(dst), capacity, selection);
+}
+
+size_t realsense2_camera::packEncodedPoints(PointEncoding encoding, const float* vertices, const float* texture_coordinates, size_t count,
+                                            const PointcloudTexture* texture, bool allow_no_texture_points, bool ordered,
+                                            uint8_t* dst, size_t capacity, const PointSelection& selection)
+{
+    switch (encoding)
+    {
+        case PointEncoding::INT16_MM:
+            return packPointsT<Int16MmXYZ>(vertices, texture_coordinates, count, texture, allow_no_texture_points, ordered, dst, capacity, selection);
+        case PointEncoding::FLOAT16:
+            return packPointsT<Float16XYZ>(vertices, texture_coordinates, count, texture, allow_no_texture_points, ordered, dst, capacity, selection);
+        default:
+            return packPointsT<Float32XYZ>(vertices, texture_coordinates, count, texture, allow_no_texture_points, ordered, dst, capacity, selection);
+    }
+}
+
+size_t realsense2_camera::countValidTexturedPoints(const float* vertices, const float* texture_coordinates, size_t count, bool allow_no_texture_points,
+                                                   const PointSelection& selection)
+{
+    size_t valid_count(0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* uv = texture_coordinates + 2 * i * selection.stride;
+        float z = vertices[3 * i * selection.stride + 2];
+        bool is_valid_color = isValidColor(uv[0], uv[1]);
+        valid_count += (z > 0 && isInRange(z, selection) && (is_valid_color || allow_no_texture_points)) ? 1 : 0;
+    }
+    return valid_count;
+}
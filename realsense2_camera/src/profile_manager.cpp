@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <profile_manager.h>
+#include <video_encoder_publisher.h>
 #include <regex>
 
 using namespace realsense2_camera;
@@ -74,6 +75,37 @@ void ProfilesManager::registerSensorQOSParam(std::string template_name,
     }
 }
 
+void ProfilesManager::registerSensorVideoEncoderParam(std::string template_name,
+                                                      std::set<stream_index_pair> unique_sips,
+                                                      std::map<stream_index_pair, std::shared_ptr<std::string> >& params)
+{
+    // For each pair of stream-index, Function add the FFmpeg encoder parameter of the stream's video topic to <params>.
+    // An empty value means no video topic. Unavailable encoders are reverted.
+    for (auto& sip : unique_sips)
+    {
+        std::string param_name = applyTemplateName(template_name, sip);
+        params[sip] = std::make_shared<std::string>("");
+        std::shared_ptr<std::string> param = params[sip];
+        rcl_interfaces::msg::ParameterDescriptor crnt_descriptor;
+        crnt_descriptor.description = "FFmpeg video encoder, e.g. h264_nvenc, hevc_nvenc, h264_vaapi, h264_v4l2m2m or ffv1. Empty for none";
+        _params.getParameters()->setParam<std::string>(param_name, "", [this, param](const rclcpp::Parameter& parameter)
+                {
+                    std::string encoder = parameter.get_value<std::string>();
+                    if (encoder.empty() || video_encoder_publisher::is_encoder_available(encoder))
+                    {
+                        *param = encoder;
+                        ROS_WARN_STREAM("re-enable the stream for the change to take effect.");
+                    }
+                    else
+                    {
+                        ROS_ERROR_STREAM("Video encoder " << encoder << " is not available. Set ROS param back to: " << *param);
+                        _params.getParameters()->queueSetRosValue(parameter.get_name(), *param);
+                    }
+                }, crnt_descriptor);
+        _parameters_names.push_back(param_name);
+    }
+}
+
 template<class T>
 void ProfilesManager::registerSensorUpdateParam(std::string template_name, 
                                                 std::set<stream_index_pair> unique_sips, 
@@ -215,6 +247,12 @@ rmw_qos_profile_t ProfilesManager::getInfoQOS(const stream_index_pair& sip) cons
     return qos_string_to_qos(*(_profiles_info_qos_str.at(sip)));
 }
 
+std::string ProfilesManager::getVideoEncoder(const stream_index_pair& sip) const
+{
+    auto encoder = _profiles_video_encoder_str.find(sip);
+    return (encoder != _profiles_video_encoder_str.end()) ? *(encoder->second) : "";
+}
+
 VideoProfilesManager::VideoProfilesManager(std::shared_ptr<Parameters> parameters,
                                            const std::string& module_name, rclcpp::Logger logger, bool force_image_default_qos):
     ProfilesManager(parameters, logger),
@@ -261,6 +299,7 @@ void VideoProfilesManager::registerProfileParameters(std::vector<stream_profile>
         registerSensorUpdateParam("enable_%s", checked_sips, _enabled_profiles, true, update_sensor_func);
         registerSensorQOSParam("%s_qos", checked_sips, _profiles_image_qos_str, _force_image_default_qos ? DEFAULT_QOS : IMAGE_QOS);
         registerSensorQOSParam("%s_info_qos", checked_sips, _profiles_info_qos_str, DEFAULT_QOS);
+        registerSensorVideoEncoderParam("%s_video_encoder", checked_sips, _profiles_video_encoder_str);
         for (auto& sip : checked_sips)
         {
             ROS_DEBUG_STREAM(__LINE__ << ": _enabled_profiles[" << ros_stream_to_string(sip.first) << ":" << sip.second << "]: " << *(_enabled_profiles[sip]));
@@ -0,0 +1,278 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <raw_device.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    int64_t steadyTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void setIdentity(RawStreamInfo& info)
+    {
+        info.rotation[0] = info.rotation[4] = info.rotation[8] = 1.f;
+    }
+
+    void deleteFrameData(void* data)
+    {
+        delete[] static_cast<uint8_t*>(data);
+    }
+}
+
+RawRecorder::RawRecorder(const std::string& dir_path, size_t segment_size, rs2::device dev, const std::vector<rs2::sensor>& sensors) :
+    _writer(dir_path, segment_size)
+{
+    RawRecordDescription description;
+    for (int info = 0; info < RS2_CAMERA_INFO_COUNT; ++info)
+    {
+        if (dev.supports(static_cast<rs2_camera_info>(info)))
+            description.infos.push_back(std::make_pair(info, dev.get_info(static_cast<rs2_camera_info>(info))));
+    }
+
+    rs2::stream_profile first_profile;
+    for (auto& sensor : sensors)
+    {
+        RawSensorInfo sensor_info;
+        sensor_info.name = sensor.get_info(RS2_CAMERA_INFO_NAME);
+        sensor_info.depth_units = sensor.is<rs2::depth_sensor>() ? sensor.as<rs2::depth_sensor>().get_depth_scale() : 0.f;
+        for (auto& profile : sensor.get_active_streams())
+        {
+            RawStreamInfo info = {};
+            info.stream_id = static_cast<uint32_t>(_stream_ids.size());
+            info.stream = profile.stream_type();
+            info.index = profile.stream_index();
+            info.format = profile.format();
+            info.fps = profile.fps();
+            info.unique_id = profile.unique_id();
+            info.is_video = profile.is<rs2::video_stream_profile>();
+            if (info.is_video)
+            {
+                rs2_intrinsics intrinsics = profile.as<rs2::video_stream_profile>().get_intrinsics();
+                info.width = intrinsics.width;
+                info.height = intrinsics.height;
+                info.ppx = intrinsics.ppx;
+                info.ppy = intrinsics.ppy;
+                info.fx = intrinsics.fx;
+                info.fy = intrinsics.fy;
+                info.model = intrinsics.model;
+                std::memcpy(info.coeffs, intrinsics.coeffs, sizeof(info.coeffs));
+            }
+            setIdentity(info);
+            if (!first_profile)
+                first_profile = profile;
+            else
+            {
+                try
+                {
+                    rs2_extrinsics extrinsics = profile.get_extrinsics_to(first_profile);
+                    std::memcpy(info.rotation, extrinsics.rotation, sizeof(info.rotation));
+                    std::memcpy(info.translation, extrinsics.translation, sizeof(info.translation));
+                }
+                catch(const rs2::error&)
+                {
+                    // Not calibrated together: replayed as the identity
+                }
+            }
+            _stream_ids[profile.unique_id()] = info.stream_id;
+            sensor_info.streams.push_back(info);
+        }
+        if (!sensor_info.streams.empty())
+            description.sensors.push_back(sensor_info);
+    }
+    if (!_writer.open(description))
+        throw std::runtime_error("Failed to open the raw recording " + dir_path);
+}
+
+RawRecorder::~RawRecorder()
+{
+    _writer.close();
+}
+
+void RawRecorder::record(const rs2::frame& frame)
+{
+    if (frame.is<rs2::frameset>())
+    {
+        for (auto&& f : frame.as<rs2::frameset>())
+            record(f);
+        return;
+    }
+    auto stream_id = _stream_ids.find(frame.get_profile().unique_id());
+    if (stream_id == _stream_ids.end())
+        return;
+
+    RawMetadata metadata[RS2_FRAME_METADATA_COUNT];
+    RawFrameIndex index = {};
+    for (int key = 0; key < RS2_FRAME_METADATA_COUNT; ++key)
+    {
+        if (frame.supports_frame_metadata(static_cast<rs2_frame_metadata_value>(key)))
+            metadata[index.metadata_count++] = RawMetadata{key, 0, frame.get_frame_metadata(static_cast<rs2_frame_metadata_value>(key))};
+    }
+    index.stream_id = stream_id->second;
+    index.size = static_cast<uint32_t>(frame.get_data_size());
+    index.frame_number = frame.get_frame_number();
+    index.timestamp = frame.get_timestamp();
+    index.timestamp_domain = frame.get_frame_timestamp_domain();
+    index.arrival_time_ns = steadyTimeNs();
+    _writer.write(index, metadata, frame.get_data());
+}
+
+RawPlaybackDevice::RawPlaybackDevice(const std::string& dir_path) :
+    _is_playing(false)
+{
+    if (!_reader.open(dir_path))
+        throw std::runtime_error("Failed to open the raw recording " + dir_path);
+    const RawRecordDescription& description = _reader.getDescription();
+    for (auto& info : description.infos)
+        _device.register_info(static_cast<rs2_camera_info>(info.first), info.second);
+
+    // The layout of the video frames is taken from the first frame of each stream
+    std::map<uint32_t, uint32_t> first_frame_sizes;
+    for (size_t frame = 0; frame < _reader.size(); ++frame)
+        first_frame_sizes.insert(std::make_pair(_reader.index(frame).stream_id, _reader.index(frame).size));
+
+    rs2::stream_profile first_profile;
+    for (auto& sensor_info : description.sensors)
+    {
+        rs2::software_sensor sensor = _device.add_sensor(sensor_info.name);
+        if (sensor_info.depth_units > 0)
+            sensor.add_read_only_option(RS2_OPTION_DEPTH_UNITS, sensor_info.depth_units);
+        for (auto& info : sensor_info.streams)
+        {
+            auto first_frame_size = first_frame_sizes.find(info.stream_id);
+            if (first_frame_size == first_frame_sizes.end())
+                continue;       // no frame to play back
+            rs2::stream_profile profile;
+            int bytes_per_pixel(0);
+            int stride(0);
+            if (info.is_video)
+            {
+                if (info.width <= 0 || info.height <= 0)
+                    continue;
+                stride = first_frame_size->second / info.height;
+                bytes_per_pixel = stride / info.width;
+                rs2_intrinsics intrinsics = {info.width, info.height, info.ppx, info.ppy, info.fx, info.fy,
+                                             static_cast<rs2_distortion>(info.model), {}};
+                std::memcpy(intrinsics.coeffs, info.coeffs, sizeof(intrinsics.coeffs));
+                profile = sensor.add_video_stream({static_cast<rs2_stream>(info.stream), info.index, info.unique_id,
+                                                   info.width, info.height, info.fps, bytes_per_pixel,
+                                                   static_cast<rs2_format>(info.format), intrinsics}, true);
+            }
+            else
+            {
+                rs2_motion_device_intrinsic intrinsics = {};
+                intrinsics.data[0][0] = intrinsics.data[1][1] = intrinsics.data[2][2] = 1.f;
+                profile = sensor.add_motion_stream({static_cast<rs2_stream>(info.stream), info.index, info.unique_id,
+                                                    info.fps, static_cast<rs2_format>(info.format), intrinsics}, true);
+            }
+            if (!first_profile)
+                first_profile = profile;
+            else
+            {
+                rs2_extrinsics extrinsics;
+                std::memcpy(extrinsics.rotation, info.rotation, sizeof(extrinsics.rotation));
+                std::memcpy(extrinsics.translation, info.translation, sizeof(extrinsics.translation));
+                profile.register_extrinsics_to(first_profile, extrinsics);
+            }
+            _streams.insert(std::make_pair(info.stream_id, Stream{sensor, profile, bytes_per_pixel, stride, sensor_info.depth_units}));
+        }
+    }
+}
+
+RawPlaybackDevice::~RawPlaybackDevice()
+{
+    stop();
+}
+
+void RawPlaybackDevice::play()
+{
+    stop();
+    _is_playing = true;
+    _replay_thread = std::thread([this](){replay();});
+}
+
+void RawPlaybackDevice::stop()
+{
+    _is_playing = false;
+    if (_replay_thread.joinable())
+        _replay_thread.join();
+}
+
+void RawPlaybackDevice::replay()
+{
+    if (0 == _reader.size())
+        return;
+    // Sleeps are short, so that stop() doesn't wait for long gaps in the recording
+    const std::chrono::milliseconds max_sleep(100);
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    const int64_t first_arrival_ns(_reader.index(0).arrival_time_ns);
+    for (size_t frame = 0; frame < _reader.size() && _is_playing; ++frame)
+    {
+        const RawFrameIndex& index = _reader.index(frame);
+        const std::chrono::steady_clock::time_point frame_time = start_time +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(index.arrival_time_ns - first_arrival_ns));
+        while (_is_playing && std::chrono::steady_clock::now() < frame_time)
+            std::this_thread::sleep_until(std::min(frame_time, std::chrono::steady_clock::now() + max_sleep));
+        auto stream = _streams.find(index.stream_id);
+        if (!_is_playing || stream == _streams.end())
+            continue;
+
+        const RawMetadata* metadata = _reader.metadata(frame);
+        for (uint32_t i = 0; i < index.metadata_count; ++i)
+            stream->second.sensor.set_metadata(static_cast<rs2_frame_metadata_value>(metadata[i].key), metadata[i].value);
+        // Copied out of the mapping: librealsense may keep the frame after the recording is closed
+        uint8_t* data = new uint8_t[index.size];
+        std::memcpy(data, _reader.data(frame), index.size);
+        try
+        {
+            if (stream->second.profile.is<rs2::video_stream_profile>())
+            {
+                rs2_software_video_frame video_frame = {};
+                video_frame.pixels = data;
+                video_frame.deleter = deleteFrameData;
+                video_frame.stride = stream->second.stride;
+                video_frame.bpp = stream->second.bytes_per_pixel;
+                video_frame.timestamp = index.timestamp;
+                video_frame.domain = static_cast<rs2_timestamp_domain>(index.timestamp_domain);
+                video_frame.frame_number = static_cast<int>(index.frame_number);
+                video_frame.profile = stream->second.profile.get();
+                video_frame.depth_units = stream->second.depth_units;
+                stream->second.sensor.on_video_frame(video_frame);
+            }
+            else
+            {
+                rs2_software_motion_frame motion_frame = {};
+                motion_frame.data = data;
+                motion_frame.deleter = deleteFrameData;
+                motion_frame.timestamp = index.timestamp;
+                motion_frame.domain = static_cast<rs2_timestamp_domain>(index.timestamp_domain);
+                motion_frame.frame_number = static_cast<int>(index.frame_number);
+                motion_frame.profile = stream->second.profile.get();
+                stream->second.sensor.on_motion_frame(motion_frame);
+            }
+        }
+        catch(const rs2::error&)
+        {
+            // The sensor was stopped meanwhile, e.g. by a profile change
+        }
+    }
+}
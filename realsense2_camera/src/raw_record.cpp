@@ -0,0 +1,563 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <raw_record.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace realsense2_camera;
+
+// The "streams" file holds one record per line, with tab separated fields:
+// realsense2_camera raw recording <version>
+// info   <rs2_camera_info> <value>
+// sensor <depth units> <name>
+// video  <id> <stream> <index> <format> <fps> <unique id> <width> <height> <ppx> <ppy> <fx> <fy> <model>
+//        <coeffs x5> <rotation x9> <translation x3>
+// motion <id> <stream> <index> <format> <fps> <unique id> <rotation x9> <translation x3>
+// The streams are those of the sensor above them.
+namespace
+{
+    const std::string FILE_HEADER("realsense2_camera raw recording\t1");
+    const size_t VIDEO_FIELDS_COUNT(31);
+    const size_t MOTION_FIELDS_COUNT(19);
+    const size_t RECORD_ALIGNMENT(8);
+    const size_t INDEX_FLUSH_SIZE(256);         // frames
+
+    std::string streamsPath(const std::string& dir_path) { return dir_path + "/streams"; }
+    std::string indexPath(const std::string& dir_path) { return dir_path + "/index"; }
+
+    std::string segmentPath(const std::string& dir_path, uint32_t segment)
+    {
+        std::ostringstream stream;
+        stream << dir_path << "/segment_" << segment;
+        return stream.str();
+    }
+
+    std::string removeSeparators(const std::string& text)
+    {
+        std::string cleaned(text);
+        for (char& c : cleaned)
+        {
+            if (c == '\t' || c == '\n' || c == '\r')
+                c = ' ';
+        }
+        return cleaned;
+    }
+
+    std::vector<std::string> splitFields(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        size_t begin(0);
+        while (true)
+        {
+            size_t end = line.find('\t', begin);
+            fields.push_back(line.substr(begin, end - begin));
+            if (end == std::string::npos)
+                return fields;
+            begin = end + 1;
+        }
+    }
+
+    template<class T>
+    bool parseNumber(const std::string& text, T& value)
+    {
+        std::istringstream stream(text);
+        stream.imbue(std::locale::classic());
+        stream >> value;
+        return !stream.fail() && stream.eof();
+    }
+
+    // Parses the fields from first on, in order
+    class FieldsParser
+    {
+        public:
+            FieldsParser(const std::vector<std::string>& fields, size_t first) :
+                _fields(fields), _next(first), _is_valid(true)
+            {}
+
+            template<class T>
+            FieldsParser& operator>>(T& value)
+            {
+                _is_valid = _is_valid && _next < _fields.size() && parseNumber(_fields[_next], value);
+                ++_next;
+                return *this;
+            }
+
+            bool isValid() const { return _is_valid && _next == _fields.size(); }
+
+        private:
+            const std::vector<std::string>& _fields;
+            size_t _next;
+            bool _is_valid;
+    };
+
+    void writeExtrinsics(std::ostream& stream, const RawStreamInfo& info)
+    {
+        for (float value : info.rotation)
+            stream << '\t' << value;
+        for (float value : info.translation)
+            stream << '\t' << value;
+    }
+
+    void parseExtrinsics(FieldsParser& parser, RawStreamInfo& info)
+    {
+        for (float& value : info.rotation)
+            parser >> value;
+        for (float& value : info.translation)
+            parser >> value;
+    }
+
+    bool writeAll(int fd, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written <= 0)
+                return false;
+            bytes += written;
+            size -= written;
+        }
+        return true;
+    }
+}
+
+std::string RawRecordDescription::serialize() const
+{
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream.precision(std::numeric_limits<float>::max_digits10);     // the floats are read back exactly
+    stream << FILE_HEADER << '\n';
+    for (auto& info : infos)
+        stream << "info\t" << info.first << '\t' << removeSeparators(info.second) << '\n';
+    for (auto& sensor : sensors)
+    {
+        stream << "sensor\t" << sensor.depth_units << '\t' << removeSeparators(sensor.name) << '\n';
+        for (auto& info : sensor.streams)
+        {
+            stream << (info.is_video ? "video" : "motion") << '\t' << info.stream_id << '\t' << info.stream << '\t' << info.index
+                   << '\t' << info.format << '\t' << info.fps << '\t' << info.unique_id;
+            if (info.is_video)
+            {
+                stream << '\t' << info.width << '\t' << info.height << '\t' << info.ppx << '\t' << info.ppy
+                       << '\t' << info.fx << '\t' << info.fy << '\t' << info.model;
+                for (float value : info.coeffs)
+                    stream << '\t' << value;
+            }
+            writeExtrinsics(stream, info);
+            stream << '\n';
+        }
+    }
+    return stream.str();
+}
+
+bool RawRecordDescription::parse(const std::string& content)
+{
+    RawRecordDescription description;
+    std::istringstream stream(content);
+    std::string line;
+    if (!std::getline(stream, line) || line != FILE_HEADER)
+        return false;
+    while (std::getline(stream, line))
+    {
+        if (line.empty())
+            continue;
+        std::vector<std::string> fields = splitFields(line);
+        if (fields[0] == "info" && fields.size() == 3)
+        {
+            int key;
+            if (!parseNumber(fields[1], key))
+                return false;
+            description.infos.push_back(std::make_pair(key, fields[2]));
+        }
+        else if (fields[0] == "sensor" && fields.size() == 3)
+        {
+            RawSensorInfo sensor;
+            if (!parseNumber(fields[1], sensor.depth_units))
+                return false;
+            sensor.name = fields[2];
+            description.sensors.push_back(sensor);
+        }
+        else if ((fields[0] == "video" || fields[0] == "motion") && !description.sensors.empty())
+        {
+            RawStreamInfo info = {};
+            info.is_video = (fields[0] == "video");
+            if (fields.size() != (info.is_video ? VIDEO_FIELDS_COUNT : MOTION_FIELDS_COUNT))
+                return false;
+            FieldsParser parser(fields, 1);
+            parser >> info.stream_id >> info.stream >> info.index >> info.format >> info.fps >> info.unique_id;
+            if (info.is_video)
+            {
+                parser >> info.width >> info.height >> info.ppx >> info.ppy >> info.fx >> info.fy >> info.model;
+                for (float& value : info.coeffs)
+                    parser >> value;
+            }
+            parseExtrinsics(parser, info);
+            if (!parser.isValid())
+                return false;
+            description.sensors.back().streams.push_back(info);
+        }
+        else
+            return false;
+    }
+    *this = description;
+    return true;
+}
+
+RawRecordWriter::RawRecordWriter(const std::string& dir_path, size_t segment_size) :
+    _dir_path(dir_path),
+    _segment_size(segment_size),
+    _segment_flushed(0),
+    _index_fd(-1),
+    _is_segments_thread_running(false),
+    _is_next_segment_wanted(false),
+    _next_segment_number(0),
+    _is_segment_close_failed(false),
+    _frames_count(0),
+    _dropped_count(0)
+{
+}
+
+RawRecordWriter::~RawRecordWriter()
+{
+    close();
+}
+
+bool RawRecordWriter::open(const RawRecordDescription& description)
+{
+    close();
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    if (0 != mkdir(_dir_path.c_str(), 0755) && errno != EEXIST)
+        return false;
+    {
+        std::ofstream file(streamsPath(_dir_path), std::ios::trunc);
+        if (!file.is_open())
+            return false;
+        file << description.serialize();
+        file.close();
+        if (file.fail())
+            return false;
+    }
+    _index_fd = ::open(indexPath(_dir_path).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_index_fd < 0)
+        return false;
+    _frames_count = 0;
+    _dropped_count = 0;
+    _segment = openSegment(0);
+    _segment_flushed = 0;
+    if (_segment.fd < 0)
+    {
+        ::close(_index_fd);
+        _index_fd = -1;
+        return false;
+    }
+
+    // The second segment is opened right away
+    _is_segments_thread_running = true;
+    _is_next_segment_wanted = true;
+    _next_segment_number = 1;
+    _next_segment = Segment();
+    _is_segment_close_failed = false;
+    _segments_thread = std::thread([this]() { prepareSegments(); });
+    return true;
+}
+
+RawRecordWriter::Segment RawRecordWriter::openSegment(uint32_t number)
+{
+    Segment segment;
+    const std::string path(segmentPath(_dir_path, number));
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return segment;
+    // Allocated now, so that a full disk fails here rather than while a frame is copied to the mapping
+    void* data(MAP_FAILED);
+    if (0 == posix_fallocate(fd, 0, _segment_size))
+        data = mmap(nullptr, _segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == data)
+    {
+        ::close(fd);
+        unlink(path.c_str());
+        return segment;
+    }
+    segment.fd = fd;
+    segment.data = static_cast<uint8_t*>(data);
+    segment.number = number;
+    return segment;
+}
+
+bool RawRecordWriter::closeSegment(Segment& segment)
+{
+    if (segment.fd < 0)
+        return true;
+    // The dirty pages are written back after the unmapping as well. The unused allocation is given back.
+    munmap(segment.data, _segment_size);
+    bool is_truncated = (0 == ftruncate(segment.fd, segment.used));
+    ::close(segment.fd);
+    segment = Segment();
+    return is_truncated;
+}
+
+void RawRecordWriter::prepareSegments()
+{
+    std::unique_lock<std::mutex> lock(_segments_mutex);
+    while (true)
+    {
+        _segments_cv.wait(lock, [this]{ return !_is_segments_thread_running || _is_next_segment_wanted || !_full_segments.empty(); });
+        if (!_is_segments_thread_running && _full_segments.empty())
+            break;
+        std::vector<Segment> full_segments;
+        full_segments.swap(_full_segments);
+        bool is_next_wanted(_is_next_segment_wanted && _is_segments_thread_running);
+        uint32_t next_number(_next_segment_number);
+        lock.unlock();
+
+        bool is_closed(true);
+        for (auto& segment : full_segments)
+            is_closed = closeSegment(segment) && is_closed;
+        Segment next_segment;
+        if (is_next_wanted)
+            next_segment = openSegment(next_number);
+
+        lock.lock();
+        _is_segment_close_failed = _is_segment_close_failed || !is_closed;
+        if (is_next_wanted)
+        {
+            // If it failed, the next segment is wanted again by the next frame that doesn't fit
+            _next_segment = next_segment;
+            _is_next_segment_wanted = false;
+            _segments_cv.notify_all();
+        }
+    }
+}
+
+bool RawRecordWriter::swapSegment()
+{
+    std::unique_lock<std::mutex> lock(_segments_mutex);
+    // Usually ready long before: only waits if the segment was filled faster than the next one is allocated
+    _segments_cv.wait(lock, [this]{ return !_is_next_segment_wanted; });
+    if (_next_segment.fd < 0)
+    {
+        _is_next_segment_wanted = true;
+        _segments_cv.notify_all();
+        return false;
+    }
+    _full_segments.push_back(_segment);
+    _segment = _next_segment;
+    _next_segment = Segment();
+    _next_segment_number = _segment.number + 1;
+    _is_next_segment_wanted = true;
+    _segments_cv.notify_all();
+    return true;
+}
+
+void RawRecordWriter::stopSegmentsThread()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(_segments_mutex);
+        _is_segments_thread_running = false;
+    }
+    _segments_cv.notify_all();
+    if (_segments_thread.joinable())
+        _segments_thread.join();
+    // The next segment, opened ahead, is left unused
+    if (_next_segment.fd >= 0)
+    {
+        const std::string path(segmentPath(_dir_path, _next_segment.number));
+        closeSegment(_next_segment);
+        unlink(path.c_str());
+    }
+}
+
+bool RawRecordWriter::flushIndex()
+{
+    bool is_written = writeAll(_index_fd, _pending_index.data(), _pending_index.size() * sizeof(RawFrameIndex));
+    _pending_index.clear();
+    return is_written;
+}
+
+bool RawRecordWriter::write(RawFrameIndex index, const RawMetadata* metadata, const void* data)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    const size_t metadata_size(index.metadata_count * sizeof(RawMetadata));
+    const size_t record_size((metadata_size + index.size + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT);
+    if (_index_fd < 0 || record_size > _segment_size)
+    {
+        ++_dropped_count;
+        return false;
+    }
+    if (_segment.used + record_size > _segment_size)
+    {
+        // The full segment is finished by the segments thread
+        if (!swapSegment())
+        {
+            ++_dropped_count;
+            return false;
+        }
+        _segment_flushed = 0;
+    }
+    if (metadata_size > 0)
+        std::memcpy(_segment.data + _segment.used, metadata, metadata_size);
+    std::memcpy(_segment.data + _segment.used + metadata_size, data, index.size);
+    index.segment = _segment.number;
+    index.offset = _segment.used + metadata_size;
+    _pending_index.push_back(index);
+    _segment.used += record_size;
+    ++_frames_count;
+
+    if (_segment.used - _segment_flushed >= _segment_size / 16)
+    {
+        // Starts the write back without waiting for it
+        sync_file_range(_segment.fd, _segment_flushed, _segment.used - _segment_flushed, SYNC_FILE_RANGE_WRITE);
+        _segment_flushed = _segment.used;
+    }
+    if (_pending_index.size() >= INDEX_FLUSH_SIZE)
+        flushIndex();
+    return true;
+}
+
+bool RawRecordWriter::close()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    if (_index_fd < 0)
+        return true;
+    // The full segments are finished by the segments thread before it stops
+    stopSegmentsThread();
+    bool is_closed = closeSegment(_segment) && !_is_segment_close_failed;
+    is_closed = flushIndex() && is_closed;
+    is_closed = (0 == ::close(_index_fd)) && is_closed;
+    _index_fd = -1;
+    return is_closed;
+}
+
+bool RawRecordWriter::isOpen()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _index_fd >= 0;
+}
+
+uint64_t RawRecordWriter::getFramesCount()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _frames_count;
+}
+
+uint64_t RawRecordWriter::getDroppedCount()
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    return _dropped_count;
+}
+
+RawRecordReader::RawRecordReader()
+{
+}
+
+RawRecordReader::~RawRecordReader()
+{
+    close();
+}
+
+void RawRecordReader::close()
+{
+    for (auto& segment : _segments)
+    {
+        if (segment.first)
+            munmap(segment.first, segment.second);
+    }
+    _segments.clear();
+    _frames.clear();
+}
+
+bool RawRecordReader::open(const std::string& dir_path)
+{
+    close();
+    {
+        std::ifstream file(streamsPath(dir_path));
+        if (!file.is_open())
+            return false;
+        std::stringstream content;
+        content << file.rdbuf();
+        if (!_description.parse(content.str()))
+            return false;
+    }
+    {
+        std::ifstream file(indexPath(dir_path), std::ios::binary);
+        if (!file.is_open())
+            return false;
+        std::stringstream content;
+        content << file.rdbuf();
+        const std::string index(content.str());
+        if (0 != index.size() % sizeof(RawFrameIndex))
+            return false;
+        _frames.resize(index.size() / sizeof(RawFrameIndex));
+        std::memcpy(_frames.data(), index.data(), index.size());
+    }
+
+    for (auto& frame : _frames)
+    {
+        while (frame.segment >= _segments.size())
+        {
+            int fd = ::open(segmentPath(dir_path, _segments.size()).c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat status;
+            if (fd < 0 || 0 != fstat(fd, &status))
+            {
+                if (fd >= 0)
+                    ::close(fd);
+                close();
+                return false;
+            }
+            const size_t size(status.st_size);
+            void* data = (0 == size) ? nullptr : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (MAP_FAILED == data)
+            {
+                close();
+                return false;
+            }
+            // Replayed in order
+            if (data)
+                madvise(data, size, MADV_SEQUENTIAL);
+            _segments.push_back(std::make_pair(static_cast<uint8_t*>(data), size));
+        }
+        const size_t metadata_size(frame.metadata_count * sizeof(RawMetadata));
+        if (frame.offset < metadata_size || frame.offset + frame.size > _segments[frame.segment].second)
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+const RawMetadata* RawRecordReader::metadata(size_t frame) const
+{
+    const RawFrameIndex& index = _frames[frame];
+    return reinterpret_cast<const RawMetadata*>(_segments[index.segment].first + index.offset) - index.metadata_count;
+}
+
+const void* RawRecordReader::data(size_t frame) const
+{
+    const RawFrameIndex& index = _frames[frame];
+    return _segments[index.segment].first + index.offset;
+}
@@ -47,7 +47,20 @@ RealSenseNodeFactory::RealSenseNodeFactory(const std::string & node_name, const
 
 RealSenseNodeFactory::~RealSenseNodeFactory()
 {
-    _is_alive = false;
+    _ctx.set_devices_changed_callback([](rs2::event_information&){});
+    {
+        std::lock_guard<std::mutex> lock_guard(_device_mutex);
+        _is_alive = false;
+    }
+    _cv_device.notify_all();
+    if (_raw_playback)
+    {
+        _raw_playback->stop();
+    }
+    if (_device_registry)
+    {
+        _device_registry->removeClient(_registry_client_id);
+    }
     if (_query_thread.joinable())
     {
         _query_thread.join();
@@ -76,6 +89,58 @@ std::string RealSenseNodeFactory::parseUsbPort(std::string line)
     return port_id;
 }
 
+bool RealSenseNodeFactory::isRequestedDevice(rs2::device dev)
+{
+    auto sn = dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
+    ROS_INFO_STREAM("Device with serial number " << sn << " was found."<<std::endl);
+    std::string pn = dev.get_info(RS2_CAMERA_INFO_PHYSICAL_PORT);
+    std::string name = dev.get_info(RS2_CAMERA_INFO_NAME);
+    ROS_INFO_STREAM("Device with physical ID " << pn << " was found.");
+    std::vector<std::string> results;
+    ROS_INFO_STREAM("Device with name " << name << " was found.");
+    std::string port_id = parseUsbPort(pn);
+    if (port_id.empty())
+    {
+        std::stringstream msg;
+        msg << "Error extracting usb port from device with physical ID: " << pn << std::endl << "Please report on github issue at https://github.com/IntelRealSense/realsense-ros";
+        if (_usb_port_id.empty())
+        {
+            ROS_WARN_STREAM(msg.str());
+        }
+        else
+        {
+            ROS_ERROR_STREAM(msg.str());
+            ROS_ERROR_STREAM("Please use serial number instead of usb port.");
+        }
+    }
+    else
+    {
+        ROS_INFO_STREAM("Device with port number " << port_id << " was found.");                    
+    }
+    bool found_device_type(true);
+    if (!_device_type.empty())
+    {
+        std::smatch match_results;
+        std::regex device_type_regex(_device_type.c_str(), std::regex::icase);
+        found_device_type = std::regex_search(name, match_results, device_type_regex);
+    }
+
+    return ((_serial_no.empty() || sn == _serial_no) && (_usb_port_id.empty() || port_id == _usb_port_id) && found_device_type);
+}
+
+void RealSenseNodeFactory::logDeviceUsbType()
+{
+    if (_device.supports(RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR))
+    {
+        std::string usb_type = _device.get_info(RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR);
+        ROS_INFO_STREAM("Device USB type: " << usb_type);
+        if (usb_type.find("2.") != std::string::npos)
+        {
+            ROS_WARN_STREAM("Device " << _serial_no << " is connected using a " << usb_type << " port. Reduced performance is expected.");
+        }
+    }
+}
+
 void RealSenseNodeFactory::getDevice(rs2::device_list list)
 {
     if (!_device)
@@ -99,44 +164,10 @@ void RealSenseNodeFactory::getDevice(rs2::device_list list)
                     ROS_WARN_STREAM("Device " << count+1 << "/" << list.size() << " failed with exception: " << ex.what());
                     continue;
                 }
-                auto sn = dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
-                ROS_INFO_STREAM("Device with serial number " << sn << " was found."<<std::endl);
-                std::string pn = dev.get_info(RS2_CAMERA_INFO_PHYSICAL_PORT);
-                std::string name = dev.get_info(RS2_CAMERA_INFO_NAME);
-                ROS_INFO_STREAM("Device with physical ID " << pn << " was found.");
-                std::vector<std::string> results;
-                ROS_INFO_STREAM("Device with name " << name << " was found.");
-                std::string port_id = parseUsbPort(pn);
-                if (port_id.empty())
-                {
-                    std::stringstream msg;
-                    msg << "Error extracting usb port from device with physical ID: " << pn << std::endl << "Please report on github issue at https://github.com/IntelRealSense/realsense-ros";
-                    if (_usb_port_id.empty())
-                    {
-                        ROS_WARN_STREAM(msg.str());
-                    }
-                    else
-                    {
-                        ROS_ERROR_STREAM(msg.str());
-                        ROS_ERROR_STREAM("Please use serial number instead of usb port.");
-                    }
-                }
-                else
-                {
-                    ROS_INFO_STREAM("Device with port number " << port_id << " was found.");                    
-                }
-                bool found_device_type(true);
-                if (!_device_type.empty())
-                {
-                    std::smatch match_results;
-                    std::regex device_type_regex(_device_type.c_str(), std::regex::icase);
-                    found_device_type = std::regex_search(name, match_results, device_type_regex);
-                }
-
-                if ((_serial_no.empty() || sn == _serial_no) && (_usb_port_id.empty() || port_id == _usb_port_id) && found_device_type)
+                if (isRequestedDevice(dev))
                 {
                     _device = dev;
-                    _serial_no = sn;
+                    _serial_no = dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
                     found = true;
                     break;
                 }
@@ -172,15 +203,7 @@ void RealSenseNodeFactory::getDevice(rs2::device_list list)
             }
             else
             {
-                if (_device.supports(RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR))
-                {
-                    std::string usb_type = _device.get_info(RS2_CAMERA_INFO_USB_TYPE_DESCRIPTOR);
-                    ROS_INFO_STREAM("Device USB type: " << usb_type);
-                    if (usb_type.find("2.") != std::string::npos)
-                    {
-                        ROS_WARN_STREAM("Device " << _serial_no << " is connected using a " << usb_type << " port. Reduced performance is expected.");
-                    }
-                }
+                logDeviceUsbType();
             }
         }
     }
@@ -204,25 +227,46 @@ void RealSenseNodeFactory::getDevice(rs2::device_list list)
 
 void RealSenseNodeFactory::changeDeviceCallback(rs2::event_information& info)
 {
-    if (info.was_removed(_device))
+    // The device is closed and started by _query_thread: librealsense calls this from its own thread,
+    // which shouldn't be held by the node setup.
+    std::lock_guard<std::mutex> lock_guard(_device_mutex);
+    if (_connected_device && info.was_removed(_connected_device))
+    {
+        _is_device_removed = true;
+    }
+    if (info.get_new_devices().size() > 0)
+    {
+        _is_query_needed = true;
+    }
+    _cv_device.notify_one();
+}
+
+void RealSenseNodeFactory::closeDevice()
+{
+    ROS_ERROR("The device has been disconnected!");
+    // With hot_reconnect, the node waits for the device to come back with its publishers and parameters
+    if (!_hot_reconnect)
     {
-        ROS_ERROR("The device has been disconnected!");
         _realSenseNode.reset(nullptr);
-        _device = rs2::device();
     }
-    if (!_device)
+    _device = rs2::device();
+}
+
+void RealSenseNodeFactory::startOrReconnectDevice()
+{
+    if (_realSenseNode)
     {
-        rs2::device_list new_devices = info.get_new_devices();
-        if (new_devices.size() > 0)
+        try
         {
-            ROS_INFO("Checking new devices...");
-            getDevice(new_devices);
-            if (_device)
-            {
-                startDevice();
-            }
+            _realSenseNode->reconnect(_device);
+            return;
+        }
+        catch(const std::exception& e)
+        {
+            ROS_WARN_STREAM("Failed to reconnect the device: " << e.what() << ". Starting it again.");
         }
     }
+    startDevice();
 }
 
 std::string api_version_to_string(int version)
@@ -240,6 +284,10 @@ void RealSenseNodeFactory::init()
     try
     {
         _is_alive = true;
+        _hot_reconnect = HOT_RECONNECT;
+        _is_query_needed = false;
+        _is_device_removed = false;
+        _registry_client_id = 0;
         _parameters = std::make_shared<Parameters>(*this);
 
         rs2_error* e = nullptr;
@@ -277,7 +325,18 @@ void RealSenseNodeFactory::init()
         if (!_serial_no.empty() && _serial_no.front() == '_') _serial_no = _serial_no.substr(1);    // remove '_' prefix
 
         std::string rosbag_filename(declare_parameter("rosbag_filename", rclcpp::ParameterValue("")).get<rclcpp::PARAMETER_STRING>());
-        if (!rosbag_filename.empty())
+        std::string raw_playback_dir(declare_parameter("raw_playback_dir", rclcpp::ParameterValue("")).get<rclcpp::PARAMETER_STRING>());
+        if (!raw_playback_dir.empty())
+        {
+            ROS_INFO_STREAM("publish topics from raw recording: " << raw_playback_dir);
+            _raw_playback = std::make_shared<RawPlaybackDevice>(raw_playback_dir);
+            _device = _raw_playback->getDevice();
+            _serial_no = _device.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
+            startDevice();
+            if (_realSenseNode)
+                _raw_playback->play();
+        }
+        else if (!rosbag_filename.empty())
         {
             {
                 ROS_INFO_STREAM("publish topics from rosbag file: " << rosbag_filename.c_str());
@@ -293,46 +352,91 @@ void RealSenseNodeFactory::init()
         else
         {
             _initial_reset = declare_parameter("initial_reset", rclcpp::ParameterValue(false)).get<rclcpp::PARAMETER_BOOL>();
+            _initial_reset_stagger = declare_parameter("initial_reset_stagger", 2.0);
+            _hot_reconnect = declare_parameter("hot_reconnect", rclcpp::ParameterValue(HOT_RECONNECT)).get<rclcpp::PARAMETER_BOOL>();
+            if (declare_parameter("shared_context", rclcpp::ParameterValue(false)).get<rclcpp::PARAMETER_BOOL>())
+            {
+                startSharedContextDiscovery();
+                return;
+            }
 
-            _query_thread = std::thread([=]()
+            // The devices are queried again when a device is connected, the periodic queries only back the events up:
+            // they start QUERY_DEVICES_MIN_BACKOFF apart and back off up to reconnect_timeout.
+            std::function<void(rs2::event_information&)> change_device_callback_function = [this](rs2::event_information& info){changeDeviceCallback(info);};
+            _ctx.set_devices_changed_callback(change_device_callback_function);
+            _query_thread = std::thread([this]()
             {
-                std::chrono::milliseconds timespan(static_cast<int>(_reconnect_timeout*1e3));
+                const double min_backoff(std::min(QUERY_DEVICES_MIN_BACKOFF, _reconnect_timeout));
+                double backoff(min_backoff);
                 rclcpp::Time first_try_time = this->get_clock()->now();
-                while (_is_alive && !_device)
+                bool was_device_found(false);
+                std::unique_lock<std::mutex> lock(_device_mutex);
+                while (_is_alive)
                 {
-                    try
+                    if (_is_device_removed)
                     {
-                        getDevice(_ctx.query_devices());
-                        if (_device)
-                        {
-                            std::function<void(rs2::event_information&)> change_device_callback_function = [this](rs2::event_information& info){changeDeviceCallback(info);};
-                            _ctx.set_devices_changed_callback(change_device_callback_function);
-                            startDevice();
-                        }
-                        else
+                        _is_device_removed = false;
+                        _connected_device = rs2::device();
+                        lock.unlock();
+                        closeDevice();
+                        lock.lock();
+                        backoff = min_backoff;
+                        continue;
+                    }
+                    if (!_device)
+                    {
+                        _is_query_needed = false;
+                        lock.unlock();
+                        try
                         {
-                            std::chrono::milliseconds actual_timespan(timespan);
-                            if (_wait_for_device_timeout > 0)
+                            getDevice(_ctx.query_devices());
+                            if (_device)
                             {
-                                auto time_to_timeout(_wait_for_device_timeout - (this->get_clock()->now() - first_try_time).seconds());
-                                if (time_to_timeout < 0)
-                                {
-                                    ROS_ERROR_STREAM("wait for device timeout of " << _wait_for_device_timeout << " secs expired");
-                                    exit(1);
-                                }
-                                else
+                                // Set before starting, which takes seconds: the device may be removed meanwhile.
                                 {
-                                    double max_timespan_secs(std::chrono::duration_cast<std::chrono::seconds>(timespan).count());
-                                    actual_timespan = std::chrono::milliseconds (static_cast<int>(std::min(max_timespan_secs, time_to_timeout) * 1e3));
+                                    std::lock_guard<std::mutex> lock_guard(_device_mutex);
+                                    _connected_device = _device;
                                 }
+                                startOrReconnectDevice();
                             }
-                            std::this_thread::sleep_for(actual_timespan);
                         }
+                        catch(const std::exception& e)
+                        {
+                            ROS_ERROR_STREAM("Error starting device: " << e.what());
+                            _realSenseNode.reset(nullptr);
+                            _device = rs2::device();
+                        }
+                        lock.lock();
+                        if (_device)
+                        {
+                            was_device_found = true;
+                            backoff = min_backoff;
+                            continue;
+                        }
+                        // The failed device is queried again: a removal seen while starting it is moot.
+                        _connected_device = rs2::device();
+                        _is_device_removed = false;
                     }
-                    catch(const std::exception& e)
+
+                    auto is_event = [this]{return !_is_alive || _is_device_removed || (_is_query_needed && !_device);};
+                    if (_device)
                     {
-                        ROS_ERROR_STREAM("Error starting device: " << e.what());
+                        _cv_device.wait(lock, is_event);
+                        continue;
                     }
+                    double wait_time(backoff);
+                    if (!was_device_found && _wait_for_device_timeout > 0)
+                    {
+                        auto time_to_timeout(_wait_for_device_timeout - (this->get_clock()->now() - first_try_time).seconds());
+                        if (time_to_timeout < 0)
+                        {
+                            ROS_ERROR_STREAM("wait for device timeout of " << _wait_for_device_timeout << " secs expired");
+                            exit(1);
+                        }
+                        wait_time = std::min(wait_time, time_to_timeout);
+                    }
+                    _cv_device.wait_for(lock, std::chrono::duration<double>(wait_time), is_event);
+                    backoff = std::min(backoff * 2, _reconnect_timeout);
                 }
             });
         }
@@ -349,6 +453,109 @@ void RealSenseNodeFactory::init()
     }
 }
 
+void RealSenseNodeFactory::startSharedContextDiscovery()
+{
+    ROS_INFO("Devices are discovered through the context shared by the nodes of the process");
+    _device_registry = DeviceRegistry::getInstance();
+
+    // Registered before _query_thread starts, which reads _registry_client_id.
+    // The registry calls these with its own mutex held: the registry must never be called with _device_mutex held.
+    _registry_client_id = _device_registry->addClient(
+        [this](rs2::device dev)
+        {
+            std::lock_guard<std::mutex> lock_guard(_device_mutex);
+            return isRequestedDevice(dev);
+        },
+        [this](rs2::device dev)
+        {
+            std::lock_guard<std::mutex> lock_guard(_device_mutex);
+            _serial_no = dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
+            _given_device = dev;
+            _cv_device.notify_one();
+        },
+        [this]()
+        {
+            std::lock_guard<std::mutex> lock_guard(_device_mutex);
+            _is_device_removed = true;
+            _cv_device.notify_one();
+        });
+
+    // The registry callbacks only hand the device over: the node is started and closed by _query_thread,
+    // so that the nodes of the process start concurrently.
+    _query_thread = std::thread([this]()
+    {
+        rclcpp::Time first_try_time = this->get_clock()->now();
+        bool was_device_found(false);
+        std::unique_lock<std::mutex> lock(_device_mutex);
+        while (_is_alive)
+        {
+            if (_is_device_removed)
+            {
+                _is_device_removed = false;
+                lock.unlock();
+                closeDevice();
+                lock.lock();
+                continue;
+            }
+            if (_given_device)
+            {
+                rs2::device dev(_given_device);
+                _given_device = rs2::device();
+                lock.unlock();
+                if (_initial_reset)
+                {
+                    _initial_reset = false;
+                    _device_registry->hardwareReset(_registry_client_id, dev, _initial_reset_stagger);
+                    lock.lock();
+                    continue;
+                }
+                _device = dev;
+                logDeviceUsbType();
+                try
+                {
+                    startOrReconnectDevice();
+                }
+                catch(const std::exception& e)
+                {
+                    ROS_ERROR_STREAM("Error starting device: " << e.what());
+                    _realSenseNode.reset(nullptr);
+                    _device = rs2::device();
+                }
+                lock.lock();
+                if (_device)
+                {
+                    was_device_found = true;
+                }
+                else
+                {
+                    // Given again after reconnect_timeout, once a reset device is back
+                    _cv_device.wait_for(lock, std::chrono::milliseconds(static_cast<int>(_reconnect_timeout*1e3)), [this]{return !_is_alive;});
+                    lock.unlock();
+                    _device_registry->releaseDevice(_registry_client_id);
+                    lock.lock();
+                }
+                continue;
+            }
+
+            auto is_event = [this]{return !_is_alive || _is_device_removed || _given_device;};
+            if (!was_device_found && _wait_for_device_timeout > 0)
+            {
+                auto time_to_timeout(_wait_for_device_timeout - (this->get_clock()->now() - first_try_time).seconds());
+                if (time_to_timeout < 0)
+                {
+                    ROS_ERROR_STREAM("wait for device timeout of " << _wait_for_device_timeout << " secs expired");
+                    exit(1);
+                }
+                _cv_device.wait_for(lock, std::chrono::duration<double>(time_to_timeout), is_event);
+            }
+            else
+            {
+                _cv_device.wait(lock, is_event);
+            }
+        }
+    });
+}
+
 void RealSenseNodeFactory::startDevice()
 {
     if (_realSenseNode) _realSenseNode.reset();
@@ -45,7 +45,8 @@ RosSensor::RosSensor(rs2::sensor sensor,
     std::shared_ptr<diagnostic_updater::Updater> diagnostics_updater,
     rclcpp::Logger logger,
     bool force_image_default_qos,
-    bool is_rosbag_file):
+    bool is_rosbag_file,
+    std::shared_ptr<OptionsCache> options_cache):
     rs2::sensor(sensor),
     _logger(logger),
     _origin_frame_callback(frame_callback),
@@ -53,7 +54,9 @@ RosSensor::RosSensor(rs2::sensor sensor,
     _update_sensor_func(update_sensor_func),
     _hardware_reset_func(hardware_reset_func),
     _diagnostics_updater(diagnostics_updater),
-    _force_image_default_qos(force_image_default_qos)
+    _force_image_default_qos(force_image_default_qos),
+    _options_cache(options_cache),
+    _is_options_cached(false)
 {
     _frame_callback = [this](rs2::frame frame)
         {
@@ -93,7 +96,22 @@ void RosSensor::setParameters(bool is_rosbag_file)
         set_option(RS2_OPTION_HDR_ENABLED, false);
     }
 
-    _params.registerDynamicOptions(*this, module_name);
+    // The options enumeration is taken from the cache if there, and queried from the sensor otherwise.
+    // Either way, the current values are read from the sensor.
+    SensorOptionsInfo options;
+    _is_options_cached = _options_cache && _options_cache->get(module_name, options);
+    if (_is_options_cached)
+    {
+        ROS_DEBUG_STREAM("Options of " << module_name << " are taken from " << _options_cache->getFilePath());
+        _cached_options = options;
+    }
+    else
+    {
+        options = _params.queryOptions(*this);
+        if (_options_cache)
+            _options_cache->set(module_name, options);
+    }
+    _params.registerDynamicOptions(*this, module_name, options);
 
     // for rosbag files, don't set hdr(sequence_id) / gain / exposure options
     // since these options can be changed only in real devices
@@ -103,6 +121,20 @@ void RosSensor::setParameters(bool is_rosbag_file)
     registerSensorParameters();
 }
 
+bool RosSensor::validateCachedOptions()
+{
+    if (!_is_options_cached)
+        return false;
+    std::string module_name = create_graph_resource_name(rs2_to_ros(get_info(RS2_CAMERA_INFO_NAME)));
+    SensorOptionsInfo options = _params.queryOptions(*this);
+    if (options == _cached_options)
+        return false;
+    ROS_WARN_STREAM("Options of " << module_name << " differ from the ones cached in " << _options_cache->getFilePath()
+                    << ". The cache is updated, restart the node for the parameters to match them.");
+    _options_cache->set(module_name, options);
+    return true;
+}
+
 void RosSensor::UpdateSequenceIdCallback()
 {
     // Function replaces the trivial parameter callback with one that 
@@ -180,7 +212,7 @@ void RosSensor::set_sensor_parameter_to_ros(rs2_option option)
     std::string module_name = create_graph_resource_name(rs2_to_ros(get_info(RS2_CAMERA_INFO_NAME)));
     const std::string option_name(module_name + "." + create_graph_resource_name(rs2_option_to_string(option)));
     auto value = static_cast<T>(get_option(option));
-    _params.getParameters()->setRosParamValue(option_name, &value);
+    _params.getParameters()->queueSetRosValue(option_name, value);
 }
 
 
@@ -311,6 +343,18 @@ rmw_qos_profile_t RosSensor::getInfoQOS(const stream_index_pair& sip) const
     throw std::runtime_error("Given stream has no profile manager: " + std::string(rs2_stream_to_string(sip.first)) + "." + std::to_string(sip.second));
 }
 
+std::string RosSensor::getVideoEncoder(const stream_index_pair& sip) const
+{
+    for(auto& profile_manager : _profile_managers)
+    {
+        if (profile_manager->hasSIP(sip))
+        {
+            return profile_manager->getVideoEncoder(sip);
+        }
+    }
+    throw std::runtime_error("Given stream has no profile manager: " + std::string(rs2_stream_to_string(sip.first)) + "." + std::to_string(sip.second));
+}
+
 bool profiles_equal(const rs2::stream_profile& a, const rs2::stream_profile& b)
 {
     if (a.is<rs2::video_stream_profile>() && b.is<rs2::video_stream_profile>())
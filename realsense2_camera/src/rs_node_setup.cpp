@@ -14,7 +14,9 @@
 
 #include "../include/base_realsense_node.h"
 #include <image_publisher.h>
+#include <video_encoder_publisher.h>
 #include <fstream>
+#include <sstream>
 #include <rclcpp/qos.hpp>
 
 using namespace realsense2_camera;
@@ -22,24 +24,51 @@ using namespace rs2;
 
 void BaseRealSenseNode::setup()
 {
+    setupStreamDescriptors();
     setDynamicParams();
+    setupPipeline();
+    setupParallelPublish();
     startDiagnosticsUpdater();
     setAvailableSensors();
     SetBaseStream();
     setupFilters();
+    setupMultiCameraSync();
     setCallbackFunctions();
     monitoringProfileChanges();
+    monitoringGraphChanges();
+    monitoringLatencyStats();
     updateSensors();
     publishServices();
+    validateOptionsCache();
+}
+
+void BaseRealSenseNode::setupStreamDescriptors()
+{
+    // The frame IDs only depend on the camera name: set for all the streams, started or not,
+    // so that the frame threads never see them change.
+    for (int stream = 0; stream < RS2_STREAM_COUNT; ++stream)
+    {
+        for (int index = 0; index < STREAM_INDEX_COUNT; ++index)
+        {
+            stream_index_pair sip(static_cast<rs2_stream>(stream), index);
+            _stream_descriptors[streamSlot(sip)].sip = sip;
+            _stream_descriptors[streamSlot(sip)].optical_frame_id = OPTICAL_FRAME_ID(sip);
+        }
+    }
+    _stream_descriptors[NO_STREAM_SLOT].optical_frame_id = _camera_name + "_optical_frame";
+    _imu_optical_frame_id = IMU_OPTICAL_FRAME_ID;
 }
 
 void BaseRealSenseNode::monitoringProfileChanges()
 {
-    int time_interval(10000);
-    std::function<void()> func = [this, time_interval](){
+    std::function<void()> func = [this](){
         std::unique_lock<std::mutex> lock(_profile_changes_mutex);
         while(_is_running) {
-            _cv_mpc.wait_for(lock, std::chrono::milliseconds(time_interval), [&]{return (!_is_running || _is_profile_changed || _is_align_depth_changed);});
+            _cv_mpc.wait(lock, [&]{return (!_is_running || _is_profile_changed || _is_align_depth_changed);});
+            // The changes made within profile_change_debounce seconds of the first one are applied together,
+            // e.g. a launch setting both the profile and the fps restarts the sensor once.
+            if (_is_running && _profile_change_debounce > 0)
+                _cv_mpc.wait_for(lock, std::chrono::duration<double>(_profile_change_debounce), [&]{return !_is_running;});
             if (_is_running && (_is_profile_changed || _is_align_depth_changed))
             {
                 ROS_DEBUG("Profile has changed");
@@ -59,6 +88,77 @@ void BaseRealSenseNode::monitoringProfileChanges()
     _monitoring_pc = std::make_shared<std::thread>(func);
 }
 
+void BaseRealSenseNode::monitoringGraphChanges()
+{
+    if (!_enable_lazy_filters) return;
+
+    // Subscribers joining or leaving raise a graph event: the filters demand is counted again on this thread.
+    // If graph events are not available, the subscribers are polled instead.
+    std::function<void()> func = [this](){
+        auto graph_event = _node.get_graph_event();
+        bool is_polling(false);
+        while(_is_running) {
+            if (is_polling)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                _is_filters_demand_stale = true;
+            }
+            else
+            {
+                try
+                {
+                    _node.wait_for_graph_change(graph_event, std::chrono::milliseconds(500));
+                    if (graph_event->check_and_clear())
+                        _is_filters_demand_stale = true;
+                }
+                catch(const std::exception& e)
+                {
+                    ROS_WARN_STREAM("Error waiting for graph changes: " << e.what() << ". Polling the subscribers instead.");
+                    is_polling = true;
+                }
+            }
+            if (_is_filters_demand_stale && _is_running)
+                updateFiltersDemand();
+        }
+    };
+    _monitoring_graph = std::make_shared<std::thread>(func);
+}
+
+void BaseRealSenseNode::monitoringLatencyStats()
+{
+    if (_latency_stats_publish_period <= 0) return;
+
+    // The latencies are published while latency_stats.enable is set, and only if the topic has subscribers.
+    _latency_stats_publisher = _node.create_publisher<diagnostic_msgs::msg::DiagnosticArray>("~/latency_stats", rclcpp::QoS(1));
+    std::function<void()> func = [this](){
+        const std::string serial_no = _dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER);
+        std::unique_lock<std::mutex> lock(_latency_stats_mutex);
+        while(_is_running) {
+            _cv_latency.wait_for(lock, std::chrono::duration<double>(_latency_stats_publish_period), [&]{return !_is_running;});
+            if (!_is_running || !_enable_latency_stats || 0 == _latency_stats_publisher->get_subscription_count())
+                continue;
+
+            diagnostic_msgs::msg::DiagnosticArray msg;
+            msg.header.stamp = _node.now();
+            for (auto& entry : _latency_stats.getEntries())
+            {
+                diagnostic_updater::DiagnosticStatusWrapper status;
+                status.name = entry.stage + "/" + entry.stream;
+                status.hardware_id = serial_no;
+                status.summary(0, "OK");
+                status.add("count", entry.summary.count);
+                status.add("p50_ms", entry.summary.p50_ms);
+                status.add("p95_ms", entry.summary.p95_ms);
+                status.add("p99_ms", entry.summary.p99_ms);
+                status.add("max_ms", entry.summary.max_ms);
+                msg.status.push_back(status);
+            }
+            _latency_stats_publisher->publish(msg);
+        }
+    };
+    _monitoring_latency = std::make_shared<std::thread>(func);
+}
+
 void BaseRealSenseNode::setAvailableSensors()
 {
     if (!_json_file_path.empty())
@@ -104,6 +204,7 @@ void BaseRealSenseNode::setAvailableSensors()
     ROS_INFO_STREAM("Sync Mode: " << ((_sync_frames)?"On":"Off"));
 
     std::function<void(rs2::frame)> frame_callback_function = [this](rs2::frame frame){
+        recordRawFrame(frame);
         bool is_filter(_filters.end() != find_if(_filters.begin(), _filters.end(), [](std::shared_ptr<NamedFilter> f){return (f->is_enabled()); }));
         if (_sync_frames || is_filter)
             this->_asyncer.invoke(frame);
@@ -112,6 +213,7 @@ void BaseRealSenseNode::setAvailableSensors()
     };
 
     std::function<void(rs2::frame)> imu_callback_function = [this](rs2::frame frame){
+        recordRawFrame(frame);
         imu_callback(frame);
         if (_imu_sync_method != imu_sync_method::NONE)
             imu_callback_sync(frame);
@@ -129,31 +231,83 @@ void BaseRealSenseNode::setAvailableSensors()
 
     std::function<void()> hardware_reset_func = [this](){hardwareResetRequest();};
 
+    // The options of a real device are cached by serial number and firmware version
+    bool is_options_cache_loaded(false);
+    if (!_options_cache_dir.empty() && !_dev.is<playback>())
+    {
+        rs2_error* e = nullptr;
+        _options_cache = std::make_shared<OptionsCache>(OptionsCache::filePath(_options_cache_dir, serial_no, fw_ver),
+                                                        "librealsense " + std::to_string(rs2_get_api_version(&e)));
+        is_options_cache_loaded = _options_cache->load();
+        ROS_INFO_STREAM("Options cache " << _options_cache->getFilePath() << (is_options_cache_loaded ? " is loaded" : " is not found or invalid"));
+    }
+
     _dev_sensors = _dev.query_sensors();
 
     for(auto&& sensor : _dev_sensors)
     {
         const std::string module_name(rs2_to_ros(sensor.get_info(RS2_CAMERA_INFO_NAME)));
         std::unique_ptr<RosSensor> rosSensor;
+        // The software sensors of a raw recording playback are only known by their streams
+        std::vector<rs2::stream_profile> profiles(sensor.get_stream_profiles());
+        const bool is_motion_sensor(sensor.is<rs2::motion_sensor>() ||
+                                    (!profiles.empty() && profiles.front().is<rs2::motion_stream_profile>()));
         if (sensor.is<rs2::depth_sensor>() ||
-            sensor.is<rs2::color_sensor>())
+            sensor.is<rs2::color_sensor>() ||
+            (!is_motion_sensor && !profiles.empty() && profiles.front().is<rs2::video_stream_profile>()))
         {
             ROS_DEBUG_STREAM("Set " << module_name << " as VideoSensor.");
-            rosSensor = std::make_unique<RosSensor>(sensor, _parameters, frame_callback_function, update_sensor_func, hardware_reset_func, _diagnostics_updater, _logger, _use_intra_process, _dev.is<playback>());
+            rosSensor = std::make_unique<RosSensor>(sensor, _parameters, frame_callback_function, update_sensor_func, hardware_reset_func, _diagnostics_updater, _logger, _use_intra_process, _dev.is<playback>(), _options_cache);
         }
-        else if (sensor.is<rs2::motion_sensor>())
+        else if (is_motion_sensor)
         {
             ROS_DEBUG_STREAM("Set " << module_name << " as ImuSensor.");
-            rosSensor = std::make_unique<RosSensor>(sensor, _parameters, imu_callback_function, update_sensor_func, hardware_reset_func, _diagnostics_updater, _logger, false, _dev.is<playback>());
+            rosSensor = std::make_unique<RosSensor>(sensor, _parameters, imu_callback_function, update_sensor_func, hardware_reset_func, _diagnostics_updater, _logger, false, _dev.is<playback>(), _options_cache);
         }
         else
         {
             ROS_WARN_STREAM("Module Name \"" << module_name << "\" does not define a callback.");
             continue;
         }
+        is_options_cache_loaded = is_options_cache_loaded && rosSensor->isOptionsCached();
         _available_ros_sensors.push_back(std::move(rosSensor));
     }
 
+    // Saved once all the sensors are queried, so that the next runs find them all
+    if (_options_cache && !is_options_cache_loaded)
+    {
+        if (_options_cache->save())
+            ROS_INFO_STREAM("Options cache " << _options_cache->getFilePath() << " is saved");
+        else
+            ROS_WARN_STREAM("Failed to save the options cache " << _options_cache->getFilePath());
+    }
+}
+
+void BaseRealSenseNode::validateOptionsCache()
+{
+    if (!_options_cache) return;
+
+    // The options taken from the cache are queried again once the node is up, while the streams are starting.
+    std::function<void()> func = [this](){
+        bool is_changed(false);
+        for (auto&& sensor : _available_ros_sensors)
+        {
+            if (!_is_running)
+                return;
+            try
+            {
+                is_changed = sensor->validateCachedOptions() || is_changed;
+            }
+            catch(const std::exception& e)
+            {
+                ROS_WARN_STREAM("Error validating the options cache: " << e.what());
+                return;
+            }
+        }
+        if (is_changed && !_options_cache->save())
+            ROS_WARN_STREAM("Failed to save the options cache " << _options_cache->getFilePath());
+    };
+    _options_cache_validation = std::make_shared<std::thread>(func);
 }
 
 void BaseRealSenseNode::setCallbackFunctions()
@@ -166,25 +320,28 @@ void BaseRealSenseNode::setCallbackFunctions()
 
 void BaseRealSenseNode::stopPublishers(const std::vector<stream_profile>& profiles)
 {
+    _is_filters_demand_stale = true;
     for (auto& profile : profiles)
     {
         stream_index_pair sip(profile.stream_type(), profile.stream_index());
         if (profile.is<rs2::video_stream_profile>())
         {
-            _image_publishers.erase(sip);
-            _info_publishers.erase(sip);
-            _depth_aligned_image_publishers.erase(sip);
-            _depth_aligned_info_publisher.erase(sip);
+            StreamDescriptor& descriptor(_stream_descriptors[streamSlot(sip)]);
+            descriptor.output = StreamOutput();
+            descriptor.aligned_depth_output = StreamOutput();
         }
         else if (profile.is<rs2::motion_stream_profile>())
         {
             _is_accel_enabled = false;
             _is_gyro_enabled = false;
             _synced_imu_publisher.reset();
+            _synced_imu_batcher.reset();
             _imu_publishers.erase(sip);
+            _imu_batchers.erase(sip);
             _imu_info_publishers.erase(sip);
         }
         _metadata_publishers.erase(sip);
+        _metadata_values_publishers.erase(sip);
         _extrinsics_publishers.erase(sip);
 
         if (_publish_tf)
@@ -196,17 +353,29 @@ void BaseRealSenseNode::stopPublishers(const std::vector<stream_profile>& profil
 
 void BaseRealSenseNode::startPublishers(const std::vector<stream_profile>& profiles, const RosSensor& sensor)
 {
+    _is_filters_demand_stale = true;
     const std::string module_name(create_graph_resource_name(rs2_to_ros(sensor.get_info(RS2_CAMERA_INFO_NAME))));
     for (auto& profile : profiles)
     {
         stream_index_pair sip(profile.stream_type(), profile.stream_index());
         std::string stream_name(STREAM_NAME(sip));
 
+        // The publishers of a stream that is streamed again are kept, so that its subscribers stay connected
+        auto kept_profile = std::find_if(_kept_profiles.begin(), _kept_profiles.end(), [&sip](const rs2::stream_profile& p)
+        {
+            return stream_index_pair(p.stream_type(), p.stream_index()) == sip;
+        });
+        bool is_kept(kept_profile != _kept_profiles.end());
+        if (is_kept)
+            _kept_profiles.erase(kept_profile);
+
         rmw_qos_profile_t qos = sensor.getQOS(sip);
         rmw_qos_profile_t info_qos = sensor.getInfoQOS(sip);
 
         if (profile.is<rs2::video_stream_profile>())
         {
+            StreamDescriptor& descriptor(_stream_descriptors[streamSlot(sip)]);
+            descriptor.sip = sip;
             if(profile.stream_type() == RS2_STREAM_COLOR)
                 _is_color_enabled = true;
             else if (profile.stream_type() == RS2_STREAM_DEPTH)
@@ -221,23 +390,29 @@ void BaseRealSenseNode::startPublishers(const std::vector<stream_profile>& profi
             image_raw << "~/" << stream_name << "/image_" << ((rectified_image)?"rect_":"") << "raw";
             camera_info << "~/" << stream_name << "/camera_info";
 
-            // We can use 2 types of publishers:
-            // Native RCL publisher that support intra-process zero-copy comunication
-            // image-transport package publisher that adds a commpressed image topic if package is found installed
-            if (_use_intra_process)
+            if (!is_kept)
             {
-                _image_publishers[sip] = std::make_shared<image_rcl_publisher>(_node, image_raw.str(), qos);
+                descriptor.output.image = createImagePublisher(image_raw.str(), qos, sensor.getVideoEncoder(sip), profile.fps());
+
+                descriptor.output.info = _node.create_publisher<sensor_msgs::msg::CameraInfo>(camera_info.str(),
+                                        rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
             }
-            else
+            descriptor.output.format = profile.format();
+            descriptor.output.encoding = formatTraits(profile.format()).encoding;
+            descriptor.output.latency = {_latency_stats.getHistogram("callback", stream_name),
+                                         _latency_stats.getHistogram("fill", stream_name),
+                                         _latency_stats.getHistogram("publish", stream_name)};
             {
-                _image_publishers[sip] = std::make_shared<image_transport_publisher>(_node, image_raw.str(), qos);
-                ROS_DEBUG_STREAM("image transport publisher was created for topic" << image_raw.str());
+                // Filled by updateProfilesStreamCalibData(), once the publishers are started. The map entries are never erased.
+                std::lock_guard<std::mutex> lock_guard(_camera_info_mutex);
+                descriptor.camera_info = &_camera_info[sip];
             }
 
-            _info_publishers[sip] = _node.create_publisher<sensor_msgs::msg::CameraInfo>(camera_info.str(),
-                                    rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
-
-            if (_align_depth_filter->is_enabled() && (sip != DEPTH) && sip.second < 2)
+            if (!_align_depth_filter->is_enabled() || (sip == DEPTH) || sip.second >= 2)
+            {
+                descriptor.aligned_depth_output = StreamOutput();
+            }
+            else if (!descriptor.aligned_depth_output.image)
             {
                 std::stringstream aligned_image_raw, aligned_camera_info;
                 aligned_image_raw << "~/" << "aligned_depth_to_" << stream_name << "/image_raw";
@@ -245,20 +420,14 @@ void BaseRealSenseNode::startPublishers(const std::vector<stream_profile>& profi
 
                 std::string aligned_stream_name = "aligned_depth_to_" + stream_name;
 
-                // We can use 2 types of publishers:
-                // Native RCL publisher that support intra-process zero-copy comunication
-                // image-transport package publisher that add's a commpressed image topic if the package is installed
-                if (_use_intra_process)
-                {
-                    _depth_aligned_image_publishers[sip] = std::make_shared<image_rcl_publisher>(_node, aligned_image_raw.str(), qos);
-                }
-                else
-                {
-                    _depth_aligned_image_publishers[sip] = std::make_shared<image_transport_publisher>(_node, aligned_image_raw.str(), qos);
-                    ROS_DEBUG_STREAM("image transport publisher was created for topic" << image_raw.str());
-                }
-                _depth_aligned_info_publisher[sip] = _node.create_publisher<sensor_msgs::msg::CameraInfo>(aligned_camera_info.str(),
+                descriptor.aligned_depth_output.image = createImagePublisher(aligned_image_raw.str(), qos);
+                descriptor.aligned_depth_output.info = _node.create_publisher<sensor_msgs::msg::CameraInfo>(aligned_camera_info.str(),
                     rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
+                descriptor.aligned_depth_output.format = RS2_FORMAT_Z16;
+                descriptor.aligned_depth_output.encoding = formatTraits(RS2_FORMAT_Z16).encoding;
+                descriptor.aligned_depth_output.latency = {nullptr,
+                                                           _latency_stats.getHistogram("fill", aligned_stream_name),
+                                                           _latency_stats.getHistogram("publish", aligned_stream_name)};
             }
         }
         else if (profile.is<rs2::motion_stream_profile>())
@@ -270,20 +439,36 @@ void BaseRealSenseNode::startPublishers(const std::vector<stream_profile>& profi
 
             std::stringstream data_topic_name, info_topic_name;
             data_topic_name << "~/" << stream_name << "/sample";
-            _imu_publishers[sip] = _node.create_publisher<sensor_msgs::msg::Imu>(data_topic_name.str(),
-                rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos));
-            // Publish Intrinsics:
             info_topic_name << "~/" << stream_name << "/imu_info";
-            _imu_info_publishers[sip] = _node.create_publisher<IMUInfo>(info_topic_name.str(),
-                                        rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
+            if (!is_kept)
+            {
+                _imu_publishers[sip] = _node.create_publisher<sensor_msgs::msg::Imu>(data_topic_name.str(),
+                    rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos));
+                _imu_info_publishers[sip] = _node.create_publisher<IMUInfo>(info_topic_name.str(),
+                                            rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
+            }
+            // Publish Intrinsics:
             IMUInfo info_msg = getImuInfo(profile);
             _imu_info_publishers[sip]->publish(info_msg);
+            if (_imu_batch_size > 0 && !(is_kept && _imu_batchers.find(sip) != _imu_batchers.end()))
+            {
+                std::string batch_topic_name("~/" + stream_name + "/sample_batch");
+                _imu_batchers[sip] = std::make_shared<ImuBatcher>(_node.create_publisher<realsense2_camera_msgs::msg::ImuBatch>(batch_topic_name,
+                    rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos)), _imu_batch_size, _imu_batch_period);
+            }
+        }
+        if (!is_kept)
+        {
+            std::string topic_metadata("~/" + stream_name + "/metadata");
+            _metadata_publishers[sip] = _node.create_publisher<realsense2_camera_msgs::msg::Metadata>(topic_metadata, 
+                rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
+            std::string topic_metadata_values("~/" + stream_name + "/metadata_values");
+            _metadata_values_publishers[sip] = _node.create_publisher<realsense2_camera_msgs::msg::MetadataValues>(topic_metadata_values,
+                rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
         }
-        std::string topic_metadata("~/" + stream_name + "/metadata");
-        _metadata_publishers[sip] = _node.create_publisher<realsense2_camera_msgs::msg::Metadata>(topic_metadata, 
-            rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(info_qos), info_qos));
 
-        if (!((rs2::stream_profile)profile==(rs2::stream_profile)_base_profile))
+        if (!((rs2::stream_profile)profile==(rs2::stream_profile)_base_profile) &&
+            !(is_kept && _extrinsics_publishers.find(sip) != _extrinsics_publishers.end()))
         {
 
             // intra-process do not support latched QoS, so we need to disable intra-process for this topic
@@ -296,16 +481,66 @@ void BaseRealSenseNode::startPublishers(const std::vector<stream_profile>& profi
                 rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(extrinsics_qos), extrinsics_qos), std::move(options));
         }
     }
-    if (_is_accel_enabled && _is_gyro_enabled && (_imu_sync_method > imu_sync_method::NONE))
+    if (_is_accel_enabled && _is_gyro_enabled && (_imu_sync_method > imu_sync_method::NONE) && !_synced_imu_publisher)
     {
         rmw_qos_profile_t qos = _use_intra_process ? qos_string_to_qos(DEFAULT_QOS) : qos_string_to_qos(HID_QOS);
         
         _synced_imu_publisher = std::make_shared<SyncedImuPublisher>(_node.create_publisher<sensor_msgs::msg::Imu>("~/imu", 
                                                         rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos)));
+        if (_imu_batch_size > 0)
+        {
+            _synced_imu_batcher = std::make_shared<ImuBatcher>(_node.create_publisher<realsense2_camera_msgs::msg::ImuBatch>("~/imu_batch",
+                rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos)), _imu_batch_size, _imu_batch_period);
+        }
     }
 
 }
 
+std::shared_ptr<image_publisher> BaseRealSenseNode::createImagePublisher(const std::string& topic_name, const rmw_qos_profile_t& qos,
+                                                                          const std::string& video_encoder, int fps)
+{
+    if (!video_encoder.empty())
+    {
+        // The images are also published as a video, encoded by the <stream>_video_encoder of the stream
+        video_encoder_settings settings{video_encoder, _video_encoder_bitrate, _video_encoder_gop_size, fps};
+        auto video_publisher = std::make_shared<video_encoder_publisher>(_node, topic_name, qos, settings, createImagePublisher(topic_name, qos));
+        ROS_DEBUG_STREAM("video encoder publisher was created for topic " << topic_name << " with " << video_encoder);
+        return video_publisher;
+    }
+
+    // We can use 2 types of publishers:
+    // Native RCL publisher that support intra-process zero-copy comunication and middleware loaned messages
+    // image-transport package publisher that adds a commpressed image topic if package is found installed
+    if (_use_intra_process)
+    {
+        return std::make_shared<image_rcl_publisher>(_node, topic_name, qos);
+    }
+    if (_use_loaned_messages && canLoanImageMessages(qos))
+    {
+        auto loaned_publisher = std::make_shared<image_rcl_publisher>(_node, topic_name, qos, true);
+        ROS_DEBUG_STREAM("loaned messages publisher was created for topic" << topic_name);
+        return loaned_publisher;
+    }
+    auto transport_publisher = std::make_shared<image_transport_publisher>(_node, topic_name, qos);
+    ROS_DEBUG_STREAM("image transport publisher was created for topic" << topic_name);
+    return transport_publisher;
+}
+
+bool BaseRealSenseNode::canLoanImageMessages(const rmw_qos_profile_t& qos)
+{
+    // Whether the middleware loans a type doesn't depend on the topic: asked once, on a probe publisher,
+    // rather than creating and dropping a publisher on every image topic that can't loan.
+    if (_can_loan_image_messages < 0)
+    {
+        auto probe_publisher = _node.create_publisher<sensor_msgs::msg::Image>("~/_loaned_messages_probe",
+            rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos));
+        _can_loan_image_messages = probe_publisher->can_loan_messages() ? 1 : 0;
+        if (!_can_loan_image_messages)
+            ROS_WARN_STREAM("The middleware cannot loan image messages. Using image transport publishers instead.");
+    }
+    return _can_loan_image_messages > 0;
+}
+
 void BaseRealSenseNode::startRGBDPublisherIfNeeded()
 {
     _rgbd_publisher.reset();
@@ -325,6 +560,101 @@ void BaseRealSenseNode::startRGBDPublisherIfNeeded()
              "you should enable: color stream, depth stream, sync_mode and align_depth");
         }
     }
+
+    // The node is in the group while it makes RGBD messages: the other members don't wait for its frames otherwise
+    if (_multi_camera_syncer)
+    {
+        if (_rgbd_publisher)
+            _multi_camera_syncer->addMember(_camera_name, _multi_rgbd_publisher);
+        else
+            _multi_camera_syncer->removeMember(_camera_name);
+    }
+}
+
+void BaseRealSenseNode::startRawRecording()
+{
+    if (_raw_record_dir.empty())
+        return;
+    std::vector<rs2::sensor> sensors;
+    for (auto&& sensor : _available_ros_sensors)
+        sensors.push_back(*sensor);
+    // A new recording for each set of streams, named after the device and the time it started
+    std::ostringstream dir_path;
+    dir_path << _raw_record_dir << "/" << _dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER) << "_"
+             << static_cast<int64_t>(_node.now().seconds()) << "_" << _raw_recordings_count++;
+    std::shared_ptr<RawRecorder> recorder;
+    try
+    {
+        recorder = std::make_shared<RawRecorder>(dir_path.str(), static_cast<size_t>(_raw_record_segment_size) << 20, _dev, sensors);
+        ROS_INFO_STREAM("Recording the frames to " << dir_path.str());
+    }
+    catch(const std::exception& ex)
+    {
+        ROS_ERROR_STREAM("Failed to start the raw recording: " << ex.what());
+    }
+    std::lock_guard<std::mutex> lock_guard(_raw_recorder_mutex);
+    _raw_recorder = recorder;
+}
+
+void BaseRealSenseNode::recordRawFrame(const rs2::frame& frame)
+{
+    std::shared_ptr<RawRecorder> recorder;
+    {
+        std::lock_guard<std::mutex> lock_guard(_raw_recorder_mutex);
+        recorder = _raw_recorder;
+    }
+    if (recorder)
+        recorder->record(frame);
+}
+
+void BaseRealSenseNode::setupMultiCameraSync()
+{
+    if (_multi_camera_sync_group.empty())
+        return;
+    if (!_enable_rgbd)
+        ROS_WARN_STREAM("multi_camera_sync_group is set, but the camera is only in the group while enable_rgbd is true");
+    rmw_qos_profile_t qos = _use_intra_process ? qos_string_to_qos(DEFAULT_QOS) : qos_string_to_qos(IMAGE_QOS);
+    _multi_rgbd_publisher = _node.create_publisher<realsense2_camera_msgs::msg::MultiRGBD>(
+        MultiCameraSyncer::topicName(_multi_camera_sync_group),
+        rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(qos), qos));
+    _multi_camera_syncer = MultiCameraSyncer::getInstance(_multi_camera_sync_group, _multi_camera_sync_tolerance,
+                                                          MULTI_CAMERA_SYNC_QUEUE_SIZE);
+    ROS_INFO_STREAM("Camera " << _camera_name << " is synced with the cameras of group " << _multi_camera_sync_group
+                    << " on " << MultiCameraSyncer::topicName(_multi_camera_sync_group));
+}
+
+void BaseRealSenseNode::diffProfiles(const RosSensor& sensor,
+                                     const std::vector<stream_profile>& active_profiles,
+                                     const std::vector<stream_profile>& wanted_profiles,
+                                     std::vector<stream_profile>& removed_profiles,
+                                     std::vector<stream_profile>& added_profiles)
+{
+    auto find_sip = [](const std::vector<stream_profile>& profiles, const stream_profile& profile)
+    {
+        return std::find_if(profiles.begin(), profiles.end(), [&profile](const stream_profile& p)
+        {
+            return p.stream_type() == profile.stream_type() && p.stream_index() == profile.stream_index();
+        });
+    };
+    std::vector<stream_profile> kept_profiles;
+    for (auto& profile : active_profiles)
+    {
+        auto wanted_profile = find_sip(wanted_profiles, profile);
+        // A video encoder is made for the fps of the stream
+        bool is_kept(wanted_profile != wanted_profiles.end() &&
+                     (wanted_profile->fps() == profile.fps() ||
+                      sensor.getVideoEncoder(stream_index_pair(profile.stream_type(), profile.stream_index())).empty()));
+        if (is_kept)
+            kept_profiles.push_back(profile);
+        else
+            removed_profiles.push_back(profile);
+    }
+    for (auto& profile : wanted_profiles)
+    {
+        if (find_sip(kept_profiles, profile) == kept_profiles.end())
+            added_profiles.push_back(profile);
+    }
+    _kept_profiles.insert(_kept_profiles.end(), kept_profiles.begin(), kept_profiles.end());
 }
 
 void BaseRealSenseNode::updateSensors()
@@ -340,12 +670,15 @@ void BaseRealSenseNode::updateSensors()
             bool is_profile_changed(sensor->getUpdatedProfiles(wanted_profiles));
             bool is_video_sensor = (sensor->is<rs2::depth_sensor>() || sensor->is<rs2::color_sensor>());
 
-            // do all updates if profile has been changed, or if the align depth filter status has been changed
-            // and we are on a video sensor. TODO: explore better options to monitor and update changes
-            // without resetting the whole sensors and topics.
+            // do the updates if profile has been changed, or if the align depth filter status has been changed
+            // and we are on a video sensor.
             if (is_profile_changed || (_is_align_depth_changed && is_video_sensor))
             {
+                // Only the streams that are not streamed anymore lose their publishers and transforms,
+                // and only the new streams get theirs: e.g. a new fps keeps the stream's topics.
                 std::vector<stream_profile> active_profiles = sensor->get_active_streams();
+                std::vector<stream_profile> removed_profiles, added_profiles;
+                diffProfiles(*sensor, active_profiles, wanted_profiles, removed_profiles, added_profiles);
                 if(is_profile_changed)
                 {
                     // Start/stop sensors only if profile was changed
@@ -353,7 +686,8 @@ void BaseRealSenseNode::updateSensors()
                     ROS_INFO_STREAM("Stopping Sensor: " << module_name);
                     sensor->stop();
                 }
-                stopPublishers(active_profiles);
+                flushPipeline();    // framesets in process may still use the publishers
+                stopPublishers(removed_profiles);
 
                 if (!wanted_profiles.empty())
                 {
@@ -362,7 +696,7 @@ void BaseRealSenseNode::updateSensors()
                     if (_publish_tf)
                     {
                         std::lock_guard<std::mutex> lock_guard(_publish_tf_mutex);
-                        for (auto &profile : wanted_profiles)
+                        for (auto &profile : added_profiles)
                         {
                             calcAndAppendTransformMsgs(profile, _base_profile);
                         }
@@ -389,6 +723,7 @@ void BaseRealSenseNode::updateSensors()
             publishStaticTransforms();
         }
         startRGBDPublisherIfNeeded();
+        startRawRecording();
     }
     catch(const std::exception& ex)
     {
@@ -416,6 +751,7 @@ void BaseRealSenseNode::publishServices()
 void BaseRealSenseNode::getDeviceInfo(const realsense2_camera_msgs::srv::DeviceInfo::Request::SharedPtr,
                                             realsense2_camera_msgs::srv::DeviceInfo::Response::SharedPtr res)
 {
+    std::lock_guard<std::mutex> lock_guard(_update_sensor_mutex);     // _dev is replaced on reconnect
     res->device_name = _dev.supports(RS2_CAMERA_INFO_NAME) ? create_graph_resource_name(_dev.get_info(RS2_CAMERA_INFO_NAME)) : "";
     res->serial_number = _dev.supports(RS2_CAMERA_INFO_SERIAL_NUMBER) ? _dev.get_info(RS2_CAMERA_INFO_SERIAL_NUMBER) : "";
     res->firmware_version = _dev.supports(RS2_CAMERA_INFO_FIRMWARE_VERSION) ? _dev.get_info(RS2_CAMERA_INFO_FIRMWARE_VERSION) : "";
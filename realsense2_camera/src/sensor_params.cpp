@@ -18,59 +18,51 @@
 
 namespace realsense2_camera
 {
-bool is_checkbox(rs2::options sensor, rs2_option option)
+bool is_checkbox(const OptionInfo& info)
 {
-    rs2::option_range op_range = sensor.get_option_range(option);
-    return op_range.max == 1.0f &&
-        op_range.min == 0.0f &&
-        op_range.step == 1.0f;
+    return info.max == 1.0f &&
+        info.min == 0.0f &&
+        info.step == 1.0f;
 }
 
-bool is_enum_option(rs2::options sensor, rs2_option option)
+bool may_be_enum_option(const rs2::option_range& op_range)
 {
     static const int MAX_ENUM_OPTION_VALUES(100);
     static const float EPSILON(0.05);
-    
-    rs2::option_range op_range = sensor.get_option_range(option);
-    if (abs((op_range.step - 1)) > EPSILON || (op_range.max > MAX_ENUM_OPTION_VALUES)) return false;
-    for (auto i = op_range.min; i <= op_range.max; i += op_range.step)
-    {
-        if (sensor.get_option_value_description(option, i) == nullptr)
-            continue;
-        return true;
-    }
-    return false;
+
+    return !(abs((op_range.step - 1)) > EPSILON || (op_range.max > MAX_ENUM_OPTION_VALUES));
 }
 
-bool is_int_option(rs2::options sensor, rs2_option option)
+bool is_int_option(const OptionInfo& info)
 {
-    rs2::option_range op_range = sensor.get_option_range(option);
-    return (op_range.step == 1.0);
+    return (info.step == 1.0);
 }
 
-std::map<std::string, int> get_enum_method(rs2::options sensor, rs2_option option)
+// The option is written by the parameters update thread: a write to the device that fails sets the ROS parameter
+// back to the value of the device.
+template<class T>
+void param_set_option(Parameters* parameters, rs2::options sensor, rs2_option option, const rclcpp::Parameter& parameter)
 {
-    std::map<std::string, int> dict; // An enum to set size
-    if (is_enum_option(sensor, option))
+    const std::string param_name(parameter.get_name());
+    const T value(parameter.get_value<T>());
+    parameters->queueSetOption(param_name, [parameters, sensor, option, param_name, value]()
     {
-        rs2::option_range op_range = sensor.get_option_range(option);
-        const auto op_range_min = int(op_range.min);
-        const auto op_range_max = int(op_range.max);
-        const auto op_range_step = int(op_range.step);
-        for (auto val = op_range_min; val <= op_range_max; val += op_range_step)
+        try
         {
-            if (sensor.get_option_value_description(option, val) == nullptr)
-                continue;
-            dict[sensor.get_option_value_description(option, val)] = val;
+            sensor.set_option(option, value);
         }
-    }
-    return dict;
-}
-
-template<class T>
-void param_set_option(rs2::options sensor, rs2_option option, const rclcpp::Parameter& parameter)
-{ 
-    sensor.set_option(option, parameter.get_value<T>());
+        catch(const std::exception&)
+        {
+            try
+            {
+                parameters->queueSetRosValue(param_name, static_cast<T>(sensor.get_option(option)));
+            }
+            catch(const std::exception&)
+            {
+            }
+            throw;
+        }
+    });
 }
 
 void SensorParams::clearParameters()
@@ -167,17 +159,21 @@ rcl_interfaces::msg::ParameterDescriptor SensorParams::get_parameter_descriptor(
 }
 
 template<class T>
-void SensorParams::set_parameter(rs2::options sensor, rs2_option option, const std::string& module_name, const std::string& description_addition)
+void SensorParams::set_parameter(rs2::options sensor, const OptionInfo& info, const std::string& module_name, const std::string& description_addition)
 {
+    rs2_option option = static_cast<rs2_option>(info.option);
     // set the option name, for example: depth_module.exposure
     const std::string option_name(module_name + "." + create_graph_resource_name(rs2_option_to_string(option)));
 
-    // get option current value, and option range values from the sensor
+    // get option current value from the sensor, the range is already known
     T option_value;
     rs2::option_range option_range;
+    option_range.min = info.min;
+    option_range.max = info.max;
+    option_range.step = info.step;
+    option_range.def = info.def;
     try
     {
-        option_range = sensor.get_option_range(option);
         float current_val = sensor.get_option(option);
         if(std::is_same<T, double>::value)
         {
@@ -196,14 +192,15 @@ void SensorParams::set_parameter(rs2::options sensor, rs2_option option, const s
 
     // get parameter descriptor for this option
     rcl_interfaces::msg::ParameterDescriptor parameter_descriptor = 
-        get_parameter_descriptor(option_name, option_range, option_value, sensor.get_option_description(option), description_addition);
+        get_parameter_descriptor(option_name, option_range, option_value, info.description, description_addition);
     
     T new_val;
     try
     {
-        new_val = (_parameters->setParam<T>(option_name, option_value, [option, sensor](const rclcpp::Parameter& parameter)
+        Parameters* parameters(_parameters.get());     // the callback and the write are run by the parameters themselves
+        new_val = (_parameters->setParam<T>(option_name, option_value, [parameters, option, sensor](const rclcpp::Parameter& parameter)
                     {
-                        param_set_option<T>(sensor, option, parameter);
+                        param_set_option<T>(parameters, sensor, option, parameter);
                     }, parameter_descriptor));
         _parameters_names.push_back(option_name);
     }
@@ -226,69 +223,97 @@ void SensorParams::set_parameter(rs2::options sensor, rs2_option option, const s
     }
 }
 
-void SensorParams::registerDynamicOptions(rs2::options sensor, const std::string& module_name)
+SensorOptionsInfo SensorParams::queryOptions(rs2::options sensor)
 {
+    SensorOptionsInfo options;
     for (auto i = 0; i < RS2_OPTION_COUNT; i++)
     {
         rs2_option option = static_cast<rs2_option>(i);
-        const std::string option_name(module_name + "." + create_graph_resource_name(rs2_option_to_string(option)));
         if (!sensor.supports(option) || sensor.is_option_read_only(option))
         {
             continue;
         }
-        if (is_checkbox(sensor, option))
+        try
+        {
+            rs2::option_range op_range = sensor.get_option_range(option);
+            OptionInfo info{i, op_range.min, op_range.max, op_range.step, op_range.def, sensor.get_option_description(option), {}};
+            if (may_be_enum_option(op_range))
+            {
+                const auto op_range_min = int(op_range.min);
+                const auto op_range_max = int(op_range.max);
+                const auto op_range_step = std::max(1, int(std::round(op_range.step)));
+                for (auto val = op_range_min; val <= op_range_max; val += op_range_step)
+                {
+                    const char* value_description = sensor.get_option_value_description(option, val);
+                    if (value_description != nullptr)
+                        info.value_descriptions.push_back(std::make_pair(val, std::string(value_description)));
+                }
+            }
+            options.push_back(info);
+        }
+        catch(const std::exception& ex)
+        {
+            ROS_ERROR_STREAM("An error has occurred while calling sensor for: " << rs2_option_to_string(option) << ":" << ex.what());
+        }
+    }
+    return options;
+}
+
+void SensorParams::registerDynamicOptions(rs2::options sensor, const std::string& module_name)
+{
+    registerDynamicOptions(sensor, module_name, queryOptions(sensor));
+}
+
+void SensorParams::registerDynamicOptions(rs2::options sensor, const std::string& module_name, const SensorOptionsInfo& options)
+{
+    for (auto& info : options)
+    {
+        if (is_checkbox(info))
         {
-            set_parameter<bool>(sensor, option, module_name);
+            set_parameter<bool>(sensor, info, module_name);
             continue;
         }
-        const auto enum_dict = get_enum_method(sensor, option);
-        if (enum_dict.empty())
+        if (info.value_descriptions.empty())
         {
-            if (is_int_option(sensor, option))
+            if (is_int_option(info))
             {
-                set_parameter<int>(sensor, option, module_name);
+                set_parameter<int>(sensor, info, module_name);
             }
             else
             {
-                if (i == RS2_OPTION_DEPTH_UNITS)
+                if (info.option == RS2_OPTION_DEPTH_UNITS)
                 {
-                    rs2::option_range op_range = sensor.get_option_range(option);
-                    if (ROS_DEPTH_SCALE >= op_range.min && ROS_DEPTH_SCALE <= op_range.max)
+                    if (ROS_DEPTH_SCALE >= info.min && ROS_DEPTH_SCALE <= info.max)
                     {
                         try
                         {
-                            sensor.set_option(option, ROS_DEPTH_SCALE);
+                            sensor.set_option(RS2_OPTION_DEPTH_UNITS, ROS_DEPTH_SCALE);
                         }
                         catch(const std::exception& e)
                         {
                             std::cout << "Failed to set value: " << e.what() << std::endl;
                         }
-                        op_range.min = ROS_DEPTH_SCALE;
-                        op_range.max = ROS_DEPTH_SCALE;
                     }
                 }
                 else
                 {
-                    set_parameter<double>(sensor, option, module_name);
+                    set_parameter<double>(sensor, info, module_name);
                 }
             }
         }
         else
         {
-            std::vector<std::pair<std::string, int> > enum_vec;
             size_t longest_desc(0);
-            for (auto enum_iter : enum_dict)
+            for (auto& value : info.value_descriptions)
             {
-                enum_vec.push_back(std::make_pair(enum_iter.first, enum_iter.second));
-                longest_desc = std::max(longest_desc, enum_iter.first.size());
+                longest_desc = std::max(longest_desc, value.second.size());
             }
-            sort(enum_vec.begin(), enum_vec.end(), [](std::pair<std::string, int> e1, std::pair<std::string, int> e2){return (e1.second < e2.second);});
             std::stringstream description;
-            for (auto vec_iter : enum_vec)
+            for (auto& value : info.value_descriptions)
             {
-                description << std::setw(longest_desc+6) << std::left << vec_iter.first << " : " << vec_iter.second << std::endl;
+                description << std::setw(longest_desc+6) << std::left << value.second << " : " << value.first << std::endl;
             }
-            set_parameter<int>(sensor, option, module_name, description.str());
+            set_parameter<int>(sensor, info, module_name, description.str());
         }
     }
 }
@@ -0,0 +1,109 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <task_pool.h>
+
+using namespace realsense2_camera;
+
+TaskPool::TaskPool(size_t threads_count) :
+    _is_running(true)
+{
+    for (size_t i = 1; i < threads_count; ++i)
+    {
+        _workers.emplace_back([this](){ work(); });
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        _is_running = false;
+    }
+    _cv_task.notify_all();
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+void TaskPool::run(const std::vector<Task>& tasks)
+{
+    if (tasks.empty()) return;
+
+    auto batch = std::make_shared<Batch>();
+    std::unique_lock<std::mutex> lock(_mutex);
+    batch->pending_tasks = tasks.size();
+    // The calling thread keeps the first task, the others are up for grabs.
+    for (size_t i = 1; i < tasks.size(); ++i)
+    {
+        _tasks.push_back({&tasks[i], batch});
+    }
+    if (tasks.size() > 2)
+        _cv_task.notify_all();
+    else if (tasks.size() == 2)
+        _cv_task.notify_one();
+
+    runTask(lock, {&tasks[0], batch});
+    while (batch->pending_tasks > 0)
+    {
+        if (!_tasks.empty())
+        {
+            QueuedTask queued_task = _tasks.front();
+            _tasks.pop_front();
+            runTask(lock, queued_task);
+        }
+        else
+        {
+            _cv_done.wait(lock);
+        }
+    }
+    if (batch->error)
+        std::rethrow_exception(batch->error);
+}
+
+void TaskPool::work()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _cv_task.wait(lock, [this]{ return !_is_running || !_tasks.empty(); });
+        if (!_is_running)
+            break;
+        QueuedTask queued_task = _tasks.front();
+        _tasks.pop_front();
+        runTask(lock, queued_task);
+    }
+}
+
+void TaskPool::runTask(std::unique_lock<std::mutex>& lock, const QueuedTask& queued_task)
+{
+    std::exception_ptr error;
+    lock.unlock();
+    try
+    {
+        (*queued_task.task)();
+    }
+    catch(...)
+    {
+        error = std::current_exception();
+    }
+    lock.lock();
+
+    Batch& batch = *queued_task.batch;
+    if (error && !batch.error)
+        batch.error = error;
+    if (--batch.pending_tasks == 0)
+        _cv_done.notify_all();
+}
@@ -0,0 +1,130 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <tf_hub.h>
+#include <constants.h>
+
+using namespace realsense2_camera;
+
+std::shared_ptr<TfHub> TfHub::getInstance()
+{
+    static std::mutex instance_mutex;
+    static std::weak_ptr<TfHub> instance;
+    std::lock_guard<std::mutex> lock_guard(instance_mutex);
+    std::shared_ptr<TfHub> hub = instance.lock();
+    if (!hub)
+    {
+        hub.reset(new TfHub());
+        instance = hub;
+    }
+    return hub;
+}
+
+TfHub::TfHub() :
+    _logger(rclcpp::get_logger("realsense2_camera")),
+    _next_client_id(0),
+    _is_running(true),
+    _is_clients_changed(false)
+{
+    _publish_thread = std::thread([this](){publish();});
+}
+
+TfHub::~TfHub()
+{
+    {
+        std::lock_guard<std::mutex> lock_guard(_mutex);
+        _is_running = false;
+    }
+    _cv.notify_one();
+    if (_publish_thread.joinable())
+        _publish_thread.join();
+}
+
+size_t TfHub::addClient(double rate, rclcpp::Clock::SharedPtr clock,
+                        std::shared_ptr<tf2_ros::TransformBroadcaster> broadcaster, TransformsProvider provider)
+{
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    size_t client_id = _next_client_id++;
+    _clients[client_id] = Client{period, std::chrono::steady_clock::now() + period, clock, broadcaster, provider};
+    _is_clients_changed = true;
+    _cv.notify_one();
+    return client_id;
+}
+
+void TfHub::removeClient(size_t client_id)
+{
+    std::lock_guard<std::mutex> lock_guard(_mutex);
+    _clients.erase(client_id);
+    _is_clients_changed = true;
+    _cv.notify_one();
+}
+
+void TfHub::publish()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (_is_running)
+    {
+        _is_clients_changed = false;
+        if (_clients.empty())
+        {
+            _cv.wait(lock, [this]{return !_is_running || _is_clients_changed;});
+            continue;
+        }
+        auto next_time = _clients.begin()->second.next_time;
+        for (auto& client : _clients)
+            next_time = std::min(next_time, client.second.next_time);
+        if (_cv.wait_until(lock, next_time, [this]{return !_is_running || _is_clients_changed;}))
+            continue;
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<geometry_msgs::msg::TransformStamped> msgs;
+        std::shared_ptr<tf2_ros::TransformBroadcaster> broadcaster;
+        rclcpp::Time t;
+        for (auto& client : _clients)
+        {
+            if (client.second.next_time > now)
+                continue;
+            // A late tick is not caught up with a burst
+            client.second.next_time += client.second.period;
+            if (client.second.next_time <= now)
+                client.second.next_time = now + client.second.period;
+            if (!broadcaster)
+            {
+                broadcaster = client.second.broadcaster;
+                t = client.second.clock->now();
+            }
+            try
+            {
+                std::vector<geometry_msgs::msg::TransformStamped> client_msgs;
+                if (client.second.provider(client_msgs, t))
+                    msgs.insert(msgs.end(), client_msgs.begin(), client_msgs.end());
+            }
+            catch(const std::exception& e)
+            {
+                ROS_ERROR_STREAM("Error getting dynamic transforms: " << e.what());
+            }
+        }
+        if (msgs.empty())
+            continue;
+        try
+        {
+            broadcaster->sendTransform(msgs);
+        }
+        catch(const std::exception& e)
+        {
+            ROS_ERROR_STREAM("Error publishing dynamic transforms: " << e.what());
+        }
+    }
+}
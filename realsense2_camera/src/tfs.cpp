@@ -233,34 +233,41 @@ void BaseRealSenseNode::publishStaticTransforms()
     restartStaticTransformBroadcaster();
 
     _static_tf_broadcaster->sendTransform(_static_tf_msgs);
+    _static_tf_msgs_version++;
 }
 
-void BaseRealSenseNode::publishDynamicTransforms()
+bool BaseRealSenseNode::getDynamicTransforms(std::vector<geometry_msgs::msg::TransformStamped>& msgs, const rclcpp::Time& t)
 {
-    if (!_dynamic_tf_broadcaster)
     {
-        _dynamic_tf_broadcaster = std::make_shared<tf2_ros::TransformBroadcaster>(_node);
+        // Copied, so that the transforms are sent without holding back updateSensors()
+        std::lock_guard<std::mutex> lock_guard(_publish_tf_mutex);
+        if (_tf_publish_on_change && _sent_tf_msgs_version == _static_tf_msgs_version)
+            return false;
+        msgs = _static_tf_msgs;
+        _sent_tf_msgs_version = _static_tf_msgs_version;
     }
+    for(auto& msg : msgs)
+        msg.header.stamp = t;
+    return !msgs.empty();
+}
 
+void BaseRealSenseNode::publishDynamicTransforms()
+{
     // Publish transforms for the cameras
     std::unique_lock<std::mutex> lock(_publish_dynamic_tf_mutex);
     while (rclcpp::ok() && _is_running && _tf_publish_rate > 0)
     {
         _cv_tf.wait_for(lock, std::chrono::milliseconds((int)(1000.0/_tf_publish_rate)), 
                                         [&]{return (!(_is_running && _tf_publish_rate > 0));});
+        try
         {
-            std::lock_guard<std::mutex> lock_guard(_publish_tf_mutex);
-            rclcpp::Time t = _node.now();
-            try
-            {
-                for(auto& msg : _static_tf_msgs)
-                    msg.header.stamp = t;
-                _dynamic_tf_broadcaster->sendTransform(_static_tf_msgs);
-            }
-            catch(const std::exception& e)
-            {
-                ROS_ERROR_STREAM("Error publishing dynamic transforms: " << e.what());
-            }
+            std::vector<geometry_msgs::msg::TransformStamped> msgs;
+            if (getDynamicTransforms(msgs, _node.now()))
+                _dynamic_tf_broadcaster->sendTransform(msgs);
+        }
+        catch(const std::exception& e)
+        {
+            ROS_ERROR_STREAM("Error publishing dynamic transforms: " << e.what());
         }
     }
 }
@@ -276,8 +283,26 @@ void BaseRealSenseNode::startDynamicTf()
     if (_tf_publish_rate > 0)
     {
         // Start publishing dynamic TF, if the param 'tf_publish_rate' is set to > 0.0 Hz
-        ROS_WARN("Publishing dynamic camera transforms (/tf) at %g Hz", _tf_publish_rate);
-        if (!_tf_t)
+        ROS_WARN("Publishing dynamic camera transforms (/tf) at %g Hz%s", _tf_publish_rate,
+                 _tf_publish_on_change ? ", when they change" : "");
+        if (!_dynamic_tf_broadcaster)
+        {
+            _dynamic_tf_broadcaster = std::make_shared<tf2_ros::TransformBroadcaster>(_node);
+        }
+        if (_tf_shared_timer)
+        {
+            // The rate may have changed: the client is added again
+            if (!_tf_hub)
+                _tf_hub = TfHub::getInstance();
+            else
+                _tf_hub->removeClient(_tf_hub_client_id);
+            _tf_hub_client_id = _tf_hub->addClient(_tf_publish_rate, _node.get_clock(), _dynamic_tf_broadcaster,
+                [this](std::vector<geometry_msgs::msg::TransformStamped>& msgs, const rclcpp::Time& t)
+                {
+                    return getDynamicTransforms(msgs, t);
+                });
+        }
+        else if (!_tf_t)
         {
             _tf_t = std::make_shared<std::thread>([this]()
             {
@@ -287,12 +312,9 @@ void BaseRealSenseNode::startDynamicTf()
     }
     else
     {
-        if (_tf_t && _tf_t->joinable())
+        if ((_tf_t && _tf_t->joinable()) || _tf_hub)
         {
-            // Stop publishing dynamic TF by resetting the '_tf_t' thread and '_dynamic_tf_broadcaster'
-            _tf_t->join();
-            _tf_t.reset();
-            _dynamic_tf_broadcaster.reset();
+            stopDynamicTf();
             ROS_WARN("Stopped publishing dynamic camera transforms (/tf)");
         }
         else
@@ -304,3 +326,18 @@ void BaseRealSenseNode::startDynamicTf()
     }
 }
 
+void BaseRealSenseNode::stopDynamicTf()
+{
+    // Stop publishing dynamic TF by resetting the '_tf_t' thread or leaving the hub, and the '_dynamic_tf_broadcaster'
+    if (_tf_hub)
+    {
+        _tf_hub->removeClient(_tf_hub_client_id);
+        _tf_hub.reset();
+    }
+    if (_tf_t && _tf_t->joinable())
+    {
+        _tf_t->join();
+        _tf_t.reset();
+    }
+    _dynamic_tf_broadcaster.reset();
+}
@@ -0,0 +1,407 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <video_encoder_publisher.h>
+#include <sensor_msgs/image_encodings.hpp>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#ifdef BUILD_WITH_VIDEO_ENCODER
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+using namespace realsense2_camera;
+
+#ifdef BUILD_WITH_VIDEO_ENCODER
+namespace {
+
+AVPixelFormat ros_encoding_to_pix_fmt( const sensor_msgs::msg::Image & image )
+{
+    namespace enc = sensor_msgs::image_encodings;
+    const std::string & encoding = image.encoding;
+    if( encoding == enc::RGB8 )
+        return AV_PIX_FMT_RGB24;
+    if( encoding == enc::BGR8 )
+        return AV_PIX_FMT_BGR24;
+    if( encoding == enc::RGBA8 )
+        return AV_PIX_FMT_RGBA;
+    if( encoding == enc::BGRA8 )
+        return AV_PIX_FMT_BGRA;
+    if( encoding == enc::MONO8 || encoding == enc::TYPE_8UC1 )
+        return AV_PIX_FMT_GRAY8;
+    if( encoding == enc::MONO16 || encoding == enc::TYPE_16UC1 )
+        return image.is_bigendian ? AV_PIX_FMT_GRAY16BE : AV_PIX_FMT_GRAY16LE;
+    if( encoding == enc::YUV422_YUY2 )
+        return AV_PIX_FMT_YUYV422;
+    if( encoding == enc::YUV422 )
+        return AV_PIX_FMT_UYVY422;
+    return AV_PIX_FMT_NONE;
+}
+
+bool is_hw_pix_fmt( AVPixelFormat pix_fmt )
+{
+    const AVPixFmtDescriptor * desc = av_pix_fmt_desc_get( pix_fmt );
+    return desc && ( desc->flags & AV_PIX_FMT_FLAG_HWACCEL );
+}
+
+std::string av_error_string( int error )
+{
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = { 0 };
+    av_strerror( error, buffer, sizeof( buffer ) );
+    return buffer;
+}
+
+std::string image_format( const sensor_msgs::msg::Image & image )
+{
+    return image.encoding + " " + std::to_string( image.width ) + "x" + std::to_string( image.height );
+}
+
+}  // namespace
+
+struct video_encoder_publisher::encoder_context
+{
+    encoder_context()
+        : codec_ctx( nullptr )
+        , hw_frames_ctx( nullptr )
+        , frame( nullptr )
+        , hw_frame( nullptr )
+        , packet( nullptr )
+        , sws_ctx( nullptr )
+        , next_pts( 0 )
+    {
+    }
+
+    ~encoder_context()
+    {
+        sws_freeContext( sws_ctx );
+        av_packet_free( &packet );
+        av_frame_free( &hw_frame );
+        av_frame_free( &frame );
+        av_buffer_unref( &hw_frames_ctx );
+        avcodec_free_context( &codec_ctx );
+    }
+
+    AVCodecContext * codec_ctx;
+    AVBufferRef * hw_frames_ctx;    // set for encoders taking hardware frames only, e.g. VAAPI
+    AVFrame * frame;                // the converted image, uploaded to hw_frame if hw_frames_ctx is set
+    AVFrame * hw_frame;
+    AVPacket * packet;
+    SwsContext * sws_ctx;
+    std::string image_format;
+    std::string codec_name;
+    int64_t next_pts;
+    // Encoders may return packets a few frames later: the headers wait for their packet.
+    std::map< int64_t, std_msgs::msg::Header > pending_headers;
+};
+#else
+struct video_encoder_publisher::encoder_context
+{
+};
+#endif
+
+video_encoder_publisher::video_encoder_publisher( rclcpp::Node & node,
+                                                  const std::string & topic_name,
+                                                  const rmw_qos_profile_t & qos,
+                                                  const video_encoder_settings & settings,
+                                                  std::shared_ptr< image_publisher > image_publisher_impl )
+    : logger( node.get_logger() )
+    , settings( settings )
+    , image_publisher_impl( image_publisher_impl )
+    , had_subscribers( false )
+{
+#ifdef BUILD_WITH_VIDEO_ENCODER
+    video_publisher_impl = node.create_publisher< sensor_msgs::msg::CompressedImage >(
+        topic_name + "/video",
+        rclcpp::QoS( rclcpp::QoSInitialization::from_rmw( qos ), qos ) );
+#else
+    RCLCPP_WARN_STREAM( logger, "Not built with BUILD_WITH_VIDEO_ENCODER: " << topic_name << " is not video encoded." );
+#endif
+}
+
+video_encoder_publisher::~video_encoder_publisher() = default;
+
+void video_encoder_publisher::publish( sensor_msgs::msg::Image::UniquePtr image_ptr )
+{
+    encode( *image_ptr );
+    image_publisher_impl->publish( std::move( image_ptr ) );
+}
+
+bool video_encoder_publisher::fill_and_publish( const std::function< bool( sensor_msgs::msg::Image & ) > & fill_func )
+{
+    // Encoded before it is published, as publishing may move the message away
+    return image_publisher_impl->fill_and_publish( [this, &fill_func]( sensor_msgs::msg::Image & image ) {
+        if( ! fill_func( image ) )
+            return false;
+        encode( image );
+        return true;
+    } );
+}
+
+size_t video_encoder_publisher::get_subscription_count() const
+{
+    size_t count = image_publisher_impl->get_subscription_count();
+    if( video_publisher_impl )
+        count += video_publisher_impl->get_subscription_count();
+    return count;
+}
+
+bool video_encoder_publisher::get_message_pool_stats( MessagePoolStats & stats ) const
+{
+    return image_publisher_impl->get_message_pool_stats( stats );
+}
+
+#ifdef BUILD_WITH_VIDEO_ENCODER
+
+bool video_encoder_publisher::is_encoder_available( const std::string & encoder )
+{
+    const AVCodec * codec = avcodec_find_encoder_by_name( encoder.c_str() );
+    return codec && codec->type == AVMEDIA_TYPE_VIDEO;
+}
+
+void video_encoder_publisher::encode( const sensor_msgs::msg::Image & image )
+{
+    std::lock_guard< std::mutex > lock( encoder_mutex );
+    bool has_subscribers = video_publisher_impl->get_subscription_count() > 0;
+    bool new_subscribers = has_subscribers && ! had_subscribers;
+    had_subscribers = has_subscribers;
+    if( ! has_subscribers )
+        return;
+
+    const std::string format = image_format( image );
+    if( format == failed_image_format )
+        return;
+    if( ! encoder || encoder->image_format != format )
+    {
+        encoder.reset();
+        std::string error;
+        std::unique_ptr< encoder_context > opened = open_encoder( image, error );
+        if( ! opened )
+        {
+            RCLCPP_ERROR_STREAM( logger, "Cannot encode " << format << " images of " << video_publisher_impl->get_topic_name()
+                                         << " with " << settings.encoder << ": " << error );
+            failed_image_format = format;
+            return;
+        }
+        encoder = std::move( opened );
+        failed_image_format.clear();
+    }
+
+    int result = av_frame_make_writable( encoder->frame );
+    if( result < 0 )
+    {
+        RCLCPP_ERROR_STREAM( logger, "Cannot write the video frame: " << av_error_string( result ) );
+        return;
+    }
+    const uint8_t * src_data[4] = { image.data.data(), nullptr, nullptr, nullptr };
+    const int src_linesize[4] = { static_cast< int >( image.step ), 0, 0, 0 };
+    sws_scale( encoder->sws_ctx, src_data, src_linesize, 0, image.height, encoder->frame->data, encoder->frame->linesize );
+
+    AVFrame * frame = encoder->frame;
+    if( encoder->hw_frames_ctx )
+    {
+        av_frame_unref( encoder->hw_frame );
+        result = av_hwframe_get_buffer( encoder->hw_frames_ctx, encoder->hw_frame, 0 );
+        if( result >= 0 )
+            result = av_hwframe_transfer_data( encoder->hw_frame, encoder->frame, 0 );
+        if( result < 0 )
+        {
+            RCLCPP_ERROR_STREAM( logger, "Cannot upload the video frame: " << av_error_string( result ) );
+            return;
+        }
+        frame = encoder->hw_frame;
+    }
+    frame->pts = encoder->next_pts++;
+    // The first frame of an encoder is a key frame anyway
+    frame->pict_type = new_subscribers ? AV_PICTURE_TYPE_I : AV_PICTURE_TYPE_NONE;
+    encoder->pending_headers[frame->pts] = image.header;
+
+    result = avcodec_send_frame( encoder->codec_ctx, frame );
+    if( result < 0 )
+    {
+        encoder->pending_headers.erase( frame->pts );
+        RCLCPP_ERROR_STREAM( logger, "Cannot encode the video frame: " << av_error_string( result ) );
+        return;
+    }
+    while( ( result = avcodec_receive_packet( encoder->codec_ctx, encoder->packet ) ) >= 0 )
+    {
+        auto header_it = encoder->pending_headers.find( encoder->packet->pts );
+        sensor_msgs::msg::CompressedImage::UniquePtr msg( new sensor_msgs::msg::CompressedImage() );
+        msg->header = ( header_it != encoder->pending_headers.end() ) ? header_it->second : image.header;
+        msg->format = encoder->codec_name;
+        msg->data.assign( encoder->packet->data, encoder->packet->data + encoder->packet->size );
+        encoder->pending_headers.erase( encoder->pending_headers.begin(), encoder->pending_headers.upper_bound( encoder->packet->pts ) );
+        av_packet_unref( encoder->packet );
+        video_publisher_impl->publish( std::move( msg ) );
+    }
+    if( result != AVERROR( EAGAIN ) && result != AVERROR_EOF )
+        RCLCPP_ERROR_STREAM( logger, "Cannot receive the encoded video: " << av_error_string( result ) );
+}
+
+std::unique_ptr< video_encoder_publisher::encoder_context >
+video_encoder_publisher::open_encoder( const sensor_msgs::msg::Image & image, std::string & error )
+{
+    const AVCodec * codec = avcodec_find_encoder_by_name( settings.encoder.c_str() );
+    if( ! codec )
+    {
+        error = "unknown encoder";
+        return nullptr;
+    }
+    AVPixelFormat src_pix_fmt = ros_encoding_to_pix_fmt( image );
+    if( src_pix_fmt == AV_PIX_FMT_NONE )
+    {
+        error = "unsupported encoding";
+        return nullptr;
+    }
+
+    std::unique_ptr< encoder_context > ctx( new encoder_context() );
+    ctx->image_format = image_format( image );
+    ctx->codec_name = avcodec_get_name( codec->id );
+    ctx->codec_ctx = avcodec_alloc_context3( codec );
+    AVCodecContext * codec_ctx = ctx->codec_ctx;
+    codec_ctx->width = image.width;
+    codec_ctx->height = image.height;
+    codec_ctx->time_base = AVRational{ 1, std::max( settings.fps, 1 ) };
+    codec_ctx->framerate = AVRational{ std::max( settings.fps, 1 ), 1 };
+    codec_ctx->gop_size = settings.gop_size;
+    codec_ctx->max_b_frames = 0;    // B frames wait for later frames
+    codec_ctx->bit_rate = settings.bitrate;
+
+    // The software pixel format the image converts to with the least loss, if the encoder takes any
+    std::vector< AVPixelFormat > sw_pix_fmts;
+    for( const AVPixelFormat * pix_fmt = codec->pix_fmts; pix_fmt && *pix_fmt != AV_PIX_FMT_NONE; ++pix_fmt )
+    {
+        if( ! is_hw_pix_fmt( *pix_fmt ) )
+            sw_pix_fmts.push_back( *pix_fmt );
+    }
+    AVPixelFormat frame_pix_fmt = src_pix_fmt;
+    codec_ctx->pix_fmt = frame_pix_fmt;
+    int loss = 0;
+    if( ! sw_pix_fmts.empty() )
+    {
+        sw_pix_fmts.push_back( AV_PIX_FMT_NONE );
+        frame_pix_fmt = avcodec_find_best_pix_fmt_of_list( sw_pix_fmts.data(), src_pix_fmt, 0, &loss );
+        codec_ctx->pix_fmt = frame_pix_fmt;
+    }
+    else if( codec->pix_fmts )
+    {
+        // Encoders of hardware frames only (VAAPI): the image is uploaded as NV12
+        const AVCodecHWConfig * hw_config = nullptr;
+        for( int i = 0; ( hw_config = avcodec_get_hw_config( codec, i ) ); ++i )
+        {
+            if( hw_config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_FRAMES_CTX )
+                break;
+        }
+        if( ! hw_config )
+        {
+            error = "no supported pixel format";
+            return nullptr;
+        }
+        AVBufferRef * hw_device_ctx = nullptr;
+        int result = av_hwdevice_ctx_create( &hw_device_ctx, hw_config->device_type, nullptr, nullptr, 0 );
+        if( result < 0 )
+        {
+            error = std::string( "cannot open the " ) + av_hwdevice_get_type_name( hw_config->device_type )
+                  + " device: " + av_error_string( result );
+            return nullptr;
+        }
+        ctx->hw_frames_ctx = av_hwframe_ctx_alloc( hw_device_ctx );
+        av_buffer_unref( &hw_device_ctx );
+        frame_pix_fmt = AV_PIX_FMT_NV12;
+        loss = av_get_pix_fmt_loss( frame_pix_fmt, src_pix_fmt, 0 );
+        AVHWFramesContext * frames_ctx = reinterpret_cast< AVHWFramesContext * >( ctx->hw_frames_ctx->data );
+        frames_ctx->format = hw_config->pix_fmt;
+        frames_ctx->sw_format = frame_pix_fmt;
+        frames_ctx->width = image.width;
+        frames_ctx->height = image.height;
+        frames_ctx->initial_pool_size = 4;
+        result = av_hwframe_ctx_init( ctx->hw_frames_ctx );
+        if( result < 0 )
+        {
+            error = "cannot allocate the hardware frames: " + av_error_string( result );
+            return nullptr;
+        }
+        codec_ctx->pix_fmt = hw_config->pix_fmt;
+        codec_ctx->hw_frames_ctx = av_buffer_ref( ctx->hw_frames_ctx );
+        ctx->hw_frame = av_frame_alloc();
+    }
+    if( loss & FF_LOSS_DEPTH )
+    {
+        RCLCPP_WARN_STREAM( logger, "Encoding " << image.encoding << " images as " << av_get_pix_fmt_name( frame_pix_fmt )
+                                    << " loses precision. Use a lossless encoder, like ffv1, for depth images." );
+    }
+
+    // Low latency settings of the encoders that have them
+    AVDictionary * options = nullptr;
+    const std::string encoder_name( codec->name );
+    if( encoder_name.find( "nvenc" ) != std::string::npos )
+    {
+        av_dict_set( &options, "tune", "ll", 0 );
+        av_dict_set( &options, "forced-idr", "1", 0 );
+    }
+    else if( encoder_name == "libx264" || encoder_name == "libx265" )
+    {
+        av_dict_set( &options, "tune", "zerolatency", 0 );
+    }
+    int result = avcodec_open2( codec_ctx, codec, &options );
+    av_dict_free( &options );
+    if( result < 0 )
+    {
+        error = av_error_string( result );
+        return nullptr;
+    }
+
+    ctx->frame = av_frame_alloc();
+    ctx->frame->format = frame_pix_fmt;
+    ctx->frame->width = image.width;
+    ctx->frame->height = image.height;
+    result = av_frame_get_buffer( ctx->frame, 0 );
+    if( result < 0 )
+    {
+        error = "cannot allocate the video frame: " + av_error_string( result );
+        return nullptr;
+    }
+    ctx->sws_ctx = sws_getContext( image.width, image.height, src_pix_fmt,
+                                   image.width, image.height, frame_pix_fmt,
+                                   SWS_POINT, nullptr, nullptr, nullptr );
+    if( ! ctx->sws_ctx )
+    {
+        error = "no conversion to " + std::string( av_get_pix_fmt_name( frame_pix_fmt ) );
+        return nullptr;
+    }
+    ctx->packet = av_packet_alloc();
+    RCLCPP_INFO_STREAM( logger, "Encoding " << ctx->image_format << " images of " << video_publisher_impl->get_topic_name()
+                                << " with " << settings.encoder << " (" << av_get_pix_fmt_name( frame_pix_fmt ) << ")" );
+    return ctx;
+}
+
+#else
+
+bool video_encoder_publisher::is_encoder_available( const std::string & )
+{
+    return false;
+}
+
+void video_encoder_publisher::encode( const sensor_msgs::msg::Image & )
+{
+}
+
+#endif
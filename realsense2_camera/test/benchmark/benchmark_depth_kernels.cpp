@@ -0,0 +1,200 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the depth kernels with the per pixel loops fix_depth_scale and clip_depth used before.
+// Benchmarks are named after the kernel set; sets the running CPU doesn't support are skipped.
+
+#include <benchmark/benchmark.h>
+#include <depth_kernels.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using realsense2_camera::DepthKernels;
+using realsense2_camera::getSupportedDepthKernels;
+
+namespace
+{
+    const float D405_DEPTH_SCALE = 0.0001f;
+    const float CLIPPING_DIST = 2.0f;     // meters
+
+    std::vector<uint16_t> createFrame(size_t count)
+    {
+        std::vector<uint16_t> frame(count);
+        for (size_t i = 0; i < count; ++i)
+            frame[i] = static_cast<uint16_t>((i * 7919) % 40000);
+        return frame;
+    }
+
+    void legacyFixDepthScale(const uint16_t* from_data, uint16_t* to_data, size_t count, float depth_scale_meters)
+    {
+        static const float meter_to_mm = 0.001f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            to_data[i] = from_data[i] * depth_scale_meters / meter_to_mm;
+        }
+    }
+
+    void legacyClipDepth(uint16_t* p_depth_frame, int width, int height, uint16_t clipping_value)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            auto depth_pixel_index = y * width;
+            for (int x = 0; x < width; x++, ++depth_pixel_index)
+            {
+                if (p_depth_frame[depth_pixel_index] > clipping_value)
+                {
+                    p_depth_frame[depth_pixel_index] = 0;
+                }
+            }
+        }
+    }
+
+    const DepthKernels* findKernels(benchmark::State& state, const char* name)
+    {
+        for (const DepthKernels* kernels : getSupportedDepthKernels())
+        {
+            if (strcmp(kernels->name, name) == 0)
+                return kernels;
+        }
+        state.SkipWithError("kernels are not supported by this CPU");
+        return nullptr;
+    }
+
+    void setCounters(benchmark::State& state, size_t count)
+    {
+        state.SetItemsProcessed(state.iterations() * count);
+        state.SetBytesProcessed(state.iterations() * count * sizeof(uint16_t));
+    }
+}
+
+// Frame pipeline before the kernels: clip in place, then scale into the message.
+static void BM_legacy_clip_then_scale(benchmark::State& state)
+{
+    int width = static_cast<int>(state.range(0));
+    int height = static_cast<int>(state.range(1));
+    size_t count = width * height;
+    auto frame = createFrame(count);
+    std::vector<uint16_t> msg(count);
+    uint16_t clipping_value = static_cast<uint16_t>(CLIPPING_DIST / D405_DEPTH_SCALE);
+    for (auto _ : state)
+    {
+        legacyClipDepth(frame.data(), width, height, clipping_value);
+        legacyFixDepthScale(frame.data(), msg.data(), count, D405_DEPTH_SCALE);
+        benchmark::DoNotOptimize(msg.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, count);
+}
+
+static void BM_legacy_scale(benchmark::State& state)
+{
+    size_t count = state.range(0) * state.range(1);
+    auto frame = createFrame(count);
+    std::vector<uint16_t> msg(count);
+    for (auto _ : state)
+    {
+        legacyFixDepthScale(frame.data(), msg.data(), count, D405_DEPTH_SCALE);
+        benchmark::DoNotOptimize(msg.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, count);
+}
+
+static void BM_legacy_clip(benchmark::State& state)
+{
+    int width = static_cast<int>(state.range(0));
+    int height = static_cast<int>(state.range(1));
+    size_t count = width * height;
+    auto frame = createFrame(count);
+    uint16_t clipping_value = static_cast<uint16_t>(CLIPPING_DIST / D405_DEPTH_SCALE);
+    for (auto _ : state)
+    {
+        legacyClipDepth(frame.data(), width, height, clipping_value);
+        benchmark::DoNotOptimize(frame.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, count);
+}
+
+static void BM_kernel_scale(benchmark::State& state, const char* kernels_name)
+{
+    const DepthKernels* kernels = findKernels(state, kernels_name);
+    if (!kernels) return;
+    size_t count = state.range(0) * state.range(1);
+    auto frame = createFrame(count);
+    std::vector<uint16_t> msg(count);
+    for (auto _ : state)
+    {
+        kernels->scale(frame.data(), msg.data(), count, D405_DEPTH_SCALE);
+        benchmark::DoNotOptimize(msg.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, count);
+}
+
+static void BM_kernel_clip(benchmark::State& state, const char* kernels_name)
+{
+    const DepthKernels* kernels = findKernels(state, kernels_name);
+    if (!kernels) return;
+    size_t count = state.range(0) * state.range(1);
+    auto frame = createFrame(count);
+    uint16_t clipping_value = static_cast<uint16_t>(CLIPPING_DIST / D405_DEPTH_SCALE);
+    for (auto _ : state)
+    {
+        kernels->clip(frame.data(), frame.data(), count, clipping_value);
+        benchmark::DoNotOptimize(frame.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, count);
+}
+
+// Frame pipeline with the kernels: clip and scale in the single copy into the message.
+static void BM_kernel_scale_and_clip(benchmark::State& state, const char* kernels_name)
+{
+    const DepthKernels* kernels = findKernels(state, kernels_name);
+    if (!kernels) return;
+    size_t count = state.range(0) * state.range(1);
+    auto frame = createFrame(count);
+    std::vector<uint16_t> msg(count);
+    uint16_t clipping_value = static_cast<uint16_t>(CLIPPING_DIST / D405_DEPTH_SCALE);
+    for (auto _ : state)
+    {
+        kernels->scale_and_clip(frame.data(), msg.data(), count, D405_DEPTH_SCALE, clipping_value);
+        benchmark::DoNotOptimize(msg.data());
+        benchmark::ClobberMemory();
+    }
+    setCounters(state, count);
+}
+
+static void addResolutions(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->Args({640, 480})->Args({848, 480})->Args({1280, 720});
+}
+
+BENCHMARK(BM_legacy_scale)->Apply(addResolutions);
+BENCHMARK(BM_legacy_clip)->Apply(addResolutions);
+BENCHMARK(BM_legacy_clip_then_scale)->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale, scalar, "scalar")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale, sse2, "sse2")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale, avx2, "avx2")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale, neon, "neon")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_clip, scalar, "scalar")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_clip, sse2, "sse2")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_clip, avx2, "avx2")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_clip, neon, "neon")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale_and_clip, scalar, "scalar")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale_and_clip, sse2, "sse2")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale_and_clip, avx2, "avx2")->Apply(addResolutions);
+BENCHMARK_CAPTURE(BM_kernel_scale_and_clip, neon, "neon")->Apply(addResolutions);
@@ -0,0 +1,229 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Plays a rosbag file through BaseRealSenseNode as fast as the node takes the frames, for each combination
+// of the depth filters, align depth, pointcloud and RGBD. RGBD is published from the aligned depth only, so it is
+// combined with align depth only. Each iteration plays the whole file.
+// Frames are counted on the depth image topic, from the first one received, so that the node setup is left out.
+// Messages on all the subscribed topics, and the CPU time of the whole process (librealsense and subscribers
+// included), are counted over the same span.
+// An iteration fails if the playback does not stop within 10 times the rosbag duration, plus 30 seconds.
+//
+// The rosbag file is $RS2_BENCHMARK_ROSBAG, or outdoors_1color.bag as downloaded by the rosbag pytests.
+// Use --benchmark_format=json or --benchmark_out=<file> for machine readable results.
+
+#include <benchmark/benchmark.h>
+#include <base_realsense_node.h>
+#include <dynamic_params.h>
+#include <sys/resource.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    enum BenchmarkConfig
+    {
+        FILTERS_CONFIG    = 1 << 0,     // spatial and temporal filters
+        ALIGN_CONFIG      = 1 << 1,
+        POINTCLOUD_CONFIG = 1 << 2,
+        RGBD_CONFIG       = 1 << 3,
+        CONFIGS_COUNT     = 1 << 4
+    };
+
+    std::string configName(int config)
+    {
+        const char* names[] = {"filters", "align", "pointcloud", "rgbd"};
+        std::string name;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (config & (1 << i))
+                name += (name.empty() ? "" : "+") + std::string(names[i]);
+        }
+        return name.empty() ? "none" : name;
+    }
+
+    std::string rosbagPath()
+    {
+        const char* path = std::getenv("RS2_BENCHMARK_ROSBAG");
+        if (path)
+            return path;
+        const char* home = std::getenv("HOME");
+        return std::string(home ? home : "") + "/realsense_records/outdoors_1color.bag";
+    }
+
+    double processCpuSeconds()
+    {
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+    }
+
+    struct RclcppContext
+    {
+        RclcppContext() { if (!rclcpp::ok()) rclcpp::init(0, nullptr); }
+        ~RclcppContext() { if (rclcpp::ok()) rclcpp::shutdown(); }
+    };
+
+    // Frames received on the depth topic, with the times of the first and the last one,
+    // and the messages received on all the topics in between. Called from the executor thread only.
+    struct FramesCounter
+    {
+        FramesCounter() : frames(0), messages(0), span_messages(0), first_time(0), last_time(0), first_cpu(0), last_cpu(0) {}
+        void addFrame()
+        {
+            double time = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            double cpu = processCpuSeconds();
+            if (frames++ == 0)
+            {
+                first_time = time;
+                first_cpu = cpu;
+            }
+            else
+            {
+                messages++;
+            }
+            last_time = time;
+            last_cpu = cpu;
+            span_messages = messages;
+        }
+        void addMessage()
+        {
+            if (frames > 0)
+                messages++;
+        }
+        size_t frames;
+        size_t messages;
+        size_t span_messages;   // messages up to the last depth frame
+        double first_time, last_time;
+        double first_cpu, last_cpu;
+    };
+
+    template<class MsgType>
+    rclcpp::SubscriptionBase::SharedPtr subscribe(rclcpp::Node& node, const std::string& topic, std::function<void()> callback)
+    {
+        std::string topic_name(std::string(node.get_fully_qualified_name()) + "/" + topic);
+        return node.create_subscription<MsgType>(topic_name, rclcpp::QoS(100),
+                                                 [callback](std::shared_ptr<const MsgType>) { callback(); });
+    }
+}
+
+static void BM_RosbagPublish(benchmark::State& state)
+{
+    static RclcppContext rclcpp_context;
+    const std::string rosbag_path = rosbagPath();
+    if (!std::ifstream(rosbag_path).good())
+    {
+        state.SkipWithError(("rosbag file not found: " + rosbag_path + ". Set RS2_BENCHMARK_ROSBAG").c_str());
+        return;
+    }
+    const int config = static_cast<int>(state.range(0));
+    state.SetLabel(configName(config));
+
+    size_t total_frames(0), total_messages(0);
+    double total_seconds(0), total_cpu_seconds(0);
+    for (auto _ : state)
+    {
+        rclcpp::NodeOptions options;
+        options.parameter_overrides({
+            {"enable_sync", true},
+            {"spatial_filter.enable", (config & FILTERS_CONFIG) != 0},
+            {"temporal_filter.enable", (config & FILTERS_CONFIG) != 0},
+            {"align_depth.enable", (config & ALIGN_CONFIG) != 0},
+            {"pointcloud.enable", (config & POINTCLOUD_CONFIG) != 0},
+            {"enable_rgbd", (config & RGBD_CONFIG) != 0}});
+        auto node = std::make_shared<rclcpp::Node>("camera", "benchmark", options);
+
+        FramesCounter counter;
+        auto count_message = [&counter]() { counter.addMessage(); };
+        std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+        subscriptions.push_back(subscribe<sensor_msgs::msg::Image>(*node, "depth/image_rect_raw", [&counter]() { counter.addFrame(); }));
+        subscriptions.push_back(subscribe<sensor_msgs::msg::Image>(*node, "color/image_raw", count_message));
+        if (config & ALIGN_CONFIG)
+            subscriptions.push_back(subscribe<sensor_msgs::msg::Image>(*node, "aligned_depth_to_color/image_raw", count_message));
+        if (config & POINTCLOUD_CONFIG)
+            subscriptions.push_back(subscribe<sensor_msgs::msg::PointCloud2>(*node, "depth/color/points", count_message));
+        if (config & RGBD_CONFIG)
+            subscriptions.push_back(subscribe<realsense2_camera_msgs::msg::RGBD>(*node, "rgbd", count_message));
+
+        rclcpp::executors::SingleThreadedExecutor executor;
+        executor.add_node(node);
+        std::thread spin_thread([&executor]() { executor.spin(); });
+
+        rs2::context ctx;
+        rs2::device device = ctx.load_device(rosbag_path);
+        rs2::playback playback = device.as<rs2::playback>();
+        playback.set_real_time(false);
+        std::atomic_bool is_stopped(false);
+        playback.set_status_changed_callback([&is_stopped](rs2_playback_status status)
+        {
+            if (status == RS2_PLAYBACK_STATUS_STOPPED)
+                is_stopped = true;
+        });
+
+        // A bad rosbag file, or a device error, may never stop the playback
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30) + 10 * playback.get_duration();
+        auto parameters = std::make_shared<Parameters>(*node);
+        {
+            BaseRealSenseNode rs_node(*node, device, parameters);
+            rs_node.publishTopics();
+            while (!is_stopped && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // The messages already published are still received.
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+        executor.cancel();
+        spin_thread.join();
+        subscriptions.clear();
+
+        if (!is_stopped)
+        {
+            state.SkipWithError("the rosbag playback did not stop before the timeout");
+            return;
+        }
+        if (counter.frames < 2)
+        {
+            state.SkipWithError("less than 2 depth frames were received");
+            return;
+        }
+        double seconds = counter.last_time - counter.first_time;
+        state.SetIterationTime(seconds);
+        total_frames += counter.frames - 1;
+        total_messages += counter.span_messages;
+        total_seconds += seconds;
+        total_cpu_seconds += counter.last_cpu - counter.first_cpu;
+    }
+    state.counters["frames"] = static_cast<double>(total_frames);
+    state.counters["fps"] = total_frames / total_seconds;
+    state.counters["messages_per_sec"] = total_messages / total_seconds;
+    state.counters["cpu_ms_per_frame"] = total_cpu_seconds * 1e3 / total_frames;
+}
+
+static void benchmarkConfigs(benchmark::internal::Benchmark* benchmark)
+{
+    for (int config = 0; config < CONFIGS_COUNT; ++config)
+    {
+        // Without align depth, the RGBD topic is never published
+        if ((config & RGBD_CONFIG) && !(config & ALIGN_CONFIG))
+            continue;
+        benchmark->Arg(config);
+    }
+}
+
+BENCHMARK(BM_RosbagPublish)->Apply(benchmarkConfigs)->ArgName("config")
+    ->Iterations(1)->UseManualTime()->Unit(benchmark::kMillisecond);
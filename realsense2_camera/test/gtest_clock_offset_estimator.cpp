@@ -0,0 +1,98 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <clock_offset_estimator.h>
+#include <cmath>
+#include <random>
+
+using realsense2_camera::ClockOffsetEstimator;
+
+namespace
+{
+    // A device clock running skew_ppm faster than the host, its frames arriving 1 to 3 ms late
+    // and, one in 20, held back by 30 ms.
+    struct SimulatedCamera
+    {
+        double skew_ppm;
+        double device_start_ms;
+        double wrap_period_ms;
+        int64_t host_start_ns;
+        std::mt19937 random;
+
+        double deviceTime(int64_t host_ns) const
+        {
+            double device_ms = device_start_ms + (host_ns - host_start_ns) * 1e-6 * (1 + skew_ppm * 1e-6);
+            return std::fmod(device_ms, wrap_period_ms);
+        }
+        int64_t arrival(int64_t host_ns)
+        {
+            std::uniform_real_distribution<double> latency_ms(1.0, 3.0);
+            double latency = latency_ms(random) + ((random() % 20 == 0) ? 30.0 : 0.0);
+            return host_ns + static_cast<int64_t>(latency * 1e6);
+        }
+    };
+}
+
+TEST(clock_offset_estimator, follows_the_skew_of_the_device_clock)
+{
+    SimulatedCamera camera{80.0, 1000.0, ClockOffsetEstimator::HARDWARE_CLOCK_WRAP_MS, 1700000000000000000LL, std::mt19937(7)};
+    ClockOffsetEstimator estimator;
+    double max_error_ms(0);
+    // 30 minutes of frames at 30 fps: without the skew, the stamps would drift by 144 ms
+    const int64_t frame_period_ns(33333333);
+    for (int64_t host_ns = camera.host_start_ns; host_ns < camera.host_start_ns + 1800LL * 1000000000LL; host_ns += frame_period_ns)
+    {
+        int64_t stamp_ns = estimator.update(camera.deviceTime(host_ns), camera.arrival(host_ns));
+        if (host_ns > camera.host_start_ns + 300LL * 1000000000LL)
+            max_error_ms = std::max(max_error_ms, std::abs(stamp_ns - host_ns) * 1e-6);
+    }
+    // The earliest arrivals are 1 ms late
+    EXPECT_LT(max_error_ms, 1.5);
+    ClockOffsetEstimator::Estimate estimate = estimator.getEstimate();
+    EXPECT_NEAR(estimate.skew_ppm, 80.0, 5.0);
+    EXPECT_EQ(estimate.samples, 128u);
+}
+
+TEST(clock_offset_estimator, unwraps_the_hardware_clock)
+{
+    // The clock wraps 10 seconds in, with frames of two streams out of order by a few milliseconds
+    SimulatedCamera camera{0.0, ClockOffsetEstimator::HARDWARE_CLOCK_WRAP_MS - 10000.0, ClockOffsetEstimator::HARDWARE_CLOCK_WRAP_MS,
+                           0, std::mt19937(3)};
+    ClockOffsetEstimator estimator;
+    int64_t last_stamp_ns(0);
+    for (int64_t host_ns = 0; host_ns < 20LL * 1000000000LL; host_ns += 10000000)
+    {
+        int64_t stamp_ns = estimator.update(camera.deviceTime(host_ns), host_ns + 1000000);
+        estimator.update(camera.deviceTime(host_ns - 3000000), host_ns + 1000000);
+        EXPECT_NEAR((stamp_ns - host_ns) * 1e-6, 1.0, 0.01) << "at " << host_ns * 1e-9 << " s";
+        EXPECT_GT(stamp_ns, last_stamp_ns);
+        last_stamp_ns = stamp_ns;
+    }
+}
+
+TEST(clock_offset_estimator, starts_over_when_the_device_clock_is_reset)
+{
+    ClockOffsetEstimator estimator;
+    for (int i = 0; i < 100; ++i)
+        estimator.update(500000.0 + i * 100.0, 1000000000LL + i * 100000000LL);
+    // After a hardware reset, the device clock starts from 0 again
+    int64_t host_ns = 50000000000LL;
+    EXPECT_EQ(estimator.update(0.0, host_ns), host_ns);
+    EXPECT_EQ(estimator.update(100.0, host_ns + 100000000LL), host_ns + 100000000LL);
+    EXPECT_EQ(estimator.getEstimate().samples, 1u);
+
+    estimator.reset();
+    EXPECT_EQ(estimator.update(5.0, 7), 7);
+}
@@ -0,0 +1,66 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <coalescing_queue.h>
+#include <stdexcept>
+
+using realsense2_camera::CoalescingQueue;
+
+TEST(coalescing_queue, applies_the_last_write_of_each_name_in_order)
+{
+    CoalescingQueue queue;
+    std::vector<std::string> writes;
+    auto write = [&writes](const std::string& value){ return [&writes, value]{ writes.push_back(value); }; };
+    auto exposure_1 = queue.push("exposure", write("exposure=1"));
+    queue.push("enable_auto_exposure", write("enable_auto_exposure=0"));
+    auto exposure_2 = queue.push("exposure", write("exposure=2"));
+    EXPECT_FALSE(queue.empty());
+
+    CoalescingQueue::Batch batch = queue.takeAll();
+    EXPECT_TRUE(queue.empty());
+    ASSERT_EQ(batch.size(), 2u);
+    CoalescingQueue::apply(batch, nullptr);
+    EXPECT_EQ(writes, (std::vector<std::string>{"enable_auto_exposure=0", "exposure=2"}));
+    // The replaced write gets the result of the write applied instead of it
+    ASSERT_EQ(exposure_1.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_TRUE(exposure_1.get());
+    EXPECT_TRUE(exposure_2.get());
+}
+
+TEST(coalescing_queue, reports_failures_and_applies_the_rest)
+{
+    CoalescingQueue queue;
+    int applied(0);
+    auto failed = queue.push("gain", []{ throw std::runtime_error("not supported while streaming"); });
+    auto succeeded = queue.push("laser_power", [&applied]{ applied++; });
+
+    std::vector<std::string> errors;
+    CoalescingQueue::Batch batch = queue.takeAll();
+    CoalescingQueue::apply(batch, [&errors](const std::string& name, const std::string& error){ errors.push_back(name + ": " + error); });
+    EXPECT_FALSE(failed.get());
+    EXPECT_TRUE(succeeded.get());
+    EXPECT_EQ(applied, 1);
+    EXPECT_EQ(errors, (std::vector<std::string>{"gain: not supported while streaming"}));
+}
+
+TEST(coalescing_queue, fails_the_updates_never_applied)
+{
+    std::shared_future<bool> result;
+    {
+        CoalescingQueue queue;
+        result = queue.push("exposure", []{});
+    }
+    EXPECT_FALSE(result.get());
+}
@@ -0,0 +1,96 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <depth_kernels.h>
+#include <cstdint>
+#include <vector>
+
+using realsense2_camera::DepthKernels;
+using realsense2_camera::getSupportedDepthKernels;
+
+namespace
+{
+    // Odd size, so that the scalar tail of the vectorized kernels is covered as well.
+    const size_t COUNT = 65536 + 13;
+
+    // D405 depth unit is 0.1mm, D455 default is 1mm, some presets use 0.05mm.
+    const float DEPTH_SCALES[] = {0.0001f, 0.001f, 0.00005f, 0.0025f};
+
+    std::vector<uint16_t> createInput()
+    {
+        std::vector<uint16_t> input(COUNT);
+        for (size_t i = 0; i < COUNT; ++i)
+            input[i] = static_cast<uint16_t>(i * 7919);
+        return input;
+    }
+
+    // The loop fix_depth_scale used before the kernels were added, with saturation on overflow.
+    uint16_t referenceScale(uint16_t value, float depth_scale_meters)
+    {
+        static const float meter_to_mm = 0.001f;
+        float scaled = value * depth_scale_meters / meter_to_mm;
+        return (scaled >= 65535.0f) ? 65535 : static_cast<uint16_t>(scaled);
+    }
+}
+
+TEST(depth_kernels, scale_matches_reference)
+{
+    auto input = createInput();
+    for (const DepthKernels* kernels : getSupportedDepthKernels())
+    {
+        for (float depth_scale : DEPTH_SCALES)
+        {
+            std::vector<uint16_t> output(COUNT);
+            kernels->scale(input.data(), output.data(), COUNT, depth_scale);
+            for (size_t i = 0; i < COUNT; ++i)
+                ASSERT_EQ(output[i], referenceScale(input[i], depth_scale)) << kernels->name << " pixel " << i << " scale " << depth_scale;
+        }
+    }
+}
+
+TEST(depth_kernels, clip_matches_reference)
+{
+    auto input = createInput();
+    const uint16_t clipping_values[] = {0, 1000, 32767, 32768, 65535};
+    for (const DepthKernels* kernels : getSupportedDepthKernels())
+    {
+        for (uint16_t clipping_value : clipping_values)
+        {
+            std::vector<uint16_t> output(input);
+            kernels->clip(output.data(), output.data(), COUNT, clipping_value);     // in place, as clip_depth does
+            for (size_t i = 0; i < COUNT; ++i)
+                ASSERT_EQ(output[i], (input[i] > clipping_value) ? 0 : input[i]) << kernels->name << " pixel " << i;
+        }
+    }
+}
+
+TEST(depth_kernels, fused_matches_clip_then_scale)
+{
+    auto input = createInput();
+    const uint16_t clipping_value = 40000;
+    for (const DepthKernels* kernels : getSupportedDepthKernels())
+    {
+        for (float depth_scale : DEPTH_SCALES)
+        {
+            std::vector<uint16_t> output(COUNT);
+            kernels->scale_and_clip(input.data(), output.data(), COUNT, depth_scale, clipping_value);
+            for (size_t i = 0; i < COUNT; ++i)
+            {
+                uint16_t expected = (input[i] > clipping_value) ? 0 : referenceScale(input[i], depth_scale);
+                ASSERT_EQ(output[i], expected) << kernels->name << " pixel " << i;
+            }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <format_traits.h>
+#include <sensor_msgs/image_encodings.hpp>
+
+using namespace realsense2_camera;
+
+TEST(format_traits, encodings_are_those_of_ros)
+{
+    namespace enc = sensor_msgs::image_encodings;
+    EXPECT_EQ(enc::MONO8, formatTraits(RS2_FORMAT_Y8).encoding);
+    EXPECT_EQ(enc::MONO16, formatTraits(RS2_FORMAT_Y16).encoding);
+    EXPECT_EQ(enc::TYPE_16UC1, formatTraits(RS2_FORMAT_Z16).encoding);
+    EXPECT_EQ(enc::RGB8, formatTraits(RS2_FORMAT_RGB8).encoding);
+    EXPECT_EQ(enc::BGR8, formatTraits(RS2_FORMAT_BGR8).encoding);
+    EXPECT_EQ(enc::RGBA8, formatTraits(RS2_FORMAT_RGBA8).encoding);
+    EXPECT_EQ(enc::BGRA8, formatTraits(RS2_FORMAT_BGRA8).encoding);
+    EXPECT_EQ(enc::YUV422_YUY2, formatTraits(RS2_FORMAT_YUYV).encoding);
+    EXPECT_EQ(enc::YUV422, formatTraits(RS2_FORMAT_UYVY).encoding);
+    EXPECT_EQ(enc::TYPE_8UC1, formatTraits(RS2_FORMAT_RAW8).encoding);
+    EXPECT_EQ(enc::TYPE_16UC1, formatTraits(RS2_FORMAT_RAW10).encoding);
+    EXPECT_EQ(enc::TYPE_16UC1, formatTraits(RS2_FORMAT_RAW16).encoding);
+}
+
+TEST(format_traits, unsupported_formats)
+{
+    EXPECT_EQ(nullptr, formatTraits(RS2_FORMAT_M420).encoding);
+    EXPECT_EQ(nullptr, formatTraits(RS2_FORMAT_MOTION_XYZ32F).encoding);
+    EXPECT_EQ(nullptr, formatTraits(static_cast<rs2_format>(RS2_FORMAT_COUNT)).encoding);
+    for (int format = 0; format < RS2_FORMAT_COUNT; ++format)
+        EXPECT_EQ(format, formatTraits(static_cast<rs2_format>(format)).format);
+}
@@ -0,0 +1,70 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <frame_group_syncer.h>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    const int64_t MS = 1000000;
+}
+
+TEST(frame_group_syncer, groups_frames_within_tolerance)
+{
+    FrameGroupSyncer<int> syncer(5 * MS, 4);
+    syncer.addMember("camera_b");
+    syncer.addMember("camera_a");
+    FrameGroupSyncer<int>::Group group;
+
+    EXPECT_FALSE(syncer.push("camera_a", 100 * MS, 1, group));
+    EXPECT_FALSE(syncer.push("camera_a", 133 * MS, 2, group));
+    // Frame 1 is too old for this one and is dropped, frame 2 is waiting for its match
+    EXPECT_FALSE(syncer.push("camera_b", 120 * MS, 10, group));
+    ASSERT_TRUE(syncer.push("camera_b", 136 * MS, 11, group));
+    ASSERT_EQ(group.size(), 2u);
+    EXPECT_EQ(group[0].first, "camera_a");
+    EXPECT_EQ(group[0].second, 2);
+    EXPECT_EQ(group[1].first, "camera_b");
+    EXPECT_EQ(group[1].second, 11);
+
+    EXPECT_FALSE(syncer.push("camera_unknown", 166 * MS, 0, group));
+    EXPECT_FALSE(syncer.push("camera_b", 166 * MS, 12, group));
+    ASSERT_TRUE(syncer.push("camera_a", 170 * MS, 3, group));
+    EXPECT_EQ(group[0].second, 3);
+    EXPECT_EQ(group[1].second, 12);
+}
+
+TEST(frame_group_syncer, stopped_member_holds_a_bounded_queue)
+{
+    FrameGroupSyncer<int> syncer(5 * MS, 2);
+    syncer.addMember("camera_a");
+    syncer.addMember("camera_b");
+    FrameGroupSyncer<int>::Group group;
+
+    for (int i = 0; i < 10; ++i)
+        EXPECT_FALSE(syncer.push("camera_a", i * 33 * MS, i, group));
+    // Only the 2 latest frames of camera_a are left
+    EXPECT_FALSE(syncer.push("camera_b", 231 * MS, 0, group));
+    ASSERT_TRUE(syncer.push("camera_b", 264 * MS, 1, group));
+    EXPECT_EQ(group[0].second, 8);
+
+    // A member that leaves doesn't hold the others anymore
+    syncer.removeMember("camera_b");
+    ASSERT_TRUE(syncer.push("camera_a", 300 * MS, 9, group));
+    ASSERT_EQ(group.size(), 1u);
+    EXPECT_EQ(group[0].second, 9);
+}
@@ -0,0 +1,90 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <latency_stats.h>
+#include <thread>
+#include <vector>
+
+using namespace realsense2_camera;
+
+TEST(latency_stats, buckets_cover_all_latencies)
+{
+    int previous_index(-1);
+    for (uint64_t latency : {0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 1000ull, 33333333ull, 1ull << 40, ~0ull})
+    {
+        int index = LatencyHistogram::bucketIndex(latency);
+        ASSERT_GT(index, previous_index);
+        ASSERT_LT(index, LatencyHistogram::BUCKETS_COUNT);
+        ASSERT_GE(LatencyHistogram::bucketUpperBound(index), latency);
+        if (index > 0)
+        {
+            ASSERT_LT(LatencyHistogram::bucketUpperBound(index - 1), latency);
+        }
+        previous_index = index;
+    }
+}
+
+TEST(latency_stats, percentiles)
+{
+    LatencyHistogram histogram;
+    ASSERT_EQ(histogram.getSummary().count, 0u);
+    for (int64_t ms = 1; ms <= 100; ++ms)
+        histogram.record(ms * 1000000);
+    histogram.record(-5);
+
+    LatencyHistogram::Summary summary = histogram.getSummary();
+    ASSERT_EQ(summary.count, 101u);
+    ASSERT_NEAR(summary.p50_ms, 50, 50 * 0.125);
+    ASSERT_NEAR(summary.p95_ms, 95, 95 * 0.125);
+    ASSERT_NEAR(summary.p99_ms, 99, 99 * 0.125);
+    ASSERT_LE(summary.p99_ms, 100);
+    ASSERT_DOUBLE_EQ(summary.max_ms, 100);
+
+    histogram.reset();
+    ASSERT_EQ(histogram.getSummary().count, 0u);
+    ASSERT_EQ(histogram.getSummary().max_ms, 0);
+}
+
+TEST(latency_stats, concurrent_recording)
+{
+    LatencyStats stats;
+    LatencyHistogram* histogram = stats.getHistogram("publish", "depth");
+    ASSERT_EQ(stats.getHistogram("publish", "depth"), histogram);
+    stats.getHistogram("fill", "depth");
+
+    const int threads_count(4), records_count(10000);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threads_count; ++t)
+    {
+        threads.emplace_back([histogram, t, records_count]()
+        {
+            for (int i = 0; i < records_count; ++i)
+                histogram->record(1000 * (t + 1));
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // Histograms without latencies are left out.
+    std::vector<LatencyStats::Entry> entries = stats.getEntries();
+    ASSERT_EQ(entries.size(), 1u);
+    ASSERT_EQ(entries[0].stage, "publish");
+    ASSERT_EQ(entries[0].stream, "depth");
+    ASSERT_EQ(entries[0].summary.count, static_cast<uint64_t>(threads_count * records_count));
+    ASSERT_DOUBLE_EQ(entries[0].summary.max_ms, threads_count * 1e-3);
+
+    stats.reset();
+    ASSERT_TRUE(stats.getEntries().empty());
+}
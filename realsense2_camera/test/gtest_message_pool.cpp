@@ -0,0 +1,71 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <message_pool.h>
+#include <cstdint>
+
+using realsense2_camera::MessagePool;
+using realsense2_camera::MessagePoolStats;
+
+struct TestMsg
+{
+    std::vector<uint8_t> data;
+};
+
+TEST(message_pool, reuses_released_buffers)
+{
+    MessagePool<TestMsg> pool;
+    const uint8_t* buffer(nullptr);
+    {
+        auto msg = pool.acquire();
+        msg->data.resize(1024);
+        buffer = msg->data.data();
+    }
+    auto msg = pool.acquire();
+    ASSERT_EQ(msg->data.size(), 1024u);
+    ASSERT_EQ(msg->data.data(), buffer);
+
+    MessagePoolStats stats = pool.getStats();
+    ASSERT_EQ(stats.allocations, 1u);
+    ASSERT_EQ(stats.in_use, 1u);
+    ASSERT_EQ(stats.free, 0u);
+}
+
+TEST(message_pool, tracks_high_water_mark)
+{
+    MessagePool<TestMsg> pool(2);
+    {
+        auto msg1 = pool.acquire();
+        auto msg2 = pool.acquire();
+        auto msg3 = pool.acquire();
+    }
+    MessagePoolStats stats = pool.getStats();
+    ASSERT_EQ(stats.high_water_mark, 3u);
+    ASSERT_EQ(stats.allocations, 3u);
+    ASSERT_EQ(stats.in_use, 0u);
+    ASSERT_EQ(stats.free, 2u);      // bounded by max_free_messages
+}
+
+TEST(message_pool, message_outlives_pool)
+{
+    MessagePool<TestMsg>::Ptr msg;
+    {
+        MessagePool<TestMsg> pool;
+        msg = pool.acquire();
+    }
+    msg->data.resize(16);
+    msg.reset();    // must free the message without touching the destroyed pool
+    SUCCEED();
+}
@@ -0,0 +1,88 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <options_cache.h>
+#include <cstdio>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    SensorOptionsInfo depthModuleOptions()
+    {
+        SensorOptionsInfo options;
+        options.push_back(OptionInfo{3, 1.f, 165000.f, 1.f, 8500.f, "Depth Exposure (usec)", {}});
+        options.push_back(OptionInfo{6, 0.f, 1.f, 1.f, 1.f, "Enable\tAuto Exposure\n\\ back slash", {}});
+        options.push_back(OptionInfo{48, 0.f, 5.f, 1.f, 0.f, "Advanced-Mode Preset",
+                                     {{0, "Custom"}, {1, "Default"}, {3, "High Accuracy"}, {5, "Medium Density"}}});
+        options.push_back(OptionInfo{22, 1e-06f, 0.01f, 1e-06f, 0.001f, "Number of meters represented by a single depth unit", {}});
+        return options;
+    }
+}
+
+TEST(options_cache, round_trip)
+{
+    OptionsCache cache("", "librealsense 25500");
+    cache.set("depth_module", depthModuleOptions());
+    cache.set("rgb_camera", SensorOptionsInfo{OptionInfo{1, -64.f, 64.f, 1.f, 0.f, "Brightness", {}}});
+
+    OptionsCache loaded("", "librealsense 25500");
+    ASSERT_TRUE(loaded.parse(cache.serialize()));
+    SensorOptionsInfo options;
+    ASSERT_TRUE(loaded.get("depth_module", options));
+    EXPECT_TRUE(options == depthModuleOptions());
+    ASSERT_TRUE(loaded.get("rgb_camera", options));
+    ASSERT_EQ(options.size(), 1u);
+    EXPECT_EQ(options[0].min, -64.f);
+    EXPECT_FALSE(loaded.get("motion_module", options));
+}
+
+TEST(options_cache, rejects_other_signatures_and_invalid_contents)
+{
+    OptionsCache cache("", "librealsense 25500");
+    cache.set("depth_module", depthModuleOptions());
+    const std::string content(cache.serialize());
+
+    OptionsCache other_version("", "librealsense 25600");
+    EXPECT_FALSE(other_version.parse(content));
+
+    OptionsCache loaded("", "librealsense 25500");
+    EXPECT_FALSE(loaded.parse(""));
+    EXPECT_FALSE(loaded.parse(content.substr(0, content.find("option\t3\t")) + "option\t3\t1\tx\t1\t8500\tDepth Exposure\n"));
+    EXPECT_FALSE(loaded.parse(content + "garbage\n"));
+    // A failed parse keeps what was there
+    ASSERT_TRUE(loaded.parse(content));
+    EXPECT_FALSE(loaded.parse(content.substr(0, content.size() / 2) + "\nvalue\tx\ty\n"));
+    SensorOptionsInfo options;
+    EXPECT_TRUE(loaded.get("depth_module", options));
+}
+
+TEST(options_cache, save_and_load)
+{
+    const std::string file_path(OptionsCache::filePath(testing::TempDir(), "123456789012", "5.15.1.0"));
+    std::remove(file_path.c_str());
+
+    OptionsCache cache(file_path, "librealsense 25500");
+    EXPECT_FALSE(cache.load());
+    cache.set("depth_module", depthModuleOptions());
+    ASSERT_TRUE(cache.save());
+
+    OptionsCache loaded(file_path, "librealsense 25500");
+    ASSERT_TRUE(loaded.load());
+    SensorOptionsInfo options;
+    ASSERT_TRUE(loaded.get("depth_module", options));
+    EXPECT_TRUE(options == depthModuleOptions());
+    std::remove(file_path.c_str());
+}
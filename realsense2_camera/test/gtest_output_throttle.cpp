@@ -0,0 +1,114 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <output_throttle.h>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    const unsigned int POINTCLOUD = 1 << 2;
+    const unsigned int ALIGNED_DEPTH = 1 << 3;
+    const int64_t MS = 1000000;
+}
+
+TEST(output_throttle, limits_the_rate_of_an_output)
+{
+    OutputThrottle throttle;
+    EXPECT_FALSE(throttle.isEnabled());
+    throttle.setOutput(POINTCLOUD, OutputThrottle::Settings{30.0, 1});
+    EXPECT_TRUE(throttle.isEnabled());
+
+    // 90 fps framesets, with some jitter: every 3rd one is computed
+    int computed(0);
+    for (int frame = 0; frame < 90; ++frame)
+    {
+        const int64_t time_ns(frame * 11111111 + ((frame % 2) ? MS : -MS));
+        const unsigned int outputs = throttle.filter(POINTCLOUD | ALIGNED_DEPTH, time_ns, 0);
+        EXPECT_TRUE(outputs & ALIGNED_DEPTH);
+        if (outputs & POINTCLOUD)
+        {
+            EXPECT_EQ(frame % 3, 0);
+            ++computed;
+        }
+    }
+    EXPECT_EQ(computed, 30);
+    EXPECT_EQ(throttle.getStats()[POINTCLOUD].rate_limited, 60u);
+
+    // After a pause, the first frameset is computed
+    EXPECT_TRUE(throttle.filter(POINTCLOUD, 5000 * MS, 0) & POINTCLOUD);
+    EXPECT_FALSE(throttle.filter(POINTCLOUD, 5011 * MS, 0) & POINTCLOUD);
+}
+
+TEST(output_throttle, decimates_while_overloaded)
+{
+    OutputThrottle throttle(0.05);
+    throttle.setOutput(POINTCLOUD, OutputThrottle::Settings{0, 4});
+    int64_t time_ns(0);
+    for (int frame = 0; frame < 10; ++frame, time_ns += 33 * MS)
+        EXPECT_EQ(throttle.filter(POINTCLOUD | ALIGNED_DEPTH, time_ns, 10 * MS), POINTCLOUD | ALIGNED_DEPTH);
+    EXPECT_FALSE(throttle.isOverloaded());
+
+    // The latency builds up over a few framesets, then every 4th one is computed
+    int computed(0);
+    for (int frame = 0; frame < 40; ++frame, time_ns += 33 * MS)
+    {
+        const unsigned int outputs = throttle.filter(POINTCLOUD | ALIGNED_DEPTH, time_ns, 200 * MS);
+        EXPECT_TRUE(outputs & ALIGNED_DEPTH);
+        computed += (outputs & POINTCLOUD) ? 1 : 0;
+    }
+    EXPECT_TRUE(throttle.isOverloaded());
+    EXPECT_GE(computed, 10);
+    EXPECT_LE(computed, 14);
+    EXPECT_GT(throttle.getStats()[POINTCLOUD].decimated, 25u);
+
+    // Back to every frameset once the latency is under 80% of the budget
+    for (int frame = 0; frame < 40; ++frame, time_ns += 33 * MS)
+        throttle.filter(POINTCLOUD, time_ns, 10 * MS);
+    EXPECT_FALSE(throttle.isOverloaded());
+    EXPECT_EQ(throttle.filter(POINTCLOUD, time_ns, 10 * MS), POINTCLOUD);
+    EXPECT_EQ(throttle.filter(POINTCLOUD, time_ns + 33 * MS, 10 * MS), POINTCLOUD);
+}
+
+TEST(output_throttle, bounds_the_huge_and_ignores_the_negative_latencies)
+{
+    OutputThrottle throttle(0.05);
+    throttle.setOutput(POINTCLOUD, OutputThrottle::Settings{0, 4});
+    int64_t time_ns(0);
+
+    // Unknown latencies leave the throttle as is
+    for (int frame = 0; frame < 10; ++frame, time_ns += 33 * MS)
+        EXPECT_EQ(throttle.filter(POINTCLOUD, time_ns, -1), POINTCLOUD);
+    EXPECT_FALSE(throttle.isOverloaded());
+    EXPECT_EQ(throttle.getLatencySeconds(), 0);
+
+    for (int frame = 0; frame < 10; ++frame, time_ns += 33 * MS)
+        throttle.filter(POINTCLOUD, time_ns, 10 * MS);
+    EXPECT_FALSE(throttle.isOverloaded());
+
+    // A single frameset stamped ahead of a clock step does not overload the host on its own
+    EXPECT_EQ(throttle.filter(POINTCLOUD, time_ns, INT64_MAX), POINTCLOUD);
+    EXPECT_FALSE(throttle.isOverloaded());
+    EXPECT_LT(throttle.getLatencySeconds(), 0.05);
+    time_ns += 33 * MS;
+    EXPECT_EQ(throttle.filter(POINTCLOUD, time_ns, -1000 * MS), POINTCLOUD);
+    EXPECT_FALSE(throttle.isOverloaded());
+
+    // Back to the regular latency within a few framesets
+    for (int frame = 0; frame < 20; ++frame, time_ns += 33 * MS)
+        throttle.filter(POINTCLOUD, time_ns, 10 * MS);
+    EXPECT_NEAR(throttle.getLatencySeconds(), 0.01, 0.005);
+}
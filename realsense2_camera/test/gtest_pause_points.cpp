@@ -0,0 +1,85 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <pause_points.h>
+
+using realsense2_camera::PausePoints;
+
+static const size_t NO_LIMIT = std::numeric_limits<size_t>::max();
+
+TEST(pause_points, no_limit_when_empty)
+{
+    PausePoints points;
+    ASSERT_TRUE(points.empty());
+    ASSERT_EQ(points.releaseLimit(), NO_LIMIT);
+    auto id = points.add(5);
+    ASSERT_EQ(points.releaseLimit(), 5u);
+    points.remove(id);
+    ASSERT_TRUE(points.empty());
+    ASSERT_EQ(points.releaseLimit(), NO_LIMIT);
+}
+
+TEST(pause_points, overlapping_released_in_order)
+{
+    PausePoints points;
+    auto older = points.add(3);
+    auto newer = points.add(7);
+    ASSERT_EQ(points.releaseLimit(), 3u);
+    points.remove(older);
+    ASSERT_EQ(points.releaseLimit(), 7u);
+    points.remove(newer);
+    ASSERT_EQ(points.releaseLimit(), NO_LIMIT);
+}
+
+TEST(pause_points, overlapping_released_in_reverse_order)
+{
+    // The newer frame finishes, or is dropped, first: the older frame is still in process,
+    // so the messages received after it started must stay held back.
+    PausePoints points;
+    auto older = points.add(3);
+    auto newer = points.add(7);
+    points.remove(newer);
+    ASSERT_EQ(points.size(), 1u);
+    ASSERT_EQ(points.releaseLimit(), 3u);
+    points.remove(older);
+    ASSERT_EQ(points.releaseLimit(), NO_LIMIT);
+}
+
+TEST(pause_points, middle_point_removed)
+{
+    PausePoints points;
+    auto first = points.add(1);
+    auto second = points.add(4);
+    auto third = points.add(9);
+    points.remove(second);
+    ASSERT_EQ(points.releaseLimit(), 1u);
+    points.remove(first);
+    ASSERT_EQ(points.releaseLimit(), 9u);
+    points.remove(third);
+    ASSERT_TRUE(points.empty());
+}
+
+TEST(pause_points, same_count_points_are_distinct)
+{
+    // Frames starting with no IMU message in between share a messages count.
+    PausePoints points;
+    auto first = points.add(2);
+    auto second = points.add(2);
+    ASSERT_NE(first, second);
+    points.remove(second);
+    ASSERT_EQ(points.releaseLimit(), 2u);
+    points.remove(first);
+    ASSERT_EQ(points.releaseLimit(), NO_LIMIT);
+}
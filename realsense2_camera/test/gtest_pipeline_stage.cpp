@@ -0,0 +1,135 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <pipeline_stage.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using realsense2_camera::PipelineStage;
+using realsense2_camera::PipelineStageStats;
+
+namespace
+{
+    // Keeps the worker busy until released, so that the following jobs stay in the queue.
+    class Gate
+    {
+        public:
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _is_entered = true;
+                _cv.notify_all();
+                _cv.wait(lock, [this]{ return _is_open; });
+            }
+            void waitEntered()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait(lock, [this]{ return _is_entered; });
+            }
+            void open()
+            {
+                std::lock_guard<std::mutex> lock_guard(_mutex);
+                _is_open = true;
+                _cv.notify_all();
+            }
+        private:
+            std::mutex _mutex;
+            std::condition_variable _cv;
+            bool _is_entered = false;
+            bool _is_open = false;
+    };
+
+    std::vector<int> runBlockedStage(PipelineStage::DropPolicy drop_policy, PipelineStageStats& stats)
+    {
+        std::vector<int> done;
+        Gate gate;
+        PipelineStage stage("test", 2, drop_policy);
+        stage.push([&gate]{ gate.wait(); });
+        gate.waitEntered();
+        for (int i = 1; i <= 4; ++i)
+            stage.push([&done, i]{ done.push_back(i); });
+        gate.open();
+
+        // The gate job and the 2 jobs left in the queue
+        while (stage.getStats().processed < 3)
+            std::this_thread::yield();
+        stats = stage.getStats();
+        return done;
+    }
+}
+
+TEST(pipeline_stage, runs_jobs_in_order)
+{
+    std::vector<int> done;
+    {
+        PipelineStage stage("test", 100, PipelineStage::DropPolicy::DROP_NEWEST);
+        for (int i = 0; i < 50; ++i)
+            ASSERT_TRUE(stage.push([&done, i]{ done.push_back(i); }));
+        stage.push([]{});
+        while (stage.getStats().processed < 51)
+            std::this_thread::yield();
+    }
+    ASSERT_EQ(done.size(), 50u);
+    for (int i = 0; i < 50; ++i)
+        ASSERT_EQ(done[i], i);
+}
+
+TEST(pipeline_stage, drop_oldest)
+{
+    PipelineStageStats stats;
+    // Queue of 2: jobs 1 and 2 are pushed out by 3 and 4.
+    std::vector<int> done = runBlockedStage(PipelineStage::DropPolicy::DROP_OLDEST, stats);
+    ASSERT_EQ(done, std::vector<int>({3, 4}));
+    ASSERT_EQ(stats.dropped, 2u);
+}
+
+TEST(pipeline_stage, drop_newest)
+{
+    PipelineStageStats stats;
+    std::vector<int> done = runBlockedStage(PipelineStage::DropPolicy::DROP_NEWEST, stats);
+    ASSERT_EQ(done, std::vector<int>({1, 2}));
+    ASSERT_EQ(stats.dropped, 2u);
+    ASSERT_EQ(stats.queue_size, 0u);
+}
+
+TEST(pipeline_stage, flush_discards_waiting_jobs)
+{
+    std::vector<int> done;
+    Gate gate;
+    PipelineStage stage("test", 4, PipelineStage::DropPolicy::DROP_NEWEST);
+    stage.push([&gate]{ gate.wait(); });
+    gate.waitEntered();
+    stage.push([&done]{ done.push_back(1); });
+    ASSERT_EQ(stage.getStats().queue_size, 1u);
+
+    std::thread flusher([&stage]{ stage.flush(); });
+    while (stage.getStats().queue_size != 0)
+        std::this_thread::yield();
+    gate.open();
+    flusher.join();
+    ASSERT_EQ(stage.getStats().processed, 1u);
+    ASSERT_TRUE(done.empty());
+}
+
+TEST(pipeline_stage, parse_drop_policy)
+{
+    PipelineStage::DropPolicy drop_policy;
+    ASSERT_TRUE(PipelineStage::parseDropPolicy("drop_newest", drop_policy));
+    ASSERT_EQ(drop_policy, PipelineStage::DropPolicy::DROP_NEWEST);
+    ASSERT_TRUE(PipelineStage::parseDropPolicy("drop_oldest", drop_policy));
+    ASSERT_EQ(drop_policy, PipelineStage::DropPolicy::DROP_OLDEST);
+    ASSERT_FALSE(PipelineStage::parseDropPolicy("fifo", drop_policy));
+}
@@ -0,0 +1,70 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <pointcloud_encoding.h>
+#include <cmath>
+#include <limits>
+
+using namespace realsense2_camera;
+
+TEST(pointcloud_encoding, half_round_trips)
+{
+    // Every half float but the nans converts to a float and back to itself.
+    for (uint32_t half = 0; half <= 0xffff; ++half)
+    {
+        if ((half & 0x7c00) == 0x7c00 && (half & 0x3ff))
+            continue;
+        ASSERT_EQ(floatToHalf(halfToFloat(static_cast<uint16_t>(half))), half);
+    }
+    ASSERT_TRUE(std::isnan(halfToFloat(floatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(pointcloud_encoding, half_rounds_to_nearest_even)
+{
+    ASSERT_EQ(halfToFloat(floatToHalf(1.f + 1.f / 4096)), 1.f);                        // below half an ulp
+    ASSERT_EQ(halfToFloat(floatToHalf(1.f + 1.f / 2048)), 1.f);                        // ties to the even mantissa
+    ASSERT_EQ(halfToFloat(floatToHalf(1.f + 3.f / 2048)), 1.f + 2.f / 1024);
+    ASSERT_EQ(halfToFloat(floatToHalf(65519.f)), 65504.f);
+    ASSERT_TRUE(std::isinf(halfToFloat(floatToHalf(65520.f))));
+    ASSERT_EQ(halfToFloat(floatToHalf(-std::ldexp(3.f, -25))), -std::ldexp(2.f, -24));   // subnormal tie, to even
+    ASSERT_EQ(halfToFloat(floatToHalf(std::ldexp(1.f, -25))), 0.f);
+
+    // The documented precision of the depths
+    for (float meters = 0.f; meters < 8.f; meters += 0.0007f)
+    {
+        float max_error = (meters < 1.f) ? 0.00025f : (meters < 2.f) ? 0.0005f : (meters < 4.f) ? 0.001f : 0.002f;
+        ASSERT_LE(std::fabs(halfToFloat(floatToHalf(meters)) - meters), max_error);
+    }
+}
+
+TEST(pointcloud_encoding, int16_millimeters)
+{
+    ASSERT_EQ(metersToInt16Mm(0.f), 0);
+    ASSERT_EQ(metersToInt16Mm(1.2344f), 1234);
+    ASSERT_EQ(metersToInt16Mm(1.2346f), 1235);
+    ASSERT_EQ(metersToInt16Mm(-1.2346f), -1235);
+    ASSERT_EQ(metersToInt16Mm(32.767f), 32767);
+    ASSERT_EQ(metersToInt16Mm(40.f), 32767);
+    ASSERT_EQ(metersToInt16Mm(-40.f), -32767);
+    ASSERT_EQ(metersToInt16Mm(std::numeric_limits<float>::quiet_NaN()), 0);
+    ASSERT_FLOAT_EQ(int16MmToMeters(1235), 1.235f);
+
+    PointEncoding encoding;
+    ASSERT_TRUE(parsePointEncoding("int16_mm", encoding));
+    ASSERT_EQ(encoding, PointEncoding::INT16_MM);
+    ASSERT_FALSE(parsePointEncoding("int8", encoding));
+    ASSERT_EQ(pointStep(PointEncoding::FLOAT32, true), 20u);
+    ASSERT_EQ(pointStep(PointEncoding::FLOAT16, false), 6u);
+}
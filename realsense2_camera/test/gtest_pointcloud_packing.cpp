@@ -0,0 +1,253 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <pointcloud_packing.h>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    // A pointcloud with invalid depths and texture coordinates out of the texture, including its edges.
+    struct TestCloud
+    {
+        std::vector<float> vertices;
+        std::vector<float> texture_coordinates;
+        std::vector<uint8_t> texture_data;
+        PointcloudTexture texture;
+
+        TestCloud(size_t count, int bytes_per_pixel)
+        {
+            std::mt19937 gen(17);
+            std::uniform_real_distribution<float> position(-1.f, 2.f);
+            std::uniform_real_distribution<float> coordinate(-0.2f, 1.2f);
+            for (size_t i = 0; i < count; ++i)
+            {
+                vertices.push_back(position(gen));
+                vertices.push_back(position(gen));
+                vertices.push_back(i % 5 == 0 ? 0.f : position(gen));
+                texture_coordinates.push_back(i % 7 == 0 ? 1.f : coordinate(gen));
+                texture_coordinates.push_back(i % 11 == 0 ? 0.f : coordinate(gen));
+            }
+            texture = {nullptr, 8, 6, bytes_per_pixel};
+            texture_data.resize(texture.width * (texture.height + 1) * bytes_per_pixel);
+            for (size_t i = 0; i < texture_data.size(); ++i)
+                texture_data[i] = static_cast<uint8_t>(i * 37 + 1);
+            texture.data = texture_data.data();
+        }
+        size_t size() const { return vertices.size() / 3; }
+    };
+
+    // The per-point implementation packing was written against, on a zeroed message buffer.
+    std::vector<uint8_t> referencePack(const TestCloud& cloud, bool use_texture, bool allow_no_texture_points, bool ordered, size_t& valid_count)
+    {
+        size_t point_step = use_texture ? 20 : 16;
+        std::vector<uint8_t> data(cloud.size() * point_step, 0);
+        valid_count = 0;
+        for (size_t i = 0; i < cloud.size(); ++i)
+        {
+            const float* vertex = &cloud.vertices[3 * i];
+            float u(cloud.texture_coordinates[2 * i]), v(cloud.texture_coordinates[2 * i + 1]);
+            bool valid_color_pixel(u >= 0.f && u <= 1.f && v >= 0.f && v <= 1.f);
+            bool valid_pixel = use_texture ? (vertex[2] > 0 && (valid_color_pixel || allow_no_texture_points)) : vertex[2] > 0;
+            if (!valid_pixel && !ordered)
+                continue;
+            uint8_t* point = &data[valid_count * point_step];
+            memcpy(point, vertex, 3 * sizeof(float));
+            if (use_texture && valid_color_pixel)
+            {
+                int pixx = static_cast<int>(u * cloud.texture.width);
+                int pixy = static_cast<int>(v * cloud.texture.height);
+                const uint8_t* color = cloud.texture.data + (pixy * cloud.texture.width + pixx) * cloud.texture.bytes_per_pixel;
+                // Clamped to the last pixel of the row, as texture coordinates of 1.0 would otherwise read the next row.
+                if (pixx == cloud.texture.width)
+                    color -= cloud.texture.bytes_per_pixel;
+                if (pixy == cloud.texture.height)
+                    color -= cloud.texture.width * cloud.texture.bytes_per_pixel;
+                for (int c = 0; c < cloud.texture.bytes_per_pixel; ++c)
+                    point[16 + cloud.texture.bytes_per_pixel - 1 - c] = color[c];
+            }
+            ++valid_count;
+        }
+        data.resize(valid_count * point_step);
+        return data;
+    }
+}
+
+TEST(pointcloud_packing, matches_reference_without_texture)
+{
+    TestCloud cloud(1001, 3);
+    for (bool ordered : {false, true})
+    {
+        size_t expected_count;
+        std::vector<uint8_t> expected = referencePack(cloud, false, false, ordered, expected_count);
+
+        std::vector<PackedPoint> points(cloud.size(), PackedPoint{7.f, 7.f, 7.f, 7});
+        if (!ordered)
+        {
+            ASSERT_EQ(countValidPoints(cloud.vertices.data(), cloud.size()), expected_count);
+        }
+        size_t count = packPoints(cloud.vertices.data(), cloud.size(), ordered, points.data(), points.size());
+        ASSERT_EQ(count, expected_count);
+        ASSERT_EQ(memcmp(points.data(), expected.data(), expected.size()), 0);
+    }
+}
+
+TEST(pointcloud_packing, matches_reference_with_texture)
+{
+    for (int bytes_per_pixel : {1, 3})
+    {
+        TestCloud cloud(1001, bytes_per_pixel);
+        for (bool allow_no_texture_points : {false, true})
+        {
+            for (bool ordered : {false, true})
+            {
+                size_t expected_count;
+                std::vector<uint8_t> expected = referencePack(cloud, true, allow_no_texture_points, ordered, expected_count);
+
+                std::vector<PackedTexturedPoint> points(cloud.size());
+                memset(points.data(), 0xab, points.size() * sizeof(PackedTexturedPoint));
+                size_t count = packTexturedPoints(cloud.vertices.data(), cloud.texture_coordinates.data(), cloud.size(), cloud.texture,
+                                                  allow_no_texture_points, ordered, points.data(), points.size());
+                ASSERT_EQ(count, expected_count);
+                ASSERT_EQ(memcmp(points.data(), expected.data(), expected.size()), 0);
+                if (!ordered)
+                {
+                    ASSERT_EQ(countValidTexturedPoints(cloud.vertices.data(), cloud.texture_coordinates.data(), cloud.size(), allow_no_texture_points), expected_count);
+                }
+            }
+        }
+    }
+}
+
+TEST(pointcloud_packing, bands_concatenate_to_single_pass)
+{
+    // Packing bands at their counted offsets gives the same buffer as one pass, without writing past a band.
+    TestCloud cloud(999, 3);
+    std::vector<PackedTexturedPoint> single(cloud.size());
+    size_t single_count = packTexturedPoints(cloud.vertices.data(), cloud.texture_coordinates.data(), cloud.size(), cloud.texture,
+                                             false, false, single.data(), single.size());
+
+    std::vector<PackedTexturedPoint> banded(cloud.size() + 1);
+    memset(banded.data(), 0xcd, banded.size() * sizeof(PackedTexturedPoint));
+    const size_t band_size(333);
+    size_t out(0);
+    for (size_t begin = 0; begin < cloud.size(); begin += band_size)
+    {
+        size_t capacity = countValidTexturedPoints(&cloud.vertices[3 * begin], &cloud.texture_coordinates[2 * begin], band_size, false);
+        size_t count = packTexturedPoints(&cloud.vertices[3 * begin], &cloud.texture_coordinates[2 * begin], band_size, cloud.texture,
+                                          false, false, banded.data() + out, capacity);
+        ASSERT_EQ(count, capacity);
+        out += count;
+        ASSERT_EQ(banded[out].color[0], 0xcd);
+    }
+    ASSERT_EQ(out, single_count);
+    ASSERT_EQ(memcmp(banded.data(), single.data(), single_count * sizeof(PackedTexturedPoint)), 0);
+}
+
+TEST(pointcloud_packing, selection_skips_strided_and_out_of_range_points)
+{
+    TestCloud cloud(1001, 3);
+    PointSelection selection;
+    selection.stride = 3;
+    selection.min_z = 0.5f;
+    selection.max_z = 1.5f;
+    const size_t count = (cloud.size() + selection.stride - 1) / selection.stride;
+
+    // The reference packs a copy of the selected points, with the points out of range zeroed.
+    TestCloud selected(0, 3);
+    selected.texture = cloud.texture;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* vertex = &cloud.vertices[3 * i * selection.stride];
+        bool is_in_range = vertex[2] >= selection.min_z && vertex[2] <= selection.max_z;
+        for (int c = 0; c < 3; ++c)
+            selected.vertices.push_back(is_in_range ? vertex[c] : 0.f);
+        selected.texture_coordinates.push_back(cloud.texture_coordinates[2 * i * selection.stride]);
+        selected.texture_coordinates.push_back(cloud.texture_coordinates[2 * i * selection.stride + 1]);
+    }
+    for (bool ordered : {false, true})
+    {
+        size_t expected_count;
+        std::vector<uint8_t> expected = referencePack(selected, false, false, ordered, expected_count);
+        std::vector<PackedPoint> points(count);
+        ASSERT_EQ(packPoints(cloud.vertices.data(), count, ordered, points.data(), points.size(), selection), expected_count);
+        ASSERT_EQ(memcmp(points.data(), expected.data(), expected.size()), 0);
+        if (!ordered)
+        {
+            ASSERT_EQ(countValidPoints(cloud.vertices.data(), count, selection), expected_count);
+        }
+
+        expected = referencePack(selected, true, true, ordered, expected_count);
+        std::vector<PackedTexturedPoint> textured_points(count);
+        ASSERT_EQ(packTexturedPoints(cloud.vertices.data(), cloud.texture_coordinates.data(), count, cloud.texture,
+                                     true, ordered, textured_points.data(), textured_points.size(), selection), expected_count);
+        ASSERT_EQ(memcmp(textured_points.data(), expected.data(), expected.size()), 0);
+        if (!ordered)
+        {
+            ASSERT_EQ(countValidTexturedPoints(cloud.vertices.data(), cloud.texture_coordinates.data(), count, true, selection), expected_count);
+        }
+    }
+}
+
+TEST(pointcloud_packing, encodings_match_float32)
+{
+    // Compact encodings pack the same points as float32, each field converted.
+    TestCloud cloud(1001, 3);
+    for (bool ordered : {false, true})
+    {
+        std::vector<PackedTexturedPoint> expected(cloud.size());
+        size_t expected_count = packTexturedPoints(cloud.vertices.data(), cloud.texture_coordinates.data(), cloud.size(), cloud.texture,
+                                                   false, ordered, expected.data(), expected.size());
+
+        std::vector<uint8_t> float32(cloud.size() * pointStep(PointEncoding::FLOAT32, true));
+        ASSERT_EQ(packEncodedPoints(PointEncoding::FLOAT32, cloud.vertices.data(), cloud.texture_coordinates.data(), cloud.size(), &cloud.texture,
+                                    false, ordered, float32.data(), cloud.size()), expected_count);
+        ASSERT_EQ(memcmp(float32.data(), expected.data(), expected_count * sizeof(PackedTexturedPoint)), 0);
+
+        for (PointEncoding encoding : {PointEncoding::INT16_MM, PointEncoding::FLOAT16})
+        {
+            const size_t point_step = pointStep(encoding, true);
+            std::vector<uint8_t> data(cloud.size() * point_step);
+            ASSERT_EQ(packEncodedPoints(encoding, cloud.vertices.data(), cloud.texture_coordinates.data(), cloud.size(), &cloud.texture,
+                                        false, ordered, data.data(), cloud.size()), expected_count);
+            for (size_t i = 0; i < expected_count; ++i)
+            {
+                const uint8_t* point = &data[i * point_step];
+                int16_t xyz[3];
+                memcpy(xyz, point, sizeof(xyz));
+                const float* expected_xyz = &expected[i].x;
+                for (int c = 0; c < 3; ++c)
+                {
+                    float value = (encoding == PointEncoding::INT16_MM) ? int16MmToMeters(xyz[c]) : halfToFloat(static_cast<uint16_t>(xyz[c]));
+                    ASSERT_NEAR(value, expected_xyz[c], 0.001f);
+                }
+                ASSERT_EQ(memcmp(point + 6, expected[i].color, 4), 0);
+            }
+        }
+    }
+
+    // Without texture
+    std::vector<PackedPoint> expected(cloud.size());
+    size_t expected_count = packPoints(cloud.vertices.data(), cloud.size(), false, expected.data(), expected.size());
+    std::vector<uint8_t> data(cloud.size() * pointStep(PointEncoding::INT16_MM, false));
+    ASSERT_EQ(packEncodedPoints(PointEncoding::INT16_MM, cloud.vertices.data(), nullptr, cloud.size(), nullptr,
+                                false, false, data.data(), cloud.size()), expected_count);
+    int16_t last_xyz[3];
+    memcpy(last_xyz, &data[(expected_count - 1) * 6], sizeof(last_xyz));
+    ASSERT_EQ(last_xyz[2], metersToInt16Mm(expected[expected_count - 1].z));
+}
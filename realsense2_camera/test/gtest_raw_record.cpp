@@ -0,0 +1,181 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <raw_record.h>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace realsense2_camera;
+
+namespace
+{
+    RawRecordDescription depthAndAccelDescription()
+    {
+        RawRecordDescription description;
+        description.infos.push_back(std::make_pair(0, "Intel RealSense D455"));
+        description.infos.push_back(std::make_pair(1, "123456789012"));
+
+        RawStreamInfo depth = {};
+        depth.stream_id = 0;
+        depth.stream = 1;
+        depth.format = 1;
+        depth.fps = 90;
+        depth.is_video = true;
+        depth.width = 8;
+        depth.height = 4;
+        depth.ppx = 4.25f;
+        depth.fx = 425.123f;
+        depth.coeffs[0] = -0.0571f;
+        depth.rotation[0] = depth.rotation[4] = depth.rotation[8] = 1.f;
+        description.sensors.push_back(RawSensorInfo{"Stereo Module", 0.001f, {depth}});
+
+        RawStreamInfo accel = {};
+        accel.stream_id = 1;
+        accel.stream = 6;
+        accel.format = 12;
+        accel.fps = 200;
+        accel.translation[0] = -0.0302f;
+        description.sensors.push_back(RawSensorInfo{"Motion Module", 0.f, {accel}});
+        return description;
+    }
+
+    RawFrameIndex frameIndex(uint32_t stream_id, uint64_t frame_number, uint32_t size, uint32_t metadata_count)
+    {
+        RawFrameIndex index = {};
+        index.stream_id = stream_id;
+        index.frame_number = frame_number;
+        index.timestamp = 1000.5 + frame_number;
+        index.timestamp_domain = 0;
+        index.arrival_time_ns = frame_number * 11111111;
+        index.size = size;
+        index.metadata_count = metadata_count;
+        return index;
+    }
+}
+
+TEST(raw_record, description_round_trip)
+{
+    const RawRecordDescription description(depthAndAccelDescription());
+    RawRecordDescription parsed;
+    ASSERT_TRUE(parsed.parse(description.serialize()));
+    EXPECT_EQ(parsed.serialize(), description.serialize());
+    ASSERT_EQ(parsed.sensors.size(), 2u);
+    EXPECT_EQ(parsed.sensors[0].name, "Stereo Module");
+    EXPECT_EQ(parsed.sensors[0].depth_units, 0.001f);
+    EXPECT_EQ(parsed.sensors[0].streams[0].fx, 425.123f);
+    EXPECT_TRUE(parsed.sensors[0].streams[0].is_video);
+    EXPECT_FALSE(parsed.sensors[1].streams[0].is_video);
+    EXPECT_EQ(parsed.sensors[1].streams[0].translation[0], -0.0302f);
+    EXPECT_EQ(parsed.infos[1].second, "123456789012");
+
+    EXPECT_FALSE(parsed.parse(""));
+    EXPECT_FALSE(parsed.parse(description.serialize() + "video\t2\t1\n"));
+}
+
+TEST(raw_record, frames_round_trip_across_segments)
+{
+    const std::string dir_path(testing::TempDir() + "raw_record_test");
+    std::vector<uint8_t> depth_payload(64);
+    for (size_t i = 0; i < depth_payload.size(); ++i)
+        depth_payload[i] = static_cast<uint8_t>(i);
+    const float accel_payload[3] = {0.1f, -9.81f, 0.2f};
+    const RawMetadata metadata[2] = {{0, 0, 123456}, {7, 0, -5}};
+
+    {
+        // A segment holds 2 depth frames with their metadata
+        RawRecordWriter writer(dir_path, 200);
+        ASSERT_TRUE(writer.open(depthAndAccelDescription()));
+        for (uint64_t frame_number = 0; frame_number < 5; ++frame_number)
+        {
+            depth_payload[0] = static_cast<uint8_t>(frame_number);
+            EXPECT_TRUE(writer.write(frameIndex(0, frame_number, depth_payload.size(), 2), metadata, depth_payload.data()));
+            EXPECT_TRUE(writer.write(frameIndex(1, frame_number, sizeof(accel_payload), 0), nullptr, accel_payload));
+        }
+        std::vector<uint8_t> too_large(300);
+        EXPECT_FALSE(writer.write(frameIndex(0, 5, too_large.size(), 0), nullptr, too_large.data()));
+        EXPECT_EQ(writer.getFramesCount(), 10u);
+        EXPECT_EQ(writer.getDroppedCount(), 1u);
+        EXPECT_TRUE(writer.close());
+    }
+
+    RawRecordReader reader;
+    ASSERT_TRUE(reader.open(dir_path));
+    EXPECT_EQ(reader.getDescription().serialize(), depthAndAccelDescription().serialize());
+    ASSERT_EQ(reader.size(), 10u);
+    for (size_t frame = 0; frame < reader.size(); ++frame)
+    {
+        const RawFrameIndex& index = reader.index(frame);
+        EXPECT_EQ(index.frame_number, frame / 2);
+        EXPECT_EQ(index.timestamp, 1000.5 + frame / 2);
+        EXPECT_EQ(index.arrival_time_ns, static_cast<int64_t>(frame / 2) * 11111111);
+        if (0 == index.stream_id)
+        {
+            ASSERT_EQ(index.size, depth_payload.size());
+            ASSERT_EQ(index.metadata_count, 2u);
+            EXPECT_EQ(reader.metadata(frame)[0].value, 123456);
+            EXPECT_EQ(reader.metadata(frame)[1].key, 7);
+            EXPECT_EQ(static_cast<const uint8_t*>(reader.data(frame))[0], frame / 2);
+            EXPECT_EQ(0, std::memcmp(static_cast<const uint8_t*>(reader.data(frame)) + 1, depth_payload.data() + 1, depth_payload.size() - 1));
+        }
+        else
+        {
+            ASSERT_EQ(index.size, sizeof(accel_payload));
+            EXPECT_EQ(0, std::memcmp(reader.data(frame), accel_payload, sizeof(accel_payload)));
+        }
+    }
+    EXPECT_GT(reader.index(9).segment, 0u);
+}
+
+TEST(raw_record, segments_swapped_from_several_threads)
+{
+    const std::string dir_path(testing::TempDir() + "raw_record_threads_test");
+    const size_t frames_per_thread(200);
+    {
+        // Each segment holds 3 frames of 64 bytes: most frames swap or wait for the next segment
+        RawRecordWriter writer(dir_path, 200);
+        ASSERT_TRUE(writer.open(depthAndAccelDescription()));
+        std::vector<std::thread> threads;
+        for (uint32_t stream_id = 0; stream_id < 2; ++stream_id)
+        {
+            threads.emplace_back([&writer, stream_id, frames_per_thread]()
+            {
+                std::vector<uint8_t> payload(64, static_cast<uint8_t>(stream_id));
+                for (uint64_t frame_number = 0; frame_number < frames_per_thread; ++frame_number)
+                    EXPECT_TRUE(writer.write(frameIndex(stream_id, frame_number, payload.size(), 0), nullptr, payload.data()));
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        EXPECT_EQ(writer.getDroppedCount(), 0u);
+        EXPECT_TRUE(writer.close());
+    }
+
+    RawRecordReader reader;
+    ASSERT_TRUE(reader.open(dir_path));
+    ASSERT_EQ(reader.size(), 2 * frames_per_thread);
+    uint32_t last_segment(0);
+    for (size_t frame = 0; frame < reader.size(); ++frame)
+    {
+        const RawFrameIndex& index = reader.index(frame);
+        EXPECT_GE(index.segment, last_segment);
+        last_segment = index.segment;
+        EXPECT_EQ(static_cast<const uint8_t*>(reader.data(frame))[63], index.stream_id);
+    }
+    // The segment opened ahead and left unused is removed
+    std::string unused_segment(dir_path + "/segment_" + std::to_string(last_segment + 1));
+    EXPECT_NE(0, std::remove(unused_segment.c_str()));
+}
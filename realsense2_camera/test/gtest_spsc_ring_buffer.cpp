@@ -0,0 +1,68 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <spsc_ring_buffer.h>
+#include <thread>
+
+using realsense2_camera::SpscRingBuffer;
+
+TEST(spsc_ring_buffer, bounded_fifo)
+{
+    SpscRingBuffer<int> buffer(3);
+    ASSERT_EQ(buffer.capacity(), 3u);
+    ASSERT_TRUE(buffer.empty());
+    ASSERT_EQ(buffer.front(), nullptr);
+    for (int round = 0; round < 5; ++round)
+    {
+        ASSERT_TRUE(buffer.push(1));
+        ASSERT_TRUE(buffer.push(2));
+        ASSERT_TRUE(buffer.push(3));
+        ASSERT_FALSE(buffer.push(4));
+        for (int expected = 1; expected <= 3; ++expected)
+        {
+            ASSERT_NE(buffer.front(), nullptr);
+            ASSERT_EQ(*buffer.front(), expected);
+            buffer.pop();
+        }
+        ASSERT_TRUE(buffer.empty());
+    }
+}
+
+TEST(spsc_ring_buffer, producer_and_consumer_threads)
+{
+    const int items_count(100000);
+    SpscRingBuffer<int> buffer(16);
+    std::thread producer([&buffer, items_count]()
+    {
+        for (int i = 0; i < items_count; ++i)
+        {
+            while (!buffer.push(i))
+                std::this_thread::yield();
+        }
+    });
+    int out_of_order(0);
+    for (int expected = 0; expected < items_count; ++expected)
+    {
+        int* item;
+        while (!(item = buffer.front()))
+            std::this_thread::yield();
+        if (*item != expected)
+            out_of_order++;
+        buffer.pop();
+    }
+    producer.join();
+    ASSERT_EQ(out_of_order, 0);
+    ASSERT_TRUE(buffer.empty());
+}
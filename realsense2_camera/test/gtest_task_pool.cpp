@@ -0,0 +1,75 @@
+// Copyright 2023 Intel Corporation. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <task_pool.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+using realsense2_camera::TaskPool;
+
+TEST(task_pool, runs_all_tasks_before_returning)
+{
+    TaskPool pool(4);
+    ASSERT_EQ(pool.getThreadsCount(), 4u);
+    for (int batch = 0; batch < 100; ++batch)
+    {
+        std::atomic<int> done(0);
+        std::vector<TaskPool::Task> tasks(7, [&done]{ done++; });
+        pool.run(tasks);
+        ASSERT_EQ(done, 7);
+    }
+}
+
+TEST(task_pool, runs_tasks_in_parallel)
+{
+    // Two tasks blocking until both are running: only completes if they run at the same time.
+    TaskPool pool(2);
+    std::atomic<int> running(0);
+    auto task = [&running]
+    {
+        running++;
+        auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (running < 2 && std::chrono::steady_clock::now() < timeout)
+            std::this_thread::yield();
+    };
+    auto start = std::chrono::steady_clock::now();
+    pool.run({task, task});
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+}
+
+TEST(task_pool, single_thread_runs_on_caller)
+{
+    TaskPool pool(1);
+    std::thread::id caller = std::this_thread::get_id();
+    std::vector<std::thread::id> ids(3);
+    pool.run({[&]{ ids[0] = std::this_thread::get_id(); },
+              [&]{ ids[1] = std::this_thread::get_id(); },
+              [&]{ ids[2] = std::this_thread::get_id(); }});
+    for (auto& id : ids)
+        ASSERT_EQ(id, caller);
+}
+
+TEST(task_pool, rethrows_task_exception_after_all_tasks)
+{
+    TaskPool pool(3);
+    std::atomic<int> done(0);
+    std::vector<TaskPool::Task> tasks;
+    tasks.push_back([]{ throw std::runtime_error("task failed"); });
+    for (int i = 0; i < 5; ++i)
+        tasks.push_back([&done]{ done++; });
+    ASSERT_THROW(pool.run(tasks), std::runtime_error);
+    ASSERT_EQ(done, 5);
+}
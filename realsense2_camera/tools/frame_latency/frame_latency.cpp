@@ -14,19 +14,37 @@
 
 // DESCRIPTION: #
 // ------------ #
-// This tool created a node which can be used to calulate the specified topic's latency.
+// This tool created a node which can be used to calulate the latency of the specified topics.
+// Latencies are measured from the message header stamp to its reception time, and reported
+// periodically per topic: min, mean, 99th percentile, max and jitter over a rolling window,
+// and the messages dropped, estimated from gaps in the header stamps.
 // Input parameters: 
 //    - topic_name : <String>
-//          - topic to which latency need to be calculated 
+//          - topic to which latency need to be calculated, if topic_names is empty
 //    - topic_type : <String>
 //          - Message type of the topic.
 //          - Valid inputs: {'image','points','imu','metadata','camera_info','rgbd','imu_info','tf'}
+//    - topic_names : <String>
+//          - comma separated list of topics to which latency need to be calculated
+//    - topic_types : <String>
+//          - comma separated list of the topics message types, or a single type for all of them
+//    - window_size : <Integer>
+//          - number of latest messages per topic the statistics are computed on
+//    - report_period : <Double>
+//          - seconds between reports
+//    - csv_file : <String>
+//          - if not empty, the reports are also written to this file
+//    - log_messages : <Bool>
+//          - log a line per message, at the cost of skewing the measurement
 // Note: 
 //    - This tool doesn't support calulating latency for extrinsic topics.
 //      Because, those topics doesn't have timestamp in it and this tool uses
 //      that timestamp as an input to calculate the latency.
+//    - For measuring intra-process latency, load it as a component in the container of the camera node.
 //
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <string>
 #include <frame_latency/frame_latency.h>
@@ -34,79 +52,252 @@
 
 using namespace rs2_ros::tools::frame_latency;
 
+namespace
+{
+    std::vector< std::string > splitList( const std::string & list )
+    {
+        std::vector< std::string > items;
+        std::stringstream ss( list );
+        std::string item;
+        while( std::getline( ss, item, ',' ) )
+        {
+            item.erase( 0, item.find_first_not_of( " \t" ) );
+            item.erase( item.find_last_not_of( " \t" ) + 1 );
+            if( ! item.empty() )
+                items.push_back( item );
+        }
+        return items;
+    }
+}
+
+TopicLatencyStats::TopicLatencyStats( size_t window_size )
+    : _next( 0 )
+    , _received( 0 )
+    , _dropped( 0 )
+    , _out_of_order( 0 )
+    , _last_stamp_ns( 0 )
+    , _period_ns( 0 )
+{
+    _latencies_ms.reserve( std::max< size_t >( window_size, 1 ) );
+}
+
+void TopicLatencyStats::add( int64_t stamp_ns, int64_t receive_ns )
+{
+    std::lock_guard< std::mutex > lock( _mutex );
+    double latency_ms = ( receive_ns - stamp_ns ) * 1e-6;
+    if( _latencies_ms.size() < _latencies_ms.capacity() )
+        _latencies_ms.push_back( latency_ms );
+    else
+        _latencies_ms[_next] = latency_ms;
+    _next = ( _next + 1 ) % _latencies_ms.capacity();
+
+    if( _received++ == 0 )
+    {
+        _last_stamp_ns = stamp_ns;
+        return;
+    }
+    int64_t interval_ns = stamp_ns - _last_stamp_ns;
+    if( interval_ns <= 0 )
+    {
+        _out_of_order++;
+        return;
+    }
+    _last_stamp_ns = stamp_ns;
+    if( _period_ns <= 0 )
+        _period_ns = static_cast< double >( interval_ns );
+    else if( interval_ns > 1.5 * _period_ns )
+        _dropped += static_cast< size_t >( std::llround( interval_ns / _period_ns ) ) - 1;
+    else
+        _period_ns += ( interval_ns - _period_ns ) / 16;    // smoothed over about the last 16 intervals
+}
+
+TopicLatencyStats::Report TopicLatencyStats::getReport() const
+{
+    std::vector< double > latencies_ms;
+    Report report;
+    {
+        std::lock_guard< std::mutex > lock( _mutex );
+        latencies_ms = _latencies_ms;
+        report.received = _received;
+        report.dropped = _dropped;
+        report.out_of_order = _out_of_order;
+        report.rate_hz = _period_ns > 0 ? 1e9 / _period_ns : 0;
+    }
+    report.window = latencies_ms.size();
+    report.min_ms = report.mean_ms = report.p99_ms = report.max_ms = report.jitter_ms = 0;
+    if( latencies_ms.empty() )
+        return report;
+
+    double sum( 0 ), sum_squares( 0 );
+    report.min_ms = report.max_ms = latencies_ms[0];
+    for( double latency : latencies_ms )
+    {
+        report.min_ms = std::min( report.min_ms, latency );
+        report.max_ms = std::max( report.max_ms, latency );
+        sum += latency;
+        sum_squares += latency * latency;
+    }
+    report.mean_ms = sum / latencies_ms.size();
+    report.jitter_ms = std::sqrt( std::max( 0.0, sum_squares / latencies_ms.size() - report.mean_ms * report.mean_ms ) );
+    auto p99 = latencies_ms.begin() + ( latencies_ms.size() * 99 + 99 ) / 100 - 1;
+    std::nth_element( latencies_ms.begin(), p99, latencies_ms.end() );
+    report.p99_ms = *p99;
+    return report;
+}
+
 FrameLatencyNode::FrameLatencyNode( const std::string & node_name,
                                     const std::string & ns,
                                     const rclcpp::NodeOptions & node_options )
     : Node( node_name, ns, node_options )
+    , _window_size( 1000 )
+    , _log_messages( false )
     , _logger( this->get_logger() )
 {
 }
 
-std::string topic_name = "/camera/color/image_raw";
-std::string topic_type = "image";
+void FrameLatencyNode::onMessage( const std::string & topicName,
+                                  const rclcpp::Time & stamp,
+                                  const std::string & frame_id,
+                                  const void * address )
+{
+    rclcpp::Time curr_time = this->get_clock()->now();
+    _stats.at( topicName )->add( stamp.nanoseconds(), curr_time.nanoseconds() );
+    if( _log_messages )
+    {
+        ROS_INFO_STREAM( "Got msg with "<< frame_id <<" frame id at address 0x"
+                        << std::hex << reinterpret_cast< std::uintptr_t >( address )
+                        << std::dec << " with latency of " << ( curr_time.nanoseconds() - stamp.nanoseconds() ) * 1e-9 << " [sec]" );
+    }
+}
 
 template <typename MsgType>
 void FrameLatencyNode::createListener(std::string topicName, const rmw_qos_profile_t qos_profile)
 {
-    _sub = this->create_subscription<MsgType>(
+    _subs.push_back( this->create_subscription<MsgType>(
                 topicName,
                 rclcpp::QoS( rclcpp::QoSInitialization::from_rmw( qos_profile ),
                             qos_profile ),
-                [&, this]( const std::shared_ptr< MsgType> msg ) {
-                    rclcpp::Time curr_time = this->get_clock()->now();
-                    auto latency = ( curr_time - msg->header.stamp ).seconds();
-                    ROS_INFO_STREAM( "Got msg with "<< msg->header.frame_id <<" frame id at address 0x"
-                                    << std::hex << reinterpret_cast< std::uintptr_t >( msg.get() )
-                                    << std::dec << " with latency of " << latency << " [sec]" );
-                } );
+                [this, topicName]( const std::shared_ptr< MsgType> msg ) {
+                    onMessage( topicName, msg->header.stamp, msg->header.frame_id, msg.get() );
+                } ) );
 }
 
 void FrameLatencyNode::createTFListener(std::string topicName, const rmw_qos_profile_t qos_profile)
 {
-    _sub = this->create_subscription<tf2_msgs::msg::TFMessage>(
+    _subs.push_back( this->create_subscription<tf2_msgs::msg::TFMessage>(
                 topicName,
                 rclcpp::QoS( rclcpp::QoSInitialization::from_rmw( qos_profile ),
                             qos_profile ),
-                [&, this]( const std::shared_ptr<tf2_msgs::msg::TFMessage> msg ) {
-                    rclcpp::Time curr_time = this->get_clock()->now();
-                    auto latency = ( curr_time - msg->transforms.back().header.stamp ).seconds();
-                    ROS_INFO_STREAM( "Got msg with "<< msg->transforms.back().header.frame_id <<" frame id at address 0x"
-                                    << std::hex << reinterpret_cast< std::uintptr_t >( msg.get() )
-                                    << std::dec << " with latency of " << latency << " [sec]" );
-                } );
+                [this, topicName]( const std::shared_ptr<tf2_msgs::msg::TFMessage> msg ) {
+                    if( msg->transforms.empty() )
+                        return;
+                    onMessage( topicName, msg->transforms.back().header.stamp, msg->transforms.back().header.frame_id, msg.get() );
+                } ) );
+}
+
+bool FrameLatencyNode::createListener( const std::string & topicName, const std::string & topicType )
+{
+    // Created before the subscription, as the callbacks don't lock the map.
+    _stats[topicName] = std::make_shared< TopicLatencyStats >( _window_size );
+    if (topicType == "image")
+        createListener<sensor_msgs::msg::Image>(topicName, rmw_qos_profile_default);
+    else if (topicType == "points")
+        createListener<sensor_msgs::msg::PointCloud2>(topicName, rmw_qos_profile_default);
+    else if (topicType == "imu")
+        createListener<sensor_msgs::msg::Imu>(topicName, rmw_qos_profile_sensor_data);
+    else if (topicType == "metadata")
+        createListener<realsense2_camera_msgs::msg::Metadata>(topicName, rmw_qos_profile_default);
+    else if (topicType == "camera_info")
+        createListener<sensor_msgs::msg::CameraInfo>(topicName, rmw_qos_profile_default);
+    else if (topicType == "rgbd")
+        createListener<realsense2_camera_msgs::msg::RGBD>(topicName, rmw_qos_profile_default);
+    else if (topicType == "imu_info")
+        createListener<realsense2_camera_msgs::msg::IMUInfo>(topicName, rmw_qos_profile_default);
+    else if (topicType == "tf")
+        createTFListener(topicName, rmw_qos_profile_default);
+    else
+    {
+        ROS_ERROR_STREAM("Specified message type '" << topicType << "' of topic " << topicName << " is not supported");
+        _stats.erase( topicName );
+        return false;
+    }
+    return true;
+}
+
+void FrameLatencyNode::report()
+{
+    double now_sec = this->get_clock()->now().seconds();
+    for( auto & topic_stats : _stats )
+    {
+        TopicLatencyStats::Report report = topic_stats.second->getReport();
+        ROS_INFO_STREAM( topic_stats.first << ": received " << report.received << ", dropped " << report.dropped
+                         << ", out of order " << report.out_of_order << ", " << report.rate_hz << " Hz. Latency [ms] over "
+                         << report.window << " msgs: min " << report.min_ms << ", mean " << report.mean_ms
+                         << ", p99 " << report.p99_ms << ", max " << report.max_ms << ", jitter " << report.jitter_ms );
+        if( _csv.is_open() )
+        {
+            _csv << std::fixed << now_sec << "," << topic_stats.first << "," << report.received << "," << report.dropped << ","
+                 << report.out_of_order << "," << report.window << "," << report.min_ms << "," << report.mean_ms << ","
+                 << report.p99_ms << "," << report.max_ms << "," << report.jitter_ms << "," << report.rate_hz << "\n";
+        }
+    }
+    if( _csv.is_open() )
+        _csv.flush();
 }
 
 FrameLatencyNode::FrameLatencyNode( const rclcpp::NodeOptions & node_options )
     : Node( "frame_latency", "/", node_options )
+    , _window_size( 1000 )
+    , _log_messages( false )
     , _logger( this->get_logger() )
 {
     ROS_INFO_STREAM( "frame_latency node is UP!" );
     ROS_INFO_STREAM( "Intra-Process is "
                      << ( this->get_node_options().use_intra_process_comms() ? "ON" : "OFF" ) );
 
-    topic_name = this->declare_parameter("topic_name", topic_name);
-    topic_type = this->declare_parameter("topic_type", topic_type);
-
-    ROS_INFO_STREAM( "Subscribing to Topic: " << topic_name);
-
-    if (topic_type == "image")
-        createListener<sensor_msgs::msg::Image>(topic_name, rmw_qos_profile_default);
-    else if (topic_type == "points")
-        createListener<sensor_msgs::msg::PointCloud2>(topic_name, rmw_qos_profile_default);
-    else if (topic_type == "imu")
-        createListener<sensor_msgs::msg::Imu>(topic_name, rmw_qos_profile_sensor_data);
-    else if (topic_type == "metadata")
-        createListener<realsense2_camera_msgs::msg::Metadata>(topic_name, rmw_qos_profile_default);
-    else if (topic_type == "camera_info")
-        createListener<sensor_msgs::msg::CameraInfo>(topic_name, rmw_qos_profile_default);
-    else if (topic_type == "rgbd")
-        createListener<realsense2_camera_msgs::msg::RGBD>(topic_name, rmw_qos_profile_default);
-    else if (topic_type == "imu_info")
-        createListener<realsense2_camera_msgs::msg::IMUInfo>(topic_name, rmw_qos_profile_default);
-    else if (topic_type == "tf")
-        createTFListener(topic_name, rmw_qos_profile_default);
-    else
-        ROS_ERROR_STREAM("Specified message type '" << topic_type << "' is not supported");
+    std::string topic_name = this->declare_parameter("topic_name", std::string("/camera/color/image_raw"));
+    std::string topic_type = this->declare_parameter("topic_type", std::string("image"));
+    std::vector< std::string > topic_names = splitList( this->declare_parameter("topic_names", std::string("")) );
+    std::vector< std::string > topic_types = splitList( this->declare_parameter("topic_types", std::string("")) );
+    _window_size = std::max< int64_t >( 1, this->declare_parameter("window_size", 1000) );
+    double report_period = this->declare_parameter("report_period", 1.0);
+    std::string csv_file = this->declare_parameter("csv_file", std::string(""));
+    _log_messages = this->declare_parameter("log_messages", false);
+
+    if( topic_names.empty() )
+    {
+        topic_names = { topic_name };
+        topic_types = { topic_type };
+    }
+    else if( topic_types.empty() )
+    {
+        topic_types = { topic_type };
+    }
+    if( topic_types.size() != 1 && topic_types.size() != topic_names.size() )
+    {
+        ROS_ERROR_STREAM( "topic_types should hold a single type or a type per topic of topic_names" );
+        return;
+    }
+
+    for( size_t i = 0; i < topic_names.size(); ++i )
+    {
+        const std::string & type = topic_types.size() == 1 ? topic_types[0] : topic_types[i];
+        if( createListener( topic_names[i], type ) )
+            ROS_INFO_STREAM( "Subscribing to Topic: " << topic_names[i] << " (" << type << ")" );
+    }
+
+    if( ! csv_file.empty() )
+    {
+        _csv.open( csv_file );
+        if( _csv.is_open() )
+            _csv << "time,topic,received,dropped,out_of_order,window,min_ms,mean_ms,p99_ms,max_ms,jitter_ms,rate_hz\n";
+        else
+            ROS_ERROR_STREAM( "Could not open csv_file: " << csv_file );
+    }
+    if( report_period > 0 )
+    {
+        _report_timer = this->create_wall_timer( std::chrono::duration< double >( report_period ), [this]() { report(); } );
+    }
 }
 
 #include "rclcpp_components/register_node_macro.hpp"
@@ -35,10 +35,50 @@
 #include <tf2_msgs/msg/tf_message.hpp>
 #include <nav_msgs/msg/odometry.hpp>
 
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+
 
 namespace rs2_ros {
 namespace tools {
 namespace frame_latency {
+
+// Latency (receive time - header.stamp) of the last window_size messages of a topic, and the messages missing
+// from the header.stamp sequence: an interval longer than 1.5 times the expected period holds dropped messages.
+class TopicLatencyStats
+{
+public:
+    struct Report
+    {
+        size_t received;        // messages since the start
+        size_t dropped;         // estimated, since the start
+        size_t out_of_order;    // header.stamp not after the previous one, since the start
+        size_t window;          // messages the statistics below are computed on
+        double min_ms;
+        double mean_ms;
+        double p99_ms;
+        double max_ms;
+        double jitter_ms;       // standard deviation of the latency
+        double rate_hz;         // from the expected period
+    };
+
+    explicit TopicLatencyStats( size_t window_size );
+    void add( int64_t stamp_ns, int64_t receive_ns );
+    Report getReport() const;
+
+private:
+    mutable std::mutex _mutex;
+    std::vector< double > _latencies_ms;    // rolling window
+    size_t _next;
+    size_t _received;
+    size_t _dropped;
+    size_t _out_of_order;
+    int64_t _last_stamp_ns;
+    double _period_ns;      // smoothed interval between the stamps of consecutive messages
+};
+
 class FrameLatencyNode : public rclcpp::Node
 {
 public:
@@ -56,7 +96,16 @@ public:
     void createTFListener(std::string topicName, const rmw_qos_profile_t qos_profile);
 
 private:
-    std::shared_ptr<void > _sub;
+    bool createListener( const std::string & topicName, const std::string & topicType );
+    void onMessage( const std::string & topicName, const rclcpp::Time & stamp, const std::string & frame_id, const void * address );
+    void report();
+
+    std::vector< std::shared_ptr< void > > _subs;
+    std::map< std::string, std::shared_ptr< TopicLatencyStats > > _stats;
+    size_t _window_size;
+    bool _log_messages;
+    std::ofstream _csv;
+    rclcpp::TimerBase::SharedPtr _report_timer;
 
     rclcpp::Logger _logger;
 };